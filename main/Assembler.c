@@ -0,0 +1,429 @@
+#include <ctype.h>
+#include <string.h>
+
+#include "Assembler.h"
+#include "Commands.h"
+#include "Scanner.h"
+
+#define TAB                '\t'
+#define SPACE              ' '
+#define HASH               '#'
+#define SLASH              '/'
+#define DOT                '.'
+#define COLON              ':'
+
+static char TOO_MANY_WORDS_ERROR_MESSAGE[] = "The program does not fit into the provided memory.";
+static char UNSUPPORTED_DIRECTIVE_ERROR_MESSAGE[] = "This directive is not supported.";
+static char LABEL_TOO_LONG_ERROR_MESSAGE[] = "The label is too long.";
+static char TOO_MANY_LABELS_ERROR_MESSAGE[] = "There are too many labels.";
+static char TOO_MANY_JUMPS_TO_LABELS_ERROR_MESSAGE[] = "There are too many jumps to labels.";
+static char DUPLICATE_LABEL_ERROR_MESSAGE[] = "The label is already defined.";
+static char UNDEFINED_LABEL_ERROR_MESSAGE[] = "The label is not defined.";
+static char INVALID_LABEL_ERROR_MESSAGE[] = "This is no valid label (register and condition names are reserved).";
+static char JUMP_TARGET_OUT_OF_RANGE_ERROR_MESSAGE[] = "The label is out of the range of the jump.";
+
+// These directives do not influence the generated words (the text section is the only supported section).
+static const char *IGNORED_DIRECTIVES[] = {".text", ".global", ".globl"};
+
+static bool isBlank(uint8_t character) {
+   return character == SPACE || character == TAB;
+}
+
+static bool isLabelCharacter(uint8_t character) {
+   return isalnum(character) || character == '_' || character == DOT;
+}
+
+// Returns the length of the label definition ("name:") at the beginning of the line (without colon) or 0 if the line does not start with a label.
+static size_t getLabelDefinitionLength(const uint8_t *line, const uint8_t *end) {
+   const uint8_t *position = line;
+   while (position < end && isLabelCharacter(*position)) {
+      position++;
+   }
+   if (position == end || *position != COLON) {
+      return 0;
+   }
+   return position - line;
+}
+
+static bool isIgnoredDirective(const uint8_t *directive, const uint8_t *end) {
+   size_t length = 0;
+   while (directive + length < end && !isBlank(*(directive + length))) {
+      length++;
+   }
+   for (size_t index = 0; index < sizeof(IGNORED_DIRECTIVES) / sizeof(IGNORED_DIRECTIVES[0]); index++) {
+      if (strlen(IGNORED_DIRECTIVES[index]) == length && strncmp((const char*)directive, IGNORED_DIRECTIVES[index], length) == 0) {
+         return true;
+      }
+   }
+   return false;
+}
+
+static uint32_t toWord(CommandBytes *commandBytes) {
+   return (uint32_t)commandBytes->byte0 | ((uint32_t)commandBytes->byte1 << 8) | ((uint32_t)commandBytes->byte2 << 16) | ((uint32_t)commandBytes->byte3 << 24);
+}
+
+static CommandBytes toCommandBytes(uint32_t word) {
+   return (CommandBytes){word & 0xff, (word >> 8) & 0xff, (word >> 16) & 0xff, word >> 24};
+}
+
+static bool addDiagnostic(Assembler *assembler, size_t lineNumber, char *errorMessage) {
+   if (assembler->diagnosticCount < assembler->maxDiagnosticCount) {
+      assembler->diagnostics[assembler->diagnosticCount] = (Diagnostic){lineNumber, errorMessage};
+   }
+   assembler->diagnosticCount++;
+   return false;
+}
+
+// FNV-1a
+static size_t hashLabel(const uint8_t *label, size_t labelLength) {
+   uint32_t hash = 2166136261u;
+   for (size_t index = 0; index < labelLength; index++) {
+      hash = (hash ^ label[index]) * 16777619u;
+   }
+   return hash;
+}
+
+// Returns the index of the label in the symbol table (inserts it as undefined label if it is not in the table yet) or
+// assembler->symbolCapacity if the table is full.
+static size_t findOrInsertLabel(Assembler *assembler, const uint8_t *label, size_t labelLength) {
+   size_t mask  = assembler->symbolCapacity - 1;
+   size_t index = hashLabel(label, labelLength) & mask;
+
+   for (size_t probe = 0; probe < assembler->symbolCapacity; probe++, index = (index + 1) & mask) {
+      Symbol *symbol = &assembler->symbols[index];
+      if (symbol->name[0] == 0) {
+         memcpy(symbol->name, label, labelLength);
+         symbol->name[labelLength] = 0;
+         symbol->address           = 0;
+         symbol->isDefined         = false;
+         return index;
+      }
+      if (strlen(symbol->name) == labelLength && memcmp(symbol->name, label, labelLength) == 0) {
+         return index;
+      }
+   }
+   return assembler->symbolCapacity;
+}
+
+static bool defineLabel(Assembler *assembler, const uint8_t *label, size_t labelLength) {
+   if (labelLength > MAX_LABEL_LENGTH) {
+      return addDiagnostic(assembler, assembler->lineNumber, LABEL_TOO_LONG_ERROR_MESSAGE);
+   }
+   // a jump could not use the label
+   if (!isLabel(label, labelLength)) {
+      return addDiagnostic(assembler, assembler->lineNumber, INVALID_LABEL_ERROR_MESSAGE);
+   }
+   size_t index = findOrInsertLabel(assembler, label, labelLength);
+   if (index == assembler->symbolCapacity) {
+      return addDiagnostic(assembler, assembler->lineNumber, TOO_MANY_LABELS_ERROR_MESSAGE);
+   }
+   Symbol *symbol = &assembler->symbols[index];
+   if (symbol->isDefined) {
+      return addDiagnostic(assembler, assembler->lineNumber, DUPLICATE_LABEL_ERROR_MESSAGE);
+   }
+   symbol->address   = assembler->wordCount * 4;
+   symbol->isDefined = true;
+   return true;
+}
+
+// The command in front of a skipped jump jumps behind it -> after relaxing the jump at jumpIndex it needs to jump behind
+// the absolute jump as well.
+static void skipAbsoluteJump(Assembler *assembler, size_t jumpIndex) {
+   CommandBytes commandBytes = toCommandBytes(assembler->words[jumpIndex - 1]);
+   setJumpTarget(&commandBytes, (jumpIndex - 1) * 4, (jumpIndex + 2) * 4);
+   assembler->words[jumpIndex - 1] = toWord(&commandBytes);
+}
+
+// Sets the target of the jump if the label is already defined. A relative jump that does not reach the label gets relaxed:
+// the inverted relative jump gets written and commandBytes becomes the absolute jump following it. Each jump to a label
+// gets a fixup because relaxing jumps in resolveLabels moves the labels.
+static bool setJumpTargetToLabel(Assembler *assembler, CommandBytes *commandBytes, const uint8_t *label, size_t labelLength, bool isSkipped) {
+   if (labelLength > MAX_LABEL_LENGTH) {
+      return addDiagnostic(assembler, assembler->lineNumber, LABEL_TOO_LONG_ERROR_MESSAGE);
+   }
+   size_t index = findOrInsertLabel(assembler, label, labelLength);
+   if (index == assembler->symbolCapacity) {
+      return addDiagnostic(assembler, assembler->lineNumber, TOO_MANY_LABELS_ERROR_MESSAGE);
+   }
+   if (assembler->fixupCount == assembler->maxFixupCount) {
+      return addDiagnostic(assembler, assembler->lineNumber, TOO_MANY_JUMPS_TO_LABELS_ERROR_MESSAGE);
+   }
+   Fixup  fixup   = {index, assembler->wordCount, assembler->lineNumber, false, isSkipped};
+   Symbol *symbol = &assembler->symbols[index];
+   if (symbol->isDefined && !setJumpTarget(commandBytes, assembler->wordCount * 4, symbol->address)) {
+      CommandBytes absoluteJump;
+      if (assembler->wordCount + 1 == assembler->maxWordCount) {
+         return addDiagnostic(assembler, assembler->lineNumber, TOO_MANY_WORDS_ERROR_MESSAGE);
+      }
+      if (!relaxRelativeJump(commandBytes, symbol->address, &absoluteJump)) {
+         return addDiagnostic(assembler, assembler->lineNumber, JUMP_TARGET_OUT_OF_RANGE_ERROR_MESSAGE);
+      }
+      assembler->words[assembler->wordCount++] = toWord(commandBytes);
+      *commandBytes   = absoluteJump;
+      fixup.isRelaxed = true;
+      if (isSkipped) {
+         skipAbsoluteJump(assembler, fixup.wordIndex);
+      }
+   }
+   assembler->fixups[assembler->fixupCount++] = fixup;
+   return true;
+}
+
+// Jumps to labels get their targets from the fixups -> the jump itself and the absolute jump of a relaxed jump have no
+// numeric target. The fixups are sorted by wordIndex, nextFixup is the first one not in front of jumpIndex.
+static bool isJumpToLabel(const Assembler *assembler, size_t *nextFixup, size_t jumpIndex) {
+   while (*nextFixup < assembler->fixupCount) {
+      const Fixup *fixup = &assembler->fixups[*nextFixup];
+      if (jumpIndex < fixup->wordIndex) {
+         return false;
+      }
+      if (jumpIndex <= fixup->wordIndex + (fixup->isRelaxed ? 1 : 0)) {
+         return true;
+      }
+      (*nextFixup)++;
+   }
+   return false;
+}
+
+// Moves the targets of the jumps with numeric targets like inserting a word at wordIndex moves the labels. Only checks
+// whether all of them stay in range if isDryRun is set, otherwise the words get updated (already moved behind wordIndex)
+// and firstChangedIndex gets lowered to the first jump in front of wordIndex that changed.
+static bool moveNumericJumpTargets(Assembler *assembler, size_t wordIndex, bool isDryRun, size_t *firstChangedIndex) {
+   size_t nextFixup = 0;
+   for (size_t index = 0; index < assembler->wordCount; index++) {
+      size_t       jumpIndex    = isDryRun || index < wordIndex ? index : index + 1;
+      CommandBytes commandBytes = toCommandBytes(assembler->words[jumpIndex]);
+      uint32_t     targetAddress;
+      if (isJumpToLabel(assembler, &nextFixup, index) || !getJumpTargetAddress(&commandBytes, index * 4, &targetAddress)) {
+         continue;
+      }
+      if (targetAddress >= wordIndex * 4) {
+         targetAddress += 4;
+      }
+      if (!setJumpTarget(&commandBytes, (index < wordIndex ? index : index + 1) * 4, targetAddress)) {
+         return false;
+      }
+      if (!isDryRun && assembler->words[jumpIndex] != toWord(&commandBytes)) {
+         assembler->words[jumpIndex] = toWord(&commandBytes);
+         *firstChangedIndex          = jumpIndex < *firstChangedIndex ? jumpIndex : *firstChangedIndex;
+      }
+   }
+   return true;
+}
+
+// Inserts a word at wordIndex. The following words, the labels, the jumps to labels behind it and the targets of jumps with
+// numeric targets move by one word. Returns false without inserting if a numeric target gets out of range of its jump.
+// Otherwise firstChangedIndex gets lowered to the first word that changed.
+static bool insertWord(Assembler *assembler, size_t wordIndex, size_t *firstChangedIndex) {
+   if (!moveNumericJumpTargets(assembler, wordIndex, true, firstChangedIndex)) {
+      return false;
+   }
+   memmove(&assembler->words[wordIndex + 1], &assembler->words[wordIndex], (assembler->wordCount - wordIndex) * sizeof(uint32_t));
+   moveNumericJumpTargets(assembler, wordIndex, false, firstChangedIndex);
+   *firstChangedIndex = wordIndex < *firstChangedIndex ? wordIndex : *firstChangedIndex;
+   assembler->wordCount++;
+
+   for (size_t index = 0; index < assembler->symbolCapacity; index++) {
+      Symbol *symbol = &assembler->symbols[index];
+      if (symbol->name[0] != 0 && symbol->isDefined && symbol->address >= wordIndex * 4) {
+         symbol->address += 4;
+      }
+   }
+   for (size_t index = 0; index < assembler->fixupCount; index++) {
+      if (assembler->fixups[index].wordIndex >= wordIndex) {
+         assembler->fixups[index].wordIndex++;
+      }
+   }
+   return true;
+}
+
+// Relaxes the relative jumps that do not reach their labels until all of them are in range. Relaxing a jump only increases
+// the distances of the other jumps -> each pass relaxes at least one jump or it is the last one. Returns the index of the
+// first word that changed or wordCount if no jump got relaxed.
+static size_t relaxJumps(Assembler *assembler) {
+   size_t firstChangedIndex     = assembler->wordCount;
+   size_t firstMovableWordIndex = 0;
+   for (size_t index = 0; index < assembler->wordCount; index++) {
+      if ((assembler->words[index] >> 28) == 0) {
+         firstMovableWordIndex = index + 1;
+      }
+   }
+
+   bool hasRelaxedJump = true;
+   while (hasRelaxedJump) {
+      hasRelaxedJump = false;
+      for (size_t index = 0; index < assembler->fixupCount; index++) {
+         Fixup  *fixup  = &assembler->fixups[index];
+         Symbol *symbol = &assembler->symbols[fixup->symbolIndex];
+         if (!symbol->isDefined || fixup->isRelaxed || fixup->wordIndex + 1 < firstMovableWordIndex || assembler->wordCount == assembler->maxWordCount) {
+            continue;
+         }
+
+         CommandBytes commandBytes = toCommandBytes(assembler->words[fixup->wordIndex]);
+         CommandBytes absoluteJump;
+         if (setJumpTarget(&commandBytes, fixup->wordIndex * 4, symbol->address) || !relaxRelativeJump(&commandBytes, symbol->address, &absoluteJump)) {
+            continue;
+         }
+         // resolveLabels reports the jump as out of range if it cannot get relaxed
+         if (!insertWord(assembler, fixup->wordIndex + 1, &firstChangedIndex)) {
+            continue;
+         }
+         // the skip in front of a skipped jump has a numeric target -> insertWord already moved it behind the absolute jump
+         assembler->words[fixup->wordIndex]     = toWord(&commandBytes);
+         assembler->words[fixup->wordIndex + 1] = toWord(&absoluteJump);
+         fixup->isRelaxed  = true;
+         hasRelaxedJump    = true;
+         firstChangedIndex = fixup->wordIndex < firstChangedIndex ? fixup->wordIndex : firstChangedIndex;
+      }
+   }
+   return firstChangedIndex;
+}
+
+void resetAssembler(Assembler *assembler) {
+   assembler->wordCount       = 0;
+   assembler->diagnosticCount = 0;
+   assembler->fixupCount      = 0;
+   assembler->lineNumber      = 0;
+   for (size_t index = 0; index < assembler->symbolCapacity; index++) {
+      assembler->symbols[index].name[0] = 0;
+   }
+}
+
+static void encodeCommandUsingCache(EncodeCache *cache, const uint8_t *line, size_t commandLength, EncodedLine *encodedLine) {
+   const uint8_t *commandEnd = line + commandLength;
+   encodedLine->label        = NULL;
+   encodedLine->labelLength  = 0;
+   encodedLine->content      = LINE_WITHOUT_COMMAND;
+
+   while (line < commandEnd && isBlank(*line)) {
+      line++;
+   }
+
+   if (line < commandEnd && *line == HASH) {
+      return;
+   }
+
+   size_t labelLength = getLabelDefinitionLength(line, commandEnd);
+   if (labelLength > 0) {
+      encodedLine->label       = line;
+      encodedLine->labelLength = labelLength;
+      line += labelLength + 1;
+      while (line < commandEnd && isBlank(*line)) {
+         line++;
+      }
+   }
+
+   if (line == commandEnd) {
+      return;
+   }
+
+   if (*line == DOT) {
+      encodedLine->content = isIgnoredDirective(line, commandEnd) ? LINE_WITHOUT_COMMAND : LINE_WITH_UNSUPPORTED_DIRECTIVE;
+      return;
+   }
+
+   encodedLine->content = LINE_WITH_COMMAND;
+   encodedLine->command = (cache != NULL) ? getCachedCommandBytesForLine(cache, line, commandEnd - line) : getCommandBytesForLine(line, commandEnd - line);
+}
+
+void encodeCommand(const uint8_t *line, size_t commandLength, EncodedLine *encodedLine) {
+   encodeCommandUsingCache(NULL, line, commandLength, encodedLine);
+}
+
+bool assembleEncodedLine(Assembler *assembler, const EncodedLine *encodedLine) {
+   assembler->lineNumber++;
+
+   if (encodedLine->label != NULL && !defineLabel(assembler, encodedLine->label, encodedLine->labelLength)) {
+      return false;
+   }
+
+   if (encodedLine->content == LINE_WITHOUT_COMMAND) {
+      return true;
+   }
+
+   if (encodedLine->content == LINE_WITH_UNSUPPORTED_DIRECTIVE) {
+      return addDiagnostic(assembler, assembler->lineNumber, UNSUPPORTED_DIRECTIVE_ERROR_MESSAGE);
+   }
+
+   if (assembler->wordCount == assembler->maxWordCount) {
+      return addDiagnostic(assembler, assembler->lineNumber, TOO_MANY_WORDS_ERROR_MESSAGE);
+   }
+
+   Result command = encodedLine->command;
+   if (command.errorMessage != NULL) {
+      return addDiagnostic(assembler, assembler->lineNumber, command.errorMessage);
+   }
+   if (assembler->wordCount + command.additionalCommandCount >= assembler->maxWordCount) {
+      return addDiagnostic(assembler, assembler->lineNumber, TOO_MANY_WORDS_ERROR_MESSAGE);
+   }
+
+   // the label is the target of the last command, the commands in front of it get written first
+   size_t       firstWordIndex = assembler->wordCount;
+   CommandBytes *lastCommand   = &command.commandBytes;
+   for (size_t index = 0; index < command.additionalCommandCount; index++) {
+      assembler->words[assembler->wordCount++] = toWord(lastCommand);
+      lastCommand = &command.additionalCommandBytes[index];
+   }
+   if (command.label != NULL && !setJumpTargetToLabel(assembler, lastCommand, command.label, command.labelLength, command.additionalCommandCount > 0)) {
+      assembler->wordCount = firstWordIndex;
+      return false;
+   }
+   assembler->words[assembler->wordCount++] = toWord(lastCommand);
+   return true;
+}
+
+bool assembleLine(Assembler *assembler, const uint8_t *line, size_t lineLength) {
+   const uint8_t *end        = line + lineLength;
+   const uint8_t *commandEnd = line;
+   while (commandEnd < end && !(*commandEnd == SLASH && commandEnd + 1 < end && *(commandEnd + 1) == SLASH)) {
+      commandEnd++;
+   }
+
+   EncodedLine encodedLine;
+   encodeCommandUsingCache(assembler->encodeCache, line, commandEnd - line, &encodedLine);
+   return assembleEncodedLine(assembler, &encodedLine);
+}
+
+size_t resolveLabels(Assembler *assembler) {
+   size_t firstChangedIndex = relaxJumps(assembler);
+
+   for (size_t index = 0; index < assembler->fixupCount; index++) {
+      Fixup  fixup   = assembler->fixups[index];
+      Symbol *symbol = &assembler->symbols[fixup.symbolIndex];
+
+      if (!symbol->isDefined) {
+         addDiagnostic(assembler, fixup.lineNumber, UNDEFINED_LABEL_ERROR_MESSAGE);
+         continue;
+      }
+
+      // the absolute jump follows the inverted relative jump of a relaxed jump
+      size_t jumpIndex          = fixup.wordIndex + (fixup.isRelaxed ? 1 : 0);
+      CommandBytes commandBytes = toCommandBytes(assembler->words[jumpIndex]);
+      if (setJumpTarget(&commandBytes, jumpIndex * 4, symbol->address)) {
+         assembler->words[jumpIndex] = toWord(&commandBytes);
+      } else {
+         addDiagnostic(assembler, fixup.lineNumber, JUMP_TARGET_OUT_OF_RANGE_ERROR_MESSAGE);
+      }
+   }
+   return firstChangedIndex;
+}
+
+void assemble(Assembler *assembler, const uint8_t *source, size_t sourceLength) {
+   assembleWith(assembler, source, sourceLength, getFastestScannerImplementation());
+}
+
+void assembleWith(Assembler *assembler, const uint8_t *source, size_t sourceLength, ScannerImplementation implementation) {
+   Scanner    scanner;
+   SourceLine line;
+   initScanner(&scanner, source, sourceLength, implementation);
+
+   // the scanner already found the start of the comment -> no need to search it again like assembleLine does
+   while (nextLine(&scanner, &line)) {
+      EncodedLine encodedLine;
+      encodeCommandUsingCache(assembler->encodeCache, line.start, line.commandLength, &encodedLine);
+      if (!assembleEncodedLine(assembler, &encodedLine) && assembler->wordCount == assembler->maxWordCount) {
+         break;
+      }
+   }
+   resolveLabels(assembler);
+}
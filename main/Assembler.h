@@ -0,0 +1,137 @@
+#ifndef assembler_assembler_h
+#define assembler_assembler_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Commands.h"
+#include "EncodeCache.h"
+#include "Scanner.h"
+
+#define MAX_LABEL_LENGTH   31
+
+typedef struct {
+   size_t lineNumber;      // starts counting at 1
+   char*  errorMessage;
+} Diagnostic;
+
+typedef struct {
+   char     name[MAX_LABEL_LENGTH + 1];   // empty for unused entries
+   uint32_t address;                      // in bytes
+   bool     isDefined;                    // false if the label got used but not (yet) defined
+} Symbol;
+
+typedef struct {
+   size_t symbolIndex;     // index of the label in Assembler.symbols
+   size_t wordIndex;       // index of the jump command in Assembler.words
+   size_t lineNumber;
+   bool   isRelaxed;       // true if the relative jump got replaced by an inverted relative jump and an absolute jump
+   bool   isSkipped;       // true if the command in front of the jump skips it (e.g. "jumpr label, 5, eq" needs two commands)
+} Fixup;
+
+typedef enum {
+   LINE_WITHOUT_COMMAND,               // empty line, comment, label definition only or ignored directive
+   LINE_WITH_UNSUPPORTED_DIRECTIVE,
+   LINE_WITH_COMMAND
+} LineContent;
+
+typedef struct {
+   const uint8_t *label;         // label defined at the beginning of the line (points into the line) or NULL
+   size_t        labelLength;
+   LineContent   content;
+   Result        command;        // only set if content is LINE_WITH_COMMAND
+} EncodedLine;
+
+/**
+ * The caller provides all the memory the assembler uses: words receives the commands, diagnostics the errors, symbols is
+ * the hash table of the labels (symbolCapacity needs to be a power of 2) and fixups stores the jumps to labels (their
+ * targets move when relaxing a jump). Call resetAssembler before using it. If encodeCache is not NULL, assembleLine and
+ * assemble take the commands entered before from it instead of parsing them again (see EncodeCache.h).
+ */
+typedef struct {
+   uint32_t   *words;
+   size_t      maxWordCount;
+   size_t      wordCount;
+   Diagnostic *diagnostics;
+   size_t      maxDiagnosticCount;
+   size_t      diagnosticCount;
+   Symbol     *symbols;
+   size_t      symbolCapacity;
+   Fixup      *fixups;
+   size_t      maxFixupCount;
+   size_t      fixupCount;
+   size_t      lineNumber;
+   EncodeCache *encodeCache;
+} Assembler;
+
+/**
+ * Removes all words, diagnostics, labels and fixups.
+ */
+void resetAssembler(Assembler *assembler);
+
+/**
+ * Assembles a single line (lineLength bytes without line break, no 0 termination required) without copying it. The
+ * command gets written as little endian 32-bit word (byte0 is the least significant byte) to Assembler.words (pseudo
+ * commands like "jumpr label, 5, eq" result in several words, see Commands.h). Empty
+ * lines, comments ("//" till the end of the line or lines starting with "#") and the directives .text, .global and
+ * .globl get ignored. A label definition ("name:") at the beginning of the line assigns the address of the next word
+ * to the label (see isLabel in Commands.h for valid names).
+ *
+ * Jumps to labels defined before get resolved immediately, all others when calling resolveLabels. A relative jump (jumpr
+ * or jumps) to a label that is out of its range (more than 127 words away) gets relaxed: it becomes a relative jump using
+ * the inverted condition that skips the following absolute jump to the label.
+ *
+ * If the line could not get assembled, a diagnostic containing the line number and the error message gets written to
+ * Assembler.diagnostics and false gets returned. If more than maxDiagnosticCount errors occur, the additional
+ * diagnostics get counted in Assembler.diagnosticCount but not stored.
+ */
+bool assembleLine(Assembler *assembler, const uint8_t *line, size_t lineLength);
+
+/**
+ * Does the part of assembleLine that does not depend on the state of the assembler: it finds the label definition and
+ * encodes the command of the line (commandLength bytes in front of the comment). It can get called by several threads
+ * at the same time (see tools/ParallelAssembler.h). Calling assembleEncodedLine for the encoded lines in the order of
+ * the source produces the same words and diagnostics as calling assembleLine for each line. It does not use an encode
+ * cache because the cache is not thread-safe.
+ */
+void encodeCommand(const uint8_t *line, size_t commandLength, EncodedLine *encodedLine);
+
+/**
+ * Does the remaining part of assembleLine for a line encoded by encodeCommand: it defines the label, writes the words
+ * and the diagnostics and resolves the jumps to labels defined before.
+ */
+bool assembleEncodedLine(Assembler *assembler, const EncodedLine *encodedLine);
+
+/**
+ * Sets the targets of all jumps to labels. Each jump to a label that is still undefined results in a diagnostic and
+ * remains unresolved (it gets resolved by a later call if the label gets defined in the meantime).
+ *
+ * All relative jumps start with the short encoding. Relative jumps whose labels are out of range get relaxed (see
+ * assembleLine) by inserting the absolute jump behind them. This moves the following words and labels, which can push
+ * further jumps out of range, so the relaxation gets repeated until all jumps to labels are in range. Relaxed jumps stay
+ * relaxed. Words in front of the last word that is no command (opcode 0, e.g. a variable written by the caller) do not
+ * get moved because they might get addressed by their index -> a jump that would move them results in a diagnostic.
+ * The targets of jumps to numeric addresses move like the labels, which also adapts the command skipping a relaxed jump
+ * (see Fixup.isSkipped) to skip the absolute jump. A jump does not get relaxed if this would move a numeric target of a
+ * relative jump out of its range -> it results in a diagnostic like a jump whose label is out of range.
+ *
+ * Returns the index of the first word that relaxing the jumps changed or moved (including the jumps with numeric targets
+ * in front of it) or the previous wordCount if no jump got relaxed. Jumps to labels in front of it can get new targets too.
+ */
+size_t resolveLabels(Assembler *assembler);
+
+/**
+ * Assembles all lines of source (sourceLength bytes, no 0 termination required) in a single scan and resolves the labels
+ * afterwards. Lines get separated by LF, CR or CRLF. The host finds the line breaks and comments using SSE2 or AVX2 (see
+ * Scanner.h). Assembling stops when the words do not fit into Assembler.words.
+ */
+void assemble(Assembler *assembler, const uint8_t *source, size_t sourceLength);
+
+/**
+ * Does the same as assemble but splits the source into lines using the provided scanner implementation instead of the
+ * fastest one the CPU supports. All implementations produce the same words and diagnostics.
+ */
+void assembleWith(Assembler *assembler, const uint8_t *source, size_t sourceLength, ScannerImplementation implementation);
+
+#endif
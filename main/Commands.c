@@ -1,673 +1,683 @@
 #include <ctype.h>
-#include <sys/types.h>
-#include <regex.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "Commands.h"
-#include "StringUtils.h"
+#include "InstructionSet.h"
 
 #define LF           0x0d
 #define CR           0x0a
 #define TAB          0x09
 #define SPACE        0x20
 #define COMMA        0x2c
+#define MINUS        0x2d
+
+#define MAX_OPERAND_COUNT        5
+#define MAX_VARIANT_COUNT        4
+#define MNEMONIC_TABLE_SIZE      64
+#define MAX_SLEEP_CYCLE_REGISTER 4
 
-static char UNSUPPORTED_JUMPR_R0_ERROR_MESSAGE[] = "The conditions \"eq\", \"le\" and \"gt\" are not supported by the ULP. Please use \"lt\" or \"ge\" instead.";
-static char UNSUPPORTED_JUMPR_STAGECOUNT_ERROR_MESSAGE[] = "The conditions \"eq\" and \"gt\" are not supported by the ULP. Please use \"lt\", \"le\" or \"ge\" instead.";
 static char UNSUPPORTED_COMMAND[] = "This command is not supported.";
+static char RELATIVE_JUMP_STEP_OUT_OF_RANGE_ERROR_MESSAGE[] = "The step of the relative jump is out of range (max. 508 bytes).";
+
+typedef enum {
+   REGISTER,
+   UNSIGNED_NUMBER,
+   NEGATIVE_NUMBER,
+   CONDITION,
+   LABEL,
+   UNKNOWN
+} OperandType;
+
+typedef enum {
+   EQ,
+   OV,
+   LT,
+   LE,
+   GE,
+   GT
+} Condition;
+
+static const char *CONDITIONS[] = {"eq", "ov", "lt", "le", "ge", "gt"};
+
+// encoding of each condition in the fields FIELD_JUMP_TYPE, FIELD_JUMPR_CONDITION and FIELD_JUMPS_CONDITION
+static const int8_t ABSOLUTE_JUMP_TYPES[] = {[EQ] = JUMP_IF_EQ,  [OV] = JUMP_IF_OV,  [LT] = NO_ENCODING, [LE] = NO_ENCODING, [GE] = NO_ENCODING, [GT] = NO_ENCODING};
+static const int8_t JUMPR_CONDITIONS[]    = {[EQ] = NO_ENCODING, [OV] = NO_ENCODING, [LT] = JUMPR_LT,    [LE] = NO_ENCODING, [GE] = JUMPR_GE,    [GT] = NO_ENCODING};
+static const int8_t JUMPS_CONDITIONS[]    = {[EQ] = NO_ENCODING, [OV] = NO_ENCODING, [LT] = JUMPS_LT,    [LE] = JUMPS_LE,    [GE] = JUMPS_GE,    [GT] = NO_ENCODING};
 
 typedef struct {
-   char* pattern;
-   Result (*getBytes)(uint8_t*);
-} Command;
-
-static Result moveRegisterToRegister(uint8_t *commandAsText);
-static Result moveImmediateToRegister(uint8_t *commandAsText);
-static Result andImmediate(uint8_t *commandAsText);
-static Result andRegister(uint8_t *commandAsText);
-static Result orImmediate(uint8_t *commandAsText);
-static Result orRegister(uint8_t *commandAsText);
-static Result addImmediate(uint8_t *commandAsText);
-static Result addRegister(uint8_t *commandAsText);
-static Result subImmediate(uint8_t *commandAsText);
-static Result subRegister(uint8_t *commandAsText);
-static Result nop(uint8_t *commandAsText);
-static Result leftShiftRegister(uint8_t *commandAsText);
-static Result leftShiftImmediate(uint8_t *commandAsText);
-static Result rightShiftRegister(uint8_t *commandAsText);
-static Result rightShiftImmediate(uint8_t *commandAsText);
-
-static int aluOperation(char *instruction);
-static int stageCountAluOperation(char *instruction);
-static int absoluteJumpType(char *condition);
-
-static Result aluOperationWithImmediateValue(uint8_t *commandAsText);
-static Result aluOperationAmongRegisters(uint8_t *commandAsText);
-static Result stageCountOperation(uint8_t *commandAsText);
-static Result storeDataInMemory(uint8_t *commandAsText);
-static Result loadDataFromMemory(uint8_t *commandAsText);
-static Result jumpToAbsoluteAddress(uint8_t *commandAsText, bool isImmediate, bool isConditional);
-static Result jumpConditionalUponR0ToRelativeAddress(uint8_t *commandAsText);
-static Result jumpConditionalUponStageCountToRelativeAddress(uint8_t *commandAsText);
-static Result adc(uint8_t *commandAsText);
-static Result i2cReadWrite(uint8_t *commandAsText);
-static Result readRegister(uint8_t *commandAsText);
-static Result writeRegister(uint8_t *commandAsText);
-
-static Result jumpRegister(uint8_t *commandAsText);
-static Result jumpImmediate(uint8_t *commandAsText);
-static Result jumpRegisterConditional(uint8_t *commandAsText);
-static Result jumpImmediateConditional(uint8_t *commandAsText);
-static Result unsupportedJumpRelativeConditionalBasedOnR0(uint8_t *commandAsText);
-static Result unsupportedJumpRelativeConditionalBasedOnStageCount(uint8_t *commandAsText);
-static Result stageReset(uint8_t *commandAsText);
-static Result stageIncrement(uint8_t *commandAsText);
-static Result stageDecrement(uint8_t *commandAsText);
-static Result halt(uint8_t *commandAsText);
-static Result wake(uint8_t *commandAsText);
-static Result sleep(uint8_t *commandAsText);
-static Result wait(uint8_t *commandAsText);
-static Result tsens(uint8_t *commandAsText);
+   OperandType    type;
+   int32_t        value;   // register number, number or condition (0 for labels)
+   const uint8_t *text;
+   size_t         length;
+} Operand;
 
-static Result waitCycles(int cycles);
+struct Mnemonic;
+
+typedef struct {
+   const struct Mnemonic *mnemonic;
+   size_t                 operandCount;
+   Operand                operands[MAX_OPERAND_COUNT];
+} Instruction;
 
-Command commands[] = {
-   {"add r[0-3] r[0-3] ([-]?(0x[0-9a-f]+|[0-9]+))",                                                                    addImmediate}, 
-   {"add r[0-3] r[0-3] r[0-3]",                                                                                        addRegister}, 
-   {"sub r[0-3] r[0-3] ([-]?(0x[0-9a-f]+|[0-9]+))",                                                                    subImmediate}, 
-   {"sub r[0-3] r[0-3] r[0-3]",                                                                                        subRegister}, 
-   {"and r[0-3] r[0-3] (0x[0-9a-f]+|[0-9]+)",                                                                          andImmediate}, 
-   {"and r[0-3] r[0-3] r[0-3]",                                                                                        andRegister}, 
-   {"or r[0-3] r[0-3] (0x[0-9a-f]+|[0-9]+)",                                                                           orImmediate}, 
-   {"or r[0-3] r[0-3] r[0-3]",                                                                                         orRegister}, 
-   {"move r[0-3] r[0-3]",                                                                                              moveRegisterToRegister}, 
-   {"move r[0-3] ([-]?(0x[0-9a-f]+|[0-9]+))",                                                                          moveImmediateToRegister}, 
-   {"lsh r[0-3] r[0-3] ([-]?(0x[0-9a-f]+|[0-9]+))",                                                                    leftShiftImmediate}, 
-   {"lsh r[0-3] r[0-3] r[0-3]",                                                                                        leftShiftRegister}, 
-   {"rsh r[0-3] r[0-3] ([-]?(0x[0-9a-f]+|[0-9]+))",                                                                    rightShiftImmediate}, 
-   {"rsh r[0-3] r[0-3] r[0-3]",                                                                                        rightShiftRegister}, 
-                                                  
-   {"stage_rst",                                                                                                       stageReset},
-   {"stage\\_inc (0x[0-9a-f]+|[0-9]+)",                                                                                stageIncrement},
-   {"stage\\_dec (0x[0-9a-f]+|[0-9]+)",                                                                                stageDecrement},
-                                               
-   {"st r[0-3] r[0-3] (0x[0-9a-f]+|[0-9]+)",                                                                           storeDataInMemory},
-   {"ld r[0-3] r[0-3] (0x[0-9a-f]+|[0-9]+)",                                                                           loadDataFromMemory},
-                                                  
-   {"jump r[0-3]",                                                                                                     jumpRegister},
-   {"jump r[0-3] ((eq)|(ov))",                                                                                         jumpRegisterConditional},
-   {"jump (0x[0-9a-f]+|[0-9]+)",                                                                                       jumpImmediate},
-   {"jump (0x[0-9a-f]+|[0-9]+) ((eq)|(ov))",                                                                           jumpImmediateConditional},
-                                                  
-   {"jumpr [-]?(0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) ((lt)|(ge))",                                                 jumpConditionalUponR0ToRelativeAddress},
-   {"jumpr [-]?(0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) ((eq)|(le)|(gt))",                                            unsupportedJumpRelativeConditionalBasedOnR0},
-                                               
-   {"jumps [-]?(0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) ((lt)|(le)|(ge))",                                            jumpConditionalUponStageCountToRelativeAddress},
-   {"jumps [-]?(0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) ((eq)|(gt))",                                                 unsupportedJumpRelativeConditionalBasedOnStageCount},
-                                                  
-   {"halt",                                                                                                            halt},
-   {"wake",                                                                                                            wake},
-   {"sleep [0-4]",                                                                                                     sleep},
-   {"wait (0x[0-9a-f]+|[0-9]+)",                                                                                       wait},
-   {"nop",                                                                                                             nop}, 
-   {"tsens r[0-3] (0x[0-9a-f]+|[0-9]+)",                                                                               tsens},
-   {"adc r[0-3] (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+)",                                                            adc},
-   {"i2c_rd (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+)",                      i2cReadWrite},
-   {"i2c_wr (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+)", i2cReadWrite},
-   {"reg_rd (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+)",                                           readRegister},
-   {"reg_wr (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+) (0x[0-9a-f]+|[0-9]+)",                      writeRegister},
-
-   {NULL, NULL}
+// Each character of operandTypes describes one operand: r = register, u = unsigned number, i = signed number, c = condition,
+// a = unsigned number or label (absolute address), o = signed number or label (relative offset).
+typedef struct {
+   const char *operandTypes;
+   Result (*getBytes)(const Instruction*);
+} Variant;
+
+typedef struct Mnemonic {
+   const char *text;
+   int         operation;
+   Variant     variants[MAX_VARIANT_COUNT];
+} Mnemonic;
+
+static Result aluOperationWithImmediateValue(const Instruction *instruction);
+static Result aluOperationAmongRegisters(const Instruction *instruction);
+static Result stageCountOperation(const Instruction *instruction);
+static Result storeDataInMemory(const Instruction *instruction);
+static Result loadDataFromMemory(const Instruction *instruction);
+static Result jumpToAbsoluteAddress(const Instruction *instruction);
+static Result jumpConditionalUponR0ToRelativeAddress(const Instruction *instruction);
+static Result jumpConditionalUponStageCountToRelativeAddress(const Instruction *instruction);
+static Result adc(const Instruction *instruction);
+static Result i2cReadWrite(const Instruction *instruction);
+static Result readRegister(const Instruction *instruction);
+static Result writeRegister(const Instruction *instruction);
+static Result halt(const Instruction *instruction);
+static Result wake(const Instruction *instruction);
+static Result sleep(const Instruction *instruction);
+static Result wait(const Instruction *instruction);
+static Result nop(const Instruction *instruction);
+static Result tsens(const Instruction *instruction);
+
+static Result waitCycles(int cycles);
+static Result error(char *errorMessage);
+static Result skipAndJump(uint32_t skip, uint32_t jump);
+static uint32_t setRelativeJumpStep(uint32_t word, int stepInBytes);
+static bool isRelativeJumpStepInRange(int stepInBytes);
+
+// The index of each mnemonic is the value mnemonicHash() returns for it. The hash function is collision free for the
+// supported mnemonics (perfect hash) -> adding a mnemonic requires to check that its slot is still free.
+static const Mnemonic mnemonics[MNEMONIC_TABLE_SIZE] = {
+   [ 0] = {"add",       ALU_ADD,   {{"rri",   aluOperationWithImmediateValue},  {"rrr", aluOperationAmongRegisters}}},
+   [ 7] = {"sub",       ALU_SUB,   {{"rri",   aluOperationWithImmediateValue},  {"rrr", aluOperationAmongRegisters}}},
+   [10] = {"and",       ALU_AND,   {{"rru",   aluOperationWithImmediateValue},  {"rrr", aluOperationAmongRegisters}}},
+   [52] = {"or",        ALU_OR,    {{"rru",   aluOperationWithImmediateValue},  {"rrr", aluOperationAmongRegisters}}},
+   [ 6] = {"move",      ALU_MOVE,  {{"rr",    aluOperationAmongRegisters},      {"ri",  aluOperationWithImmediateValue}}},
+   [27] = {"lsh",       ALU_LSH,   {{"rri",   aluOperationWithImmediateValue},  {"rrr", aluOperationAmongRegisters}}},
+   [11] = {"rsh",       ALU_RSH,   {{"rri",   aluOperationWithImmediateValue},  {"rrr", aluOperationAmongRegisters}}},
+
+   [13] = {"stage_inc", STAGE_INC, {{"u",     stageCountOperation}}},
+   [42] = {"stage_dec", STAGE_DEC, {{"u",     stageCountOperation}}},
+   [41] = {"stage_rst", STAGE_RST, {{"",      stageCountOperation}}},
+
+   [48] = {"st",        0,         {{"rru",   storeDataInMemory}}},
+   [24] = {"ld",        0,         {{"rru",   loadDataFromMemory}}},
+
+   [ 2] = {"jump",      0,         {{"r",     jumpToAbsoluteAddress}, {"rc", jumpToAbsoluteAddress}, {"a", jumpToAbsoluteAddress}, {"ac", jumpToAbsoluteAddress}}},
+   [36] = {"jumpr",     0,         {{"ouc",   jumpConditionalUponR0ToRelativeAddress}}},
+   [49] = {"jumps",     0,         {{"ouc",   jumpConditionalUponStageCountToRelativeAddress}}},
+
+   [20] = {"halt",      0,         {{"",      halt}}},
+   [32] = {"wake",      0,         {{"",      wake}}},
+   [18] = {"sleep",     0,         {{"u",     sleep}}},
+   [35] = {"wait",      0,         {{"u",     wait}}},
+   [15] = {"nop",       0,         {{"",      nop}}},
+   [ 1] = {"tsens",     0,         {{"ru",    tsens}}},
+   [51] = {"adc",       0,         {{"ruu",   adc}}},
+   [ 8] = {"i2c_rd",    0,         {{"uuuu",  i2cReadWrite}}},
+   [62] = {"i2c_wr",    1,         {{"uuuuu", i2cReadWrite}}},
+   [ 4] = {"reg_rd",    0,         {{"uuu",   readRegister}}},
+   [58] = {"reg_wr",    0,         {{"uuuu",  writeRegister}}},
 };
 
-static bool isWhitespace(uint8_t character) {
-   return character == SPACE || character == TAB || character == CR;
-} 
+static bool isSeparator(uint8_t character) {
+   return character == SPACE || character == TAB || character == CR || character == COMMA;
+}
+
+static uint8_t mnemonicHash(const uint8_t *text, size_t length) {
+   uint8_t thirdLastChar = length > 2 ? text[length - 3] : text[0];
+   return (tolower(text[0]) + tolower(text[1]) + 13 * tolower(text[length - 1]) + 7 * tolower(thirdLastChar)) & (MNEMONIC_TABLE_SIZE - 1);
+}
 
-static uint8_t* normalizeTokenSeparators(uint8_t *text) {
-   for(size_t index = 0; *(text + index) != 0; index++) {
-      if (*(text + index) == COMMA) {
-         *(text + index) = SPACE;
+static bool equalsIgnoringCase(const uint8_t *text, size_t length, const char *lowerCaseText) {
+   size_t index = 0;
+   for (; index < length && lowerCaseText[index] != 0; index++) {
+      if (tolower(text[index]) != lowerCaseText[index]) {
+         return false;
       }
    }
+   return index == length && lowerCaseText[index] == 0;
+}
 
-   bool previousCharWasWhitespace = false;
-   size_t insertationIndex = 0;
-   
-   for(size_t index = 0; *(text + index) != 0; index++) {
-      uint8_t currentChar = *(text + index);
-      bool currentCharIsWhitespace = isWhitespace(currentChar);
+static const Mnemonic* findMnemonic(const uint8_t *text, size_t length) {
+   if (length < 2) {
+      return NULL;
+   }
+   const Mnemonic *mnemonic = &mnemonics[mnemonicHash(text, length)];
+   return (mnemonic->text != NULL && equalsIgnoringCase(text, length, mnemonic->text)) ? mnemonic : NULL;
+}
 
-      if (!currentCharIsWhitespace) {
-         *(text + (insertationIndex++)) = currentChar;
-         previousCharWasWhitespace = false;
-      } else {
-         if (!previousCharWasWhitespace) {
-            *(text + (insertationIndex++)) = currentChar;
+// Parses hexadecimal (0x prefix), octal (0 prefix) and decimal numbers the same way strtol does with base 0.
+static bool parseNumber(const uint8_t *text, size_t length, uint32_t *value) {
+   uint32_t base  = 10;
+   size_t   index = 0;
+
+   if (length > 2 && text[0] == '0' && tolower(text[1]) == 'x') {
+      base  = 16;
+      index = 2;
+   } else if (length > 1 && text[0] == '0') {
+      base  = 8;
+      index = 1;
+   }
+
+   if (index == length) {
+      return false;
+   }
+
+   *value = 0;
+   for (; index < length; index++) {
+      uint8_t  character = tolower(text[index]);
+      uint32_t digit     = isdigit(character) ? (uint32_t)(character - '0') : (character >= 'a' && character <= 'f') ? (uint32_t)(character - 'a' + 10) : base;
+      if (digit >= base) {
+         return false;
+      }
+      *value = (*value * base) + digit;
+   }
+   return true;
+}
+
+static bool isLabelSyntax(const uint8_t *text, size_t length) {
+   if (length == 0 || !(isalpha(text[0]) || text[0] == '_' || text[0] == '.')) {
+      return false;
+   }
+   for (size_t index = 1; index < length; index++) {
+      if (!(isalnum(text[index]) || text[index] == '_' || text[index] == '.')) {
+         return false;
+      }
+   }
+   return true;
+}
+
+// "r" followed by digits looks like a register even if the ULP has no such register (only r0 - r3 exist).
+static bool isRegisterName(const uint8_t *text, size_t length) {
+   if (length < 2 || tolower(text[0]) != 'r') {
+      return false;
+   }
+   for (size_t index = 1; index < length; index++) {
+      if (!isdigit(text[index])) {
+         return false;
+      }
+   }
+   return true;
+}
+
+static bool isConditionName(const uint8_t *text, size_t length) {
+   for (size_t condition = 0; condition < sizeof(CONDITIONS) / sizeof(CONDITIONS[0]); condition++) {
+      if (equalsIgnoringCase(text, length, CONDITIONS[condition])) {
+         return true;
+      }
+   }
+   return false;
+}
+
+bool isLabel(const uint8_t *text, size_t length) {
+   return isLabelSyntax(text, length) && !isRegisterName(text, length) && !isConditionName(text, length);
+}
+
+static Operand classifyOperand(const uint8_t *text, size_t length) {
+   Operand operand = {UNKNOWN, 0, text, length};
+
+   if (length == 2) {
+      if (tolower(text[0]) == 'r' && text[1] >= '0' && text[1] <= '3') {
+         operand.type  = REGISTER;
+         operand.value = text[1] - '0';
+         return operand;
+      }
+      for (size_t condition = 0; condition < sizeof(CONDITIONS) / sizeof(CONDITIONS[0]); condition++) {
+         if (equalsIgnoringCase(text, length, CONDITIONS[condition])) {
+            operand.type  = CONDITION;
+            operand.value = condition;
+            return operand;
          }
-         previousCharWasWhitespace = true;
       }
    }
-   
-   *(text + insertationIndex) = 0;
-   return text;
+
+   if (isLabel(text, length)) {
+      operand.type = LABEL;
+      return operand;
+   }
+
+   bool     isNegative = length > 0 && text[0] == MINUS;
+   uint32_t number     = 0;
+   if (parseNumber(text + (isNegative ? 1 : 0), length - (isNegative ? 1 : 0), &number)) {
+      operand.type  = isNegative ? NEGATIVE_NUMBER : UNSIGNED_NUMBER;
+      operand.value = isNegative ? -(int32_t)number : (int32_t)number;
+   }
+   return operand;
 }
 
-Result getCommandBytesFor(const uint8_t *line) {
-   uint8_t copyOfLine[strlen((char*)line) + 1];
-   strcpy((char*)copyOfLine, (char*)line);
-   
-   uint8_t* trimmedLine             = trim(copyOfLine);
-   uint8_t* trimmedAndLowerCaseLine = toLowerCase(trimmedLine);
-   uint8_t* normalizedLine          = normalizeTokenSeparators(trimmedAndLowerCaseLine);
-   
-   for (size_t i = 0; commands[i].pattern != NULL; i++) {
-      regex_t regex;
-      char pattern[strlen(commands[i].pattern) + 2];
-      sprintf(pattern, "^%s$", commands[i].pattern);
-      if(regcomp(&regex, pattern, REG_EXTENDED) != 0) {
-         printf("ERROR: failed to compile regex pattern \"%s\"\n", commands[i].pattern);
+// Splits the line into the mnemonic and its operands in a single pass without copying it. Returns false if the
+// mnemonic is unknown or the line contains more operands than any command supports.
+static bool tokenize(const uint8_t *line, size_t lineLength, Instruction *instruction) {
+   instruction->mnemonic     = NULL;
+   instruction->operandCount = 0;
+
+   const uint8_t *position = line;
+   const uint8_t *end      = line + lineLength;
+   while (true) {
+      while (position < end && isSeparator(*position)) {
+         position++;
+      }
+      if (position == end) {
+         break;
+      }
+
+      const uint8_t *tokenStart = position;
+      while (position < end && !isSeparator(*position)) {
+         position++;
+      }
+      size_t tokenLength = position - tokenStart;
+
+      if (instruction->mnemonic == NULL) {
+         instruction->mnemonic = findMnemonic(tokenStart, tokenLength);
+         if (instruction->mnemonic == NULL) {
+            return false;
+         }
       } else {
-         int result = regexec(&regex, (char*)normalizedLine, 0, NULL, 0);
-         regfree(&regex);
-         if (result == 0) {
-            return commands[i].getBytes(normalizedLine);
+         if (instruction->operandCount == MAX_OPERAND_COUNT) {
+            return false;
          }
+         instruction->operands[instruction->operandCount++] = classifyOperand(tokenStart, tokenLength);
       }
    }
+   return instruction->mnemonic != NULL;
+}
 
-   CommandBytes commandBytes = {0x00, 0x00, 0x00, 0x00};
-   return (Result){commandBytes, UNSUPPORTED_COMMAND};
+static bool operandMatches(const Operand *operand, char expectedType) {
+   switch (expectedType) {
+      case 'r': return operand->type == REGISTER;
+      case 'u': return operand->type == UNSIGNED_NUMBER;
+      case 'i': return operand->type == UNSIGNED_NUMBER || operand->type == NEGATIVE_NUMBER;
+      case 'c': return operand->type == CONDITION;
+      case 'a': return operand->type == UNSIGNED_NUMBER || operand->type == LABEL;
+      case 'o': return operand->type == UNSIGNED_NUMBER || operand->type == NEGATIVE_NUMBER || operand->type == LABEL;
+   }
+   return false;
 }
 
-static Result addImmediate(uint8_t *commandAsText) {
-   return aluOperationWithImmediateValue(commandAsText);
+static bool operandsMatch(const Instruction *instruction, const char *operandTypes) {
+   if (strlen(operandTypes) != instruction->operandCount) {
+      return false;
+   }
+   for (size_t index = 0; index < instruction->operandCount; index++) {
+      if (!operandMatches(&instruction->operands[index], operandTypes[index])) {
+         return false;
+      }
+   }
+   return true;
 }
 
-static Result subImmediate(uint8_t *commandAsText) {
-   return aluOperationWithImmediateValue(commandAsText);
+// Adds the label used as jump target (if there is one) to the result.
+static Result withLabel(Result result, const Instruction *instruction) {
+   for (size_t index = 0; result.errorMessage == NULL && index < instruction->operandCount; index++) {
+      if (instruction->operands[index].type == LABEL) {
+         result.label       = instruction->operands[index].text;
+         result.labelLength = instruction->operands[index].length;
+      }
+   }
+   return result;
 }
 
-static Result andImmediate(uint8_t *commandAsText) {
-   return aluOperationWithImmediateValue(commandAsText);
+Result getCommandBytesFor(const uint8_t *line) {
+   return getCommandBytesForLine(line, strlen((const char*)line));
 }
 
-static Result orImmediate(uint8_t *commandAsText) {
-   return aluOperationWithImmediateValue(commandAsText);
+Result getCommandBytesForLine(const uint8_t *line, size_t lineLength) {
+   Instruction instruction;
+
+   if (tokenize(line, lineLength, &instruction)) {
+      const Variant *variants = instruction.mnemonic->variants;
+      for (size_t index = 0; index < MAX_VARIANT_COUNT && variants[index].operandTypes != NULL; index++) {
+         if (operandsMatch(&instruction, variants[index].operandTypes)) {
+            return withLabel(variants[index].getBytes(&instruction), &instruction);
+         }
+      }
+   }
+
+   return error(UNSUPPORTED_COMMAND);
 }
 
-static Result addRegister(uint8_t *commandAsText) {
-   return aluOperationAmongRegisters(commandAsText);
+static CommandBytes toCommandBytes(uint32_t word) {
+   return (CommandBytes){word & 0xff, (word >> 8) & 0xff, (word >> 16) & 0xff, word >> 24};
 }
 
-static Result subRegister(uint8_t *commandAsText) {
-   return aluOperationAmongRegisters(commandAsText);
+static uint32_t toWord(const CommandBytes *commandBytes) {
+   return commandBytes->byte0 | (commandBytes->byte1 << 8) | (commandBytes->byte2 << 16) | ((uint32_t)commandBytes->byte3 << 24);
 }
 
-static Result andRegister(uint8_t *commandAsText) {
-   return aluOperationAmongRegisters(commandAsText);
+static Result command(uint32_t word) {
+   return (Result){.commandBytes = toCommandBytes(word), .errorMessage = NULL};
 }
 
-static Result orRegister(uint8_t *commandAsText) {
-   return aluOperationAmongRegisters(commandAsText);
+static Result error(char *errorMessage) {
+   CommandBytes commandBytes = {0x00, 0x00, 0x00, 0x00};
+   return (Result){.commandBytes = commandBytes, .errorMessage = errorMessage};
 }
 
-static Result nop(uint8_t *commandAsText) {
-   return waitCycles(0);
+// Two commands of a pseudo command: skip jumps behind jump if the condition is not fulfilled.
+static Result skipAndJump(uint32_t skip, uint32_t jump) {
+   Result result                    = command(skip);
+   result.additionalCommandCount    = 1;
+   result.additionalCommandBytes[0] = toCommandBytes(jump);
+   return result;
 }
 
-static Result leftShiftRegister(uint8_t *commandAsText) {
-   return aluOperationAmongRegisters(commandAsText);
+static Result nop(const Instruction *instruction) {
+   (void)instruction;
+   return waitCycles(0);
 }
 
-static Result rightShiftRegister(uint8_t *commandAsText) {
-   return aluOperationAmongRegisters(commandAsText);
+// The bit layouts of the commands are defined in InstructionSet.h.
+
+static Result aluOperationWithImmediateValue(const Instruction *instruction) {
+   bool isMove   = instruction->mnemonic->operation == ALU_MOVE;
+   uint32_t word = createWord(FORMAT_ALU_IMMEDIATE);
+   word          = setField(word, FIELD_ALU_OPERATION,           instruction->mnemonic->operation);
+   word          = setField(word, FIELD_ALU_DESTINATION_REGISTER, instruction->operands[0].value);
+   word          = setField(word, FIELD_ALU_SOURCE_REGISTER1,     isMove ? 0 : instruction->operands[1].value);
+   word          = setField(word, FIELD_ALU_IMMEDIATE,            instruction->operands[isMove ? 1 : 2].value);
+   return command(word);
 }
 
-static Result leftShiftImmediate(uint8_t *commandAsText) {
-   return aluOperationWithImmediateValue(commandAsText);
+static Result aluOperationAmongRegisters(const Instruction *instruction) {
+   int sourceRegister1 = instruction->operands[1].value;
+   // According to the technical reference manual this should not be necessary but decoded code (generate by the compiler of IDF) sets Rsrc2 = Rsrc1 for move commands.
+   int sourceRegister2 = instruction->mnemonic->operation == ALU_MOVE ? sourceRegister1 : instruction->operands[2].value;
+   uint32_t word       = createWord(FORMAT_ALU_REGISTERS);
+   word                = setField(word, FIELD_ALU_OPERATION,            instruction->mnemonic->operation);
+   word                = setField(word, FIELD_ALU_DESTINATION_REGISTER, instruction->operands[0].value);
+   word                = setField(word, FIELD_ALU_SOURCE_REGISTER1,     sourceRegister1);
+   word                = setField(word, FIELD_ALU_SOURCE_REGISTER2,     sourceRegister2);
+   return command(word);
 }
 
-static Result rightShiftImmediate(uint8_t *commandAsText) {
-   return aluOperationWithImmediateValue(commandAsText);
+static Result stageCountOperation(const Instruction *instruction) {
+   uint32_t word = createWord(FORMAT_STAGE_COUNT);
+   word          = setField(word, FIELD_ALU_OPERATION,         instruction->mnemonic->operation);
+   word          = setField(word, FIELD_STAGE_COUNT_IMMEDIATE, instruction->operandCount > 0 ? instruction->operands[0].value : 0);
+   return command(word);
 }
 
-static Result jumpRegister(uint8_t *commandAsText){
-   return jumpToAbsoluteAddress(commandAsText, false, false);
+static Result storeDataInMemory(const Instruction *instruction) {
+   uint32_t word = createWord(FORMAT_ST);
+   word          = setField(word, FIELD_MEMORY_DATA_REGISTER,    instruction->operands[0].value);
+   word          = setField(word, FIELD_MEMORY_ADDRESS_REGISTER, instruction->operands[1].value);
+   word          = setField(word, FIELD_MEMORY_OFFSET,           instruction->operands[2].value / 4);
+   return command(word);
 }
 
-static Result jumpImmediate(uint8_t *commandAsText){
-   return jumpToAbsoluteAddress(commandAsText, true, false);
+static Result loadDataFromMemory(const Instruction *instruction) {
+   uint32_t word = createWord(FORMAT_LD);
+   word          = setField(word, FIELD_MEMORY_DATA_REGISTER,    instruction->operands[0].value);
+   word          = setField(word, FIELD_MEMORY_ADDRESS_REGISTER, instruction->operands[1].value);
+   word          = setField(word, FIELD_MEMORY_OFFSET,           instruction->operands[2].value / 4);
+   return command(word);
 }
 
-static Result jumpRegisterConditional(uint8_t *commandAsText){
-   return jumpToAbsoluteAddress(commandAsText, false, true);
+static Result jumpToAbsoluteAddress(const Instruction *instruction) {
+   bool isImmediate = instruction->operands[0].type != REGISTER;
+   int jumpType     = instruction->operandCount == 2 ? ABSOLUTE_JUMP_TYPES[instruction->operands[1].value] : JUMP_ALWAYS;
+   if (jumpType == NO_ENCODING) {
+      return error(UNSUPPORTED_COMMAND);
+   }
+
+   uint32_t word    = createWord(FORMAT_JUMP);
+   word             = setField(word, FIELD_JUMP_TYPE,                jumpType);
+   word             = setField(word, FIELD_JUMP_ADDRESS_IN_REGISTER, isImmediate ? 0 : 1);
+   word             = setField(word, isImmediate ? FIELD_JUMP_ADDRESS : FIELD_JUMP_REGISTER, isImmediate ? instruction->operands[0].value / 4 : instruction->operands[0].value);
+   return command(word);
 }
 
-static Result jumpImmediateConditional(uint8_t *commandAsText){
-   return jumpToAbsoluteAddress(commandAsText, true, true);
+static uint32_t jumpRelativeUponR0(int stepInBytes, int threshold, Condition condition) {
+   uint32_t word = createWord(FORMAT_JUMPR);
+   word          = setField(word, FIELD_JUMPR_THRESHOLD, threshold);
+   word          = setField(word, FIELD_JUMPR_CONDITION, JUMPR_CONDITIONS[condition]);
+   return setRelativeJumpStep(word, stepInBytes);
 }
 
-static int aluOperation(char *instruction) {
-   if (strcmp(instruction, "add") == 0) {
-      return 0;
-   }
-   if (strcmp(instruction, "sub") == 0) {
-      return 1;
+// The ULP supports only the conditions lt and ge. The others get replaced like the IDF does it, see
+// https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-guides/ulp_instruction_set.html#jumpr-jump-to-a-relative-offset-condition-based-on-r0.
+// Thresholds at the limits of the 16 bit range need a single command only.
+static Result jumpConditionalUponR0ToRelativeAddress(const Instruction *instruction) {
+   int maxThreshold                 = getFieldMaximum(FIELD_JUMPR_THRESHOLD);
+   int stepInBytes                  = instruction->operands[0].value;
+   int threshold                    = instruction->operands[1].value & maxThreshold;
+   Condition condition              = instruction->operands[2].value;
+
+   if (condition == OV) {
+      return error(UNSUPPORTED_COMMAND);
    }
-   if (strcmp(instruction, "and") == 0) {
-      return 2;
+   bool isTwoCommandEquality = condition == EQ && threshold > 0 && threshold < maxThreshold;
+   if (!isRelativeJumpStepInRange(isTwoCommandEquality ? stepInBytes - 4 : stepInBytes)) {
+      return error(RELATIVE_JUMP_STEP_OUT_OF_RANGE_ERROR_MESSAGE);
    }
-   if (strcmp(instruction, "or") == 0) {
-      return 3;
+
+   switch (condition) {
+      case LE:
+         // r0 <= 0xffff is always true
+         return command(threshold < maxThreshold ? jumpRelativeUponR0(stepInBytes, threshold + 1, LT) : jumpRelativeUponR0(stepInBytes, 0, GE));
+      case GT:
+         // r0 > 0xffff is never true
+         return command(threshold < maxThreshold ? jumpRelativeUponR0(stepInBytes, threshold + 1, GE) : jumpRelativeUponR0(stepInBytes, 0, LT));
+      case EQ:
+         if (threshold == 0) {
+            return command(jumpRelativeUponR0(stepInBytes, 1, LT));
+         }
+         if (threshold == maxThreshold) {
+            return command(jumpRelativeUponR0(stepInBytes, maxThreshold, GE));
+         }
+         return skipAndJump(jumpRelativeUponR0(2 * 4, threshold + 1, GE), jumpRelativeUponR0(stepInBytes - 4, threshold, GE));
+      default:
+         return command(jumpRelativeUponR0(stepInBytes, threshold, condition));
    }
-   if (strcmp(instruction, "move") == 0) {
-      return 4;
+}
+
+static uint32_t jumpRelativeUponStageCount(int stepInBytes, int threshold, Condition condition) {
+   uint32_t word = createWord(FORMAT_JUMPS);
+   word          = setField(word, FIELD_JUMPS_THRESHOLD, threshold);
+   word          = setField(word, FIELD_JUMPS_CONDITION, JUMPS_CONDITIONS[condition]);
+   return setRelativeJumpStep(word, stepInBytes);
+}
+
+// The ULP supports only the conditions lt, le and ge. The others get replaced like the IDF does it, see
+// https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-guides/ulp_instruction_set.html#jumps-jump-to-a-relative-address-condition-based-on-stage-count.
+// In contrast to the IDF, gt needs a single command ("gt t" is "ge t + 1").
+static Result jumpConditionalUponStageCountToRelativeAddress(const Instruction *instruction) {
+   int maxThreshold                 = getFieldMaximum(FIELD_JUMPS_THRESHOLD);
+   int stepInBytes                  = instruction->operands[0].value;
+   int threshold                    = instruction->operands[1].value & maxThreshold;
+   Condition condition              = instruction->operands[2].value;
+
+   if (condition == OV) {
+      return error(UNSUPPORTED_COMMAND);
    }
-   if (strcmp(instruction, "lsh") == 0) {
-      return 5;
+   bool isTwoCommandEquality = condition == EQ && threshold > 0 && threshold < maxThreshold;
+   if (!isRelativeJumpStepInRange(isTwoCommandEquality ? stepInBytes - 4 : stepInBytes)) {
+      return error(RELATIVE_JUMP_STEP_OUT_OF_RANGE_ERROR_MESSAGE);
    }
-   if (strcmp(instruction, "rsh") == 0) {
-      return 6;
+
+   switch (condition) {
+      case GT:
+         // the stage count is never greater than 0xff
+         return command(threshold < maxThreshold ? jumpRelativeUponStageCount(stepInBytes, threshold + 1, GE) : jumpRelativeUponStageCount(stepInBytes, 0, LT));
+      case EQ:
+         if (threshold == 0) {
+            return command(jumpRelativeUponStageCount(stepInBytes, 0, LE));
+         }
+         if (threshold == maxThreshold) {
+            return command(jumpRelativeUponStageCount(stepInBytes, maxThreshold, GE));
+         }
+         return skipAndJump(jumpRelativeUponStageCount(2 * 4, threshold, LT), jumpRelativeUponStageCount(stepInBytes - 4, threshold, LE));
+      default:
+         return command(jumpRelativeUponStageCount(stepInBytes, threshold, condition));
    }
-   return -1;
 }
 
-static int stageCountAluOperation(char *instruction) {
-   if (strcmp(instruction, "stage_inc") == 0) {
-      return 0;
-   }
-   if (strcmp(instruction, "stage_dec") == 0) {
-      return 1;
+// The step field contains the absolute value of the step in words (7 bit) -> the step can be up to 127 words in both directions.
+static bool isRelativeJumpStepInRange(int stepInBytes) {
+   int stepInWords = stepInBytes / 4;
+   return isInFieldRange(FIELD_RELATIVE_JUMP_STEP, stepInWords < 0 ? -stepInWords : stepInWords);
+}
+
+// Sets sign and step of a relative jump (jumpr and jumps use the same bits).
+static uint32_t setRelativeJumpStep(uint32_t word, int stepInBytes) {
+   bool incrementProgramCounter = stepInBytes >= 0;
+   word                         = setField(word, FIELD_RELATIVE_JUMP_STEP, (incrementProgramCounter ? stepInBytes : -stepInBytes) / 4);
+   return setField(word, FIELD_RELATIVE_JUMP_SIGN, incrementProgramCounter ? 0 : 1);
+}
+
+bool setJumpTarget(CommandBytes *commandBytes, uint32_t commandAddress, uint32_t targetAddress) {
+   uint32_t word = toWord(commandBytes);
+
+   if (hasFormat(word, FORMAT_JUMP) && getField(word, FIELD_JUMP_ADDRESS_IN_REGISTER) == 0) {
+      if (targetAddress / 4 > (uint32_t)getFieldMaximum(FIELD_JUMP_ADDRESS)) {
+         return false;
+      }
+      *commandBytes = toCommandBytes(setField(word, FIELD_JUMP_ADDRESS, targetAddress / 4));
+      return true;
    }
-   if (strcmp(instruction, "stage_rst") == 0) {
-      return 2;
+   if (hasFormat(word, FORMAT_JUMPR) || hasFormat(word, FORMAT_JUMPS)) {
+      int stepInBytes = (int)targetAddress - (int)commandAddress;
+      if (!isRelativeJumpStepInRange(stepInBytes)) {
+         return false;
+      }
+      *commandBytes = toCommandBytes(setRelativeJumpStep(word, stepInBytes));
+      return true;
    }
-   return -1;
+   return false;
 }
 
-static int absoluteJumpType(char *condition) {
-   if (strcmp(condition, "eq") == 0) {
-      return 1;
+bool getJumpTargetAddress(const CommandBytes *commandBytes, uint32_t commandAddress, uint32_t *targetAddress) {
+   uint32_t word = toWord(commandBytes);
+
+   if (hasFormat(word, FORMAT_JUMP) && getField(word, FIELD_JUMP_ADDRESS_IN_REGISTER) == 0) {
+      *targetAddress = getField(word, FIELD_JUMP_ADDRESS) * 4;
+      return true;
    }
-   if (strcmp(condition, "ov") == 0) {
-      return 2;
+   if (hasFormat(word, FORMAT_JUMPR) || hasFormat(word, FORMAT_JUMPS)) {
+      int32_t stepInBytes = getField(word, FIELD_RELATIVE_JUMP_STEP) * 4;
+      int64_t target      = (int64_t)commandAddress + (getField(word, FIELD_RELATIVE_JUMP_SIGN) ? -stepInBytes : stepInBytes);
+      if (target < 0) {
+         return false;
+      }
+      *targetAddress = (uint32_t)target;
+      return true;
    }
-   return -1;
+   return false;
 }
 
-static int relativeStageCountCondition(char *condition) {
-   if (strcmp(condition, "le") == 0) {
-      return 2;
+bool relaxRelativeJump(CommandBytes *commandBytes, uint32_t targetAddress, CommandBytes *absoluteJump) {
+   uint32_t word = toWord(commandBytes);
+
+   if (!(hasFormat(word, FORMAT_JUMPR) || hasFormat(word, FORMAT_JUMPS)) || targetAddress / 4 > (uint32_t)getFieldMaximum(FIELD_JUMP_ADDRESS)) {
+      return false;
    }
-   if (strcmp(condition, "lt") == 0) {
-      return 0;
+   if (hasFormat(word, FORMAT_JUMPR)) {
+      // jumpr: lt <-> ge
+      word = setField(word, FIELD_JUMPR_CONDITION, getField(word, FIELD_JUMPR_CONDITION) == JUMPR_LT ? JUMPR_GE : JUMPR_LT);
+   } else {
+      // jumps: lt <-> ge, "le t" becomes "ge t + 1" ("le 255" is always true -> "lt 0" never skips the absolute jump)
+      int maxThreshold = getFieldMaximum(FIELD_JUMPS_THRESHOLD);
+      int condition    = getField(word, FIELD_JUMPS_CONDITION);
+      int threshold    = getField(word, FIELD_JUMPS_THRESHOLD);
+      if (condition == JUMPS_LE) {
+         condition = threshold < maxThreshold ? JUMPS_GE : JUMPS_LT;
+         threshold = threshold < maxThreshold ? threshold + 1 : 0;
+      } else {
+         condition = condition == JUMPS_LT ? JUMPS_GE : JUMPS_LT;
+      }
+      word = setField(word, FIELD_JUMPS_THRESHOLD, threshold);
+      word = setField(word, FIELD_JUMPS_CONDITION, condition);
    }
-   if (strcmp(condition, "ge") == 0) {
-      return 1;
+   *commandBytes = toCommandBytes(setRelativeJumpStep(word, 2 * 4));
+   *absoluteJump = toCommandBytes(setField(createWord(FORMAT_JUMP), FIELD_JUMP_ADDRESS, targetAddress / 4));
+   return true;
+}
+
+static Result adc(const Instruction *instruction) {
+   uint32_t word = createWord(FORMAT_ADC);
+   word          = setField(word, FIELD_ADC_DESTINATION_REGISTER, instruction->operands[0].value);
+   word          = setField(word, FIELD_ADC_SAR_SELECT,           instruction->operands[1].value);
+   word          = setField(word, FIELD_ADC_PAD,                  instruction->operands[2].value);
+   return command(word);
+}
+
+static Result i2cReadWrite(const Instruction *instruction) {
+   int isWrite            = instruction->mnemonic->operation;
+   const Operand *operand = instruction->operands;
+   uint32_t word          = createWord(FORMAT_I2C);
+   word                   = setField(word, FIELD_I2C_DIRECTION,      isWrite);
+   word                   = setField(word, FIELD_I2C_SUB_ADDRESS,    (operand++)->value);
+   if (isWrite) {
+      word                = setField(word, FIELD_I2C_DATA,           (operand++)->value);
    }
-   return -1;
+   word                   = setField(word, FIELD_I2C_MASK_HIGH,      (operand++)->value);
+   word                   = setField(word, FIELD_I2C_MASK_LOW,       (operand++)->value);
+   word                   = setField(word, FIELD_I2C_SLAVE_REGISTER, (operand++)->value);
+   return command(word);
 }
 
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 001a  aaa0 iiii  iiii iiii  iiii ssdd   content: o = opCode, a = ALU operation, i = signed immediate value, s = source register, d = destination register
-static Result aluOperationWithImmediateValue(uint8_t *commandAsText) {
-   int opCode                = 7;
-   int bit25to27             = 1;
-   char *operation           = strtok((char*)commandAsText, " ");
-   int destinationRegister   = atoi(strtok( NULL, " ") + 1);
-   int sourceRegister        = 0;
-   if (strcmp(operation, "move") != 0) {
-      sourceRegister = atoi(strtok( NULL, " ") + 1);
-   }
-   char *immediateText = strtok( NULL, " ");
-   int16_t immediate         = (int16_t)strtol(immediateText, NULL, 0);
-   int aluOperatation        = aluOperation(operation);
-   
-   uint8_t byte0             = (destinationRegister & 0x03) | ((sourceRegister & 0x03) << 2) | ((immediate & 0xf) << 4);
-   uint8_t byte1             = (immediate & 0xff0) >> 4;
-   uint8_t byte2             = ((aluOperatation & 0x7) << 5) | ((immediate & 0xf000) >> 12);
-   uint8_t byte3             = (opCode << 4) | (bit25to27 << 1) | ((aluOperatation & 0x8) >> 3);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
+static Result readRegister(const Instruction *instruction) {
+   uint32_t word = createWord(FORMAT_REG_RD);
+   word          = setField(word, FIELD_REGISTER_ADDRESS,   instruction->operands[0].value);
+   word          = setField(word, FIELD_REGISTER_END_BIT,   instruction->operands[1].value);
+   word          = setField(word, FIELD_REGISTER_START_BIT, instruction->operands[2].value);
+   return command(word);
 }
 
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 000a  aaa0 0000  0000 0000  00SS ssdd   content: o = opCode, a = ALU operation, i = immediate value, S = source register2, s = source register1, d = destination register
-static Result aluOperationAmongRegisters(uint8_t *commandAsText) {
-   int opCode                = 7;
-   int bit25to27             = 0;
-   char *operation           = strtok((char*)commandAsText, " ");
-   int destinationRegister   = atoi(strtok( NULL, " ") + 1);
-   int sourceRegister1       = atoi(strtok( NULL, " ") + 1);
-   int sourceRegister2       = 0;
-   if (strcmp(operation, "move") == 0) {
-      sourceRegister2 = sourceRegister1; // According to the technical reference manual this should not be necessary but decoded code (generate by the compiler of IDF) sets Rsrc2 = Rsrc1 for move commands.
-   } else {
-      sourceRegister2 = atoi(strtok( NULL, " ") + 1);
-   }
-   int aluOperatation        = aluOperation(operation);
-   
-   uint8_t byte0             = (destinationRegister & 0x03) | ((sourceRegister1 & 0x03) << 2) | ((sourceRegister2 & 0x03) << 4);
-   uint8_t byte1             = 0x00;
-   uint8_t byte2             = (aluOperatation & 0x7) << 5;
-   uint8_t byte3             = (opCode << 4) | (bit25to27 << 1) | ((aluOperatation & 0x8) >> 3);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 010a  aaa0 0000  0000 iiii  iiii 0000   content: o = opCode, a = ALU operation, i = immediate value
-static Result stageCountOperation(uint8_t *commandAsText) {
-   int opCode                = 7;
-   int bit25to27             = 2;
-   char *operation           = strtok((char*)commandAsText, " ");
-   int immediate             = 0;
-   if (strcmp(operation, "stage_rst") != 0) {
-      immediate = strtol(strtok( NULL, " "), NULL, 0);
-   }
-   int aluOperatation        = stageCountAluOperation(operation);
-   
-   uint8_t byte0             = (immediate & 0x0f) << 4;
-   uint8_t byte1             = (immediate & 0xf0) >> 4;
-   uint8_t byte2             = (aluOperatation & 0x7) << 5;
-   uint8_t byte3             = (opCode << 4) | (bit25to27 << 1) | ((aluOperatation & 0x8) >> 3);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 1000  000k kkkk  kkkk kk00  0000 ddss   content: o = opCode, k = offset in 32-bit words, s = source register, d = destination register
-static Result storeDataInMemory(uint8_t *commandAsText) {
-   int opCode                = 6;
-   int bit25to27             = 4;
-   strtok((char*)commandAsText, " ");
-   int sourceRegister        = atoi(strtok( NULL, " ") + 1);
-   int destinationRegister   = atoi(strtok( NULL, " ") + 1);
-   int offsetInBytes         = strtol(strtok( NULL, " "), NULL, 0);
-   int offsetInWords         = offsetInBytes / 4;
-   
-   uint8_t byte0             = (sourceRegister & 0x03) | ((destinationRegister & 0x03) << 2);
-   uint8_t byte1             = (offsetInWords & 0x03f) << 2;
-   uint8_t byte2             = (offsetInWords & 0x7c0) >> 6;
-   uint8_t byte3             = (opCode << 4) | (bit25to27 << 1);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 0000  000k kkkk  kkkk kk00  0000 ddss   content: o = opCode, k = offset in 32-bit words, s = source register, d = destination register
-static Result loadDataFromMemory(uint8_t *commandAsText) {
-   int opCode                = 13;
-   int bit25to27             = 0;
-   strtok((char*)commandAsText, " ");
-   int destinationRegister   = atoi(strtok( NULL, " ") + 1);
-   int sourceRegister        = atoi(strtok( NULL, " ") + 1);
-   int offsetInBytes         = strtol(strtok( NULL, " "), NULL, 0);
-   int offsetInWords         = offsetInBytes / 4;
-   
-   uint8_t byte0             = (destinationRegister & 0x03) | ((sourceRegister & 0x03) << 2);
-   uint8_t byte1             = (offsetInWords & 0x03f) << 2;
-   uint8_t byte2             = (offsetInWords & 0x3c0) >> 6;
-   uint8_t byte3             = (opCode << 4) | (bit25to27 << 1);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 000t  ttg0 0000  000k kkkk  kkkk kkdd   content: o = opCode, t = jump type, g = immediate/destination register, k = immediate address in 32-bit words, d = destination register
-static Result jumpToAbsoluteAddress(uint8_t *commandAsText, bool isImmediate, bool isConditional) {
-   int opCode                       = 8;
-   int bit25to27                    = 0;
-   strtok((char*)commandAsText, " ");
-   int immediateInWords             = 0;
-   int destinationRegister          = 0; 
-   int addressInDestinationRegister = isImmediate ? 0 : 1;
-   if (isImmediate) {
-      int immediateInBytes          = strtol(strtok( NULL, " "), NULL, 0);
-      immediateInWords              = immediateInBytes / 4;
-   } else {
-      destinationRegister           = atoi(strtok( NULL, " ") + 1);
-   }
-   int jumpType                     = 0;
-   if (isConditional) {
-      jumpType                      = absoluteJumpType(strtok( NULL, " "));
-   }
-   
-   uint8_t byte0                    = (destinationRegister & 0x3) | ((immediateInWords & 0x3f) << 2);
-   uint8_t byte1                    = (immediateInWords & 0x7c0) >> 6;
-   uint8_t byte2                    = ((jumpType & 0x3) << 6) | (addressInDestinationRegister << 5);
-   uint8_t byte3                    = (opCode << 4) | (bit25to27 << 1) | ((jumpType & 0x4) >> 2);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 001k  ssss sssc  tttt tttt  tttt tttt   content: o = opCode, k = sign (0 -> PC + steps, 1 -> PC - steps), s = relative step in 32-bit words, c = condition, t = threshold
-static Result jumpConditionalUponR0ToRelativeAddress(uint8_t *commandAsText) {
-   int opCode                       = 8;
-   int bit25to27                    = 1;
-   strtok((char*)commandAsText, " ");
-   int stepInBytes                  = strtol(strtok( NULL, " "), NULL, 0);
-   bool incrementProgramCounter     = (stepInBytes & 0x80) == 0;
-   stepInBytes                      = (stepInBytes * (incrementProgramCounter ? 1 : -1)) & 0x7f;
-   int stepInWords                  = stepInBytes / 4;
-   int threshold                    = strtol(strtok( NULL, " "), NULL, 0);
-   char *conditionAsText            = strtok( NULL, " ");
-   int condition                    = (strcmp(conditionAsText, "lt") == 0) ? 0 : 1;
-
-   uint8_t byte0                    = threshold & 0xff;
-   uint8_t byte1                    = (threshold & 0xff00) >> 8;
-   uint8_t byte2                    = (stepInWords << 1) | condition;
-   uint8_t byte3                    = (opCode << 4) | (bit25to27 << 1) | (incrementProgramCounter ? 0 : 1);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 010k  ssss sssc  c000 0000  tttt tttt   content: o = opCode, k = sign (0 -> PC + steps, 1 -> PC - steps), s = relative step in 32-bit words, c = condition, t = threshold
-static Result jumpConditionalUponStageCountToRelativeAddress(uint8_t *commandAsText) {
-   int opCode                       = 8;
-   int bit25to27                    = 2;
-   strtok((char*)commandAsText, " ");
-   int stepInBytes                  = strtol(strtok( NULL, " "), NULL, 0);
-   bool incrementProgramCounter     = (stepInBytes & 0x80) == 0;
-   stepInBytes                      = (stepInBytes * (incrementProgramCounter ? 1 : -1)) & 0x7f;
-   int stepInWords                  = stepInBytes / 4;
-   int threshold                    = strtol(strtok( NULL, " "), NULL, 0);
-   int condition                    = relativeStageCountCondition(strtok( NULL, " "));
-
-   uint8_t byte0                    = threshold & 0xff;
-   uint8_t byte1                    = (condition & 0x1) << 7;
-   uint8_t byte2                    = (stepInWords << 1) | ((condition & 0x2) >> 1);
-   uint8_t byte3                    = (opCode << 4) | (bit25to27 << 1) | (incrementProgramCounter ? 0 : 1);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo 0000  0000 0000  0000 0000  0smm mmdd   content: o = opCode, s = selected ADC, m = SARADC pad, d = destination register
-static Result adc(uint8_t *commandAsText) {
-   int opCode                       = 5;
-   strtok((char*)commandAsText, " ");
-   int destinationRegister          = atoi(strtok( NULL, " ") + 1);
-   int sarSelect                    = strtol(strtok( NULL, " "), NULL, 0);
-   int pad                          = strtol(strtok( NULL, " "), NULL, 0);
-
-   uint8_t byte0                    = (destinationRegister & 0x3) | (pad << 2) | ((sarSelect & 0x1) << 6);
-   uint8_t byte1                    = 0x00;
-   uint8_t byte2                    = 0x00;
-   uint8_t byte3                    = opCode << 4;
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo r0ss  sshh hlll  dddd dddd  aaaa aaaa   content: o = opCode, r = communication direction, s = select register, h = bit mask (high part), l = bit mask (low part), d = data, a = slave register address
-static Result i2cReadWrite(uint8_t *commandAsText) {
-   int opCode                       = 3;
-   char *operation                  = strtok((char*)commandAsText, " ");
-   int readWrite                    = (strcmp(operation, "i2c_wr") == 0) ? 1 : 0;
-   int subAddress                   = strtol(strtok( NULL, " "), NULL, 0);
-   int data                         = 0;
-   if (readWrite == 1) {
-      data = strtol(strtok( NULL, " "), NULL, 0);
-   }
-   int maskHighPart                 = strtol(strtok( NULL, " "), NULL, 0);
-   int maskLowPart                  = strtol(strtok( NULL, " "), NULL, 0);
-   int slaveRegister                = strtol(strtok( NULL, " "), NULL, 0);
-
-   uint8_t byte0                    = subAddress & 0xff;
-   uint8_t byte1                    = data & 0xff;
-   uint8_t byte2                    = maskLowPart | (maskHighPart << 3) | ((slaveRegister & 0x3) << 6);
-   uint8_t byte3                    = (opCode << 4) | (readWrite << 3) | ((slaveRegister & 0xc) >> 2);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo hhhh  hlll ll00  0000 00aa  aaaa aaaa   content: o = opCode, h = register end bit number, l = register start bit number, a = register address
-static Result readRegister(uint8_t *commandAsText) {
-   int opCode                       = 2;
-   strtok((char*)commandAsText, " ");
-   int registerAddress              = strtol(strtok( NULL, " "), NULL, 0);
-   int endBitNumber                 = strtol(strtok( NULL, " "), NULL, 0);
-   int startBitNumber               = strtol(strtok( NULL, " "), NULL, 0);
-   
-   uint8_t byte0                    = registerAddress & 0xff;
-   uint8_t byte1                    = (registerAddress & 0x300) >> 8;
-   uint8_t byte2                    = (startBitNumber << 2) | ((endBitNumber & 0x1) << 7);
-   uint8_t byte3                    = (opCode << 4) | ((endBitNumber & 0x1e) >> 1);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// byte3      byte2      byte1      byte0
-// ------------------------------------------
-// 1098 7654  3210 9876  5432 1098  7654 3210   position
-// oooo hhhh  hlll lldd  dddd ddaa  aaaa aaaa   content: o = opCode, h = register end bit number, l = register start bit number, a = register address
-static Result writeRegister(uint8_t *commandAsText) {
-   int opCode                       = 1;
-   strtok((char*)commandAsText, " ");
-   int registerAddress              = strtol(strtok( NULL, " "), NULL, 0);
-   int endBitNumber                 = strtol(strtok( NULL, " "), NULL, 0);
-   int startBitNumber               = strtol(strtok( NULL, " "), NULL, 0);
-   int data                         = strtol(strtok( NULL, " "), NULL, 0);
-   
-   uint8_t byte0                    = registerAddress & 0xff;
-   uint8_t byte1                    = (registerAddress & 0x300) >> 8 | ((data & 0x3f) << 2);
-   uint8_t byte2                    = (startBitNumber << 2) | ((endBitNumber & 0x1) << 7) | ((data & 0xc0) >> 6);
-   uint8_t byte3                    = (opCode << 4) | ((endBitNumber & 0x1e) >> 1);
-
-   CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
-   return (Result){commandBytes, NULL};
-}
-
-// The conditions eq, le and gt of jumpr are not supported by the ULP. The compiler replaces them by modified jumpr commands using lt and ge.
-// For details visit https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-guides/ulp_instruction_set.html#jumpr-jump-to-a-relative-offset-condition-based-on-r0.
-static Result unsupportedJumpRelativeConditionalBasedOnR0(uint8_t *commandAsText){
-   CommandBytes commandBytes = {0, 0, 0, 0};
-   return (Result){commandBytes, UNSUPPORTED_JUMPR_R0_ERROR_MESSAGE};
-}
-
-// The conditions eq and gt of jumps are not supported by the ULP. The compiler replaces them by modified jumpr commands using lt, le and ge.
-// For details visit https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-guides/ulp_instruction_set.html#jumps-jump-to-a-relative-address-condition-based-on-stage-count.
-static Result unsupportedJumpRelativeConditionalBasedOnStageCount(uint8_t *commandAsText){
-   CommandBytes commandBytes = {0, 0, 0, 0};
-   return (Result){commandBytes, UNSUPPORTED_JUMPR_STAGECOUNT_ERROR_MESSAGE};
-}
-
-static Result stageReset(uint8_t *commandAsText){
-   return stageCountOperation(commandAsText);
-}
-
-static Result stageIncrement(uint8_t *commandAsText){
-   return stageCountOperation(commandAsText);
+static Result writeRegister(const Instruction *instruction) {
+   uint32_t word = createWord(FORMAT_REG_WR);
+   word          = setField(word, FIELD_REGISTER_ADDRESS,   instruction->operands[0].value);
+   word          = setField(word, FIELD_REGISTER_END_BIT,   instruction->operands[1].value);
+   word          = setField(word, FIELD_REGISTER_START_BIT, instruction->operands[2].value);
+   word          = setField(word, FIELD_REGISTER_DATA,      instruction->operands[3].value);
+   return command(word);
 }
 
-static Result stageDecrement(uint8_t *commandAsText){
-   return stageCountOperation(commandAsText);
+static Result halt(const Instruction *instruction){
+   (void)instruction;
+   return command(createWord(FORMAT_HALT));
 }
 
-static Result halt(uint8_t *commandAsText){
-   CommandBytes commandBytes = {0x00, 0x00, 0x00, 0xb0};
-   return (Result){commandBytes, NULL};
-}
-
-static Result wake(uint8_t *commandAsText){
-   CommandBytes commandBytes = {0x01, 0x00, 0x00, 0x90};
-   return (Result){commandBytes, NULL};
+static Result wake(const Instruction *instruction){
+   (void)instruction;
+   return command(setField(createWord(FORMAT_WAKE), FIELD_WAKE_SIGNAL, 1));
 }
 
-static Result sleep(uint8_t *commandAsText){
-   strtok((char*)commandAsText, " ");
-   int reg                   = strtol(strtok( NULL, " "), NULL, 0);
-   CommandBytes commandBytes = {reg, 0x00, 0x00, 0x92};
-   return (Result){commandBytes, NULL};
+static Result sleep(const Instruction *instruction){
+   int reg = instruction->operands[0].value;
+   if (reg > MAX_SLEEP_CYCLE_REGISTER) {
+      return error(UNSUPPORTED_COMMAND);
+   }
+   return command(setField(createWord(FORMAT_SLEEP), FIELD_SLEEP_CYCLE_REGISTER, reg));
 }
 
-static Result wait(uint8_t *commandAsText){
-   strtok((char*)commandAsText, " ");
-   int cycles = strtol(strtok( NULL, " "), NULL, 0);
+static Result wait(const Instruction *instruction){
+   int cycles = instruction->operands[0].value;
    return waitCycles(cycles);
 }
 
 static Result waitCycles(int cycles){
-   uint8_t byte0             = cycles & 0xff;
-   uint8_t byte1             = (cycles & 0xff00) >> 8;
-   CommandBytes commandBytes = {byte0, byte1, 0x00, 0x40};
-   return (Result){commandBytes, NULL};
+   return command(setField(createWord(FORMAT_WAIT), FIELD_WAIT_CYCLES, cycles));
 }
 
-static Result tsens(uint8_t *commandAsText){
-   strtok((char*)commandAsText, " ");
-   int reg                   = atoi(strtok( NULL, " ") + 1);
-   int waitCycles            = strtol(strtok( NULL, " "), NULL, 0);
-   uint8_t byte0             = reg | ((waitCycles & 0x3f) << 2);
-   uint8_t byte1             = (waitCycles & 0x3fc0) >> 6;
-   CommandBytes commandBytes = {byte0, byte1, 0x00, 0xa0};
-   return (Result){commandBytes, NULL};
+static Result tsens(const Instruction *instruction){
+   uint32_t word = createWord(FORMAT_TSENS);
+   word          = setField(word, FIELD_TSENS_DESTINATION_REGISTER, instruction->operands[0].value);
+   word          = setField(word, FIELD_TSENS_WAIT_CYCLES,          instruction->operands[1].value);
+   return command(word);
 }
-
-static Result moveImmediateToRegister(uint8_t *commandAsText) {
-   return aluOperationWithImmediateValue(commandAsText);
-}
-
-static Result moveRegisterToRegister(uint8_t *commandAsText) {
-   return aluOperationAmongRegisters(commandAsText);
-}
\ No newline at end of file
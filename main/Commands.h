@@ -1,6 +1,7 @@
 #ifndef assembler_commands_h
 #define assembler_commands_h
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -11,15 +12,64 @@ typedef struct {
    uint8_t byte3;
 } CommandBytes;
 
+#define MAX_COMMANDS_PER_LINE   2
+
 typedef struct {
-   CommandBytes commandBytes;
-   char*        errorMessage;
+   CommandBytes   commandBytes;
+   char*          errorMessage;
+   const uint8_t* label;          // label used as jump target or NULL
+   size_t         labelLength;
+   size_t         additionalCommandCount;                               // number of commands following commandBytes
+   CommandBytes   additionalCommandBytes[MAX_COMMANDS_PER_LINE - 1];
 } Result;
 
 /**
  * In case of a valid command Command.commandBytes contains the corresponding bytes and Command.errorMessage is NULL, 
  * otherwise Command.errorMessage points to an error message.
+ * 
+ * Jump commands (jump, jumpr and jumps) accept a label instead of the target address. In this case Command.label points
+ * to the label (inside line) and the target needs to get set by calling setJumpTarget as soon as the address of the label is known.
+ *
+ * The ULP does not support the conditions eq, le and gt of jumpr and eq and gt of jumps. They get replaced by the
+ * supported conditions like the IDF does, using as few commands as possible (e.g. "jumpr x, 5, le" becomes
+ * "jumpr x, 6, lt"). Only eq might need two commands: the first one skips the second one, which is the jump to the
+ * target (e.g. "jumpr x, 5, eq" becomes "jumpr 8, 6, ge" followed by "jumpr x, 5, ge"). In this case
+ * Command.additionalCommandBytes contains the second command, Command.label belongs to the last command and a
+ * numeric step is relative to the first command.
  */
 Result getCommandBytesFor(const uint8_t *line);
 
+/**
+ * Does the same as getCommandBytesFor but the line does not need to be terminated by 0 -> it can point into a larger buffer.
+ */
+Result getCommandBytesForLine(const uint8_t *line, size_t lineLength);
+
+/**
+ * Returns true if text (not terminated by 0) can be used as label: it starts with a letter, '_' or '.' followed by
+ * letters, digits, '_' and '.'. Register names ("r" followed by digits, e.g. r4 although the ULP has r0 - r3 only) and
+ * condition names (eq, ov, lt, le, ge and gt, ignoring case) are reserved.
+ */
+bool isLabel(const uint8_t *text, size_t length);
+
+/**
+ * Sets the target address (in bytes) of the jump command. Relative jumps (jumpr and jumps) use the address of the command 
+ * itself (commandAddress) to calculate the step. Returns false if the command is not a jump with an immediate target or 
+ * the target is out of range.
+ */
+bool setJumpTarget(CommandBytes *commandBytes, uint32_t commandAddress, uint32_t targetAddress);
+
+/**
+ * Gets the target address (in bytes) of the jump command, the counterpart of setJumpTarget. Returns false if the command
+ * is not a jump with an immediate target or a relative jump points in front of address 0.
+ */
+bool getJumpTargetAddress(const CommandBytes *commandBytes, uint32_t commandAddress, uint32_t *targetAddress);
+
+/**
+ * Turns a relative jump (jumpr or jumps) whose target is out of range (more than 127 words away) into two commands:
+ * commandBytes becomes a relative jump using the inverted condition that skips the next word and absoluteJump receives
+ * the unconditional jump to targetAddress (in bytes) that needs to follow it. Returns false if the command is no relative
+ * jump or the target is out of range of an absolute jump.
+ */
+bool relaxRelativeJump(CommandBytes *commandBytes, uint32_t targetAddress, CommandBytes *absoluteJump);
+
 #endif
\ No newline at end of file
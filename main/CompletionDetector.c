@@ -0,0 +1,29 @@
+#include "CompletionDetector.h"
+
+bool isCompletionMarkerSet(uint32_t word, uint32_t markerAddress) {
+   return markerAddress != 0 && (word & 0xffff) == markerAddress;
+}
+
+CompletionResult waitForCompletion(const CompletionHardware *hardware, const CompletionPolling *polling) {
+   CompletionResult result = {false, 0, 0};
+   uint64_t start          = hardware->getTimeInMicroseconds(hardware->context);
+   uint32_t pollInterval   = polling->minPollIntervalInMicroseconds;
+
+   while (true) {
+      result.pollCount++;
+      result.isCompleted         = hardware->isCompleted(hardware->context);
+      result.elapsedMicroseconds = hardware->getTimeInMicroseconds(hardware->context) - start;
+
+      if (result.isCompleted || result.elapsedMicroseconds >= polling->timeoutInMicroseconds) {
+         return result;
+      }
+
+      uint64_t remainingMicroseconds = polling->timeoutInMicroseconds - result.elapsedMicroseconds;
+      hardware->delay(hardware->context, pollInterval < remainingMicroseconds ? pollInterval : remainingMicroseconds);
+
+      pollInterval = pollInterval * 2;
+      if (pollInterval > polling->maxPollIntervalInMicroseconds || pollInterval == 0) {
+         pollInterval = polling->maxPollIntervalInMicroseconds;
+      }
+   }
+}
@@ -0,0 +1,40 @@
+#ifndef assembler_completion_detector_h
+#define assembler_completion_detector_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Access to the hardware required to detect the end of a ULP program (on the host a stand-in can simulate it).
+typedef struct {
+   void     *context;
+   bool     (*isCompleted)(void *context);                          // true if the ULP program halted
+   uint64_t (*getTimeInMicroseconds)(void *context);                // monotonic time
+   void     (*delay)(void *context, uint32_t microseconds);
+} CompletionHardware;
+
+typedef struct {
+   uint32_t minPollIntervalInMicroseconds;    // interval between the first two polls, it doubles after each poll
+   uint32_t maxPollIntervalInMicroseconds;
+   uint32_t timeoutInMicroseconds;
+} CompletionPolling;
+
+typedef struct {
+   bool     isCompleted;                      // false if the timeout elapsed
+   uint64_t elapsedMicroseconds;
+   uint32_t pollCount;
+} CompletionResult;
+
+/**
+ * Returns true if word (the content of the completion marker at markerAddress in RTC_SLOW_MEM) got written by
+ * "st rX, rX, 0" with rX = markerAddress. The ULP stores the address of the st command in the upper 16 bits -> only the
+ * lower 16 bits get compared. The marker must be 0 before the ULP program starts.
+ */
+bool isCompletionMarkerSet(uint32_t word, uint32_t markerAddress);
+
+/**
+ * Polls hardware->isCompleted till it returns true or the timeout elapsed. Short programs get detected within a few
+ * microseconds while the interval between the polls grows for long running programs.
+ */
+CompletionResult waitForCompletion(const CompletionHardware *hardware, const CompletionPolling *polling);
+
+#endif
@@ -0,0 +1,37 @@
+#include "CycleCount.h"
+#include "InstructionSet.h"
+
+#define ALU_CYCLE_COUNT              6
+#define MEMORY_ACCESS_CYCLE_COUNT    8
+#define JUMP_CYCLE_COUNT             4
+#define HALT_CYCLE_COUNT             2
+#define WAKE_CYCLE_COUNT             6
+#define SLEEP_CYCLE_COUNT            4
+#define WAIT_CYCLE_COUNT             2
+#define REG_RD_CYCLE_COUNT           4
+#define REG_WR_CYCLE_COUNT           8
+#define TSENS_CYCLE_COUNT            2
+
+// 23 + max(1, SAR_AMP_WAIT1) + max(1, SAR_AMP_WAIT2) + max(1, SAR_AMP_WAIT3) + SARx_SAMPLE_CYCLE + SARx_SAMPLE_BIT
+#define ADC_CYCLE_COUNT              (23 + 10 + 10 + 10 + 9 + 3)
+
+// Sending/receiving the address and one byte at the default I2C timing of the RTC I2C controller.
+#define I2C_CYCLE_COUNT              500
+
+uint32_t getCycleCount(uint32_t word) {
+   switch (getField(word, FIELD_OPCODE)) {
+      case  1: return REG_WR_CYCLE_COUNT + FETCH_CYCLE_COUNT;
+      case  2: return REG_RD_CYCLE_COUNT + FETCH_CYCLE_COUNT;
+      case  3: return I2C_CYCLE_COUNT + FETCH_CYCLE_COUNT;
+      case  4: return WAIT_CYCLE_COUNT + getField(word, FIELD_WAIT_CYCLES) + FETCH_CYCLE_COUNT;
+      case  5: return ADC_CYCLE_COUNT + FETCH_CYCLE_COUNT;
+      case  6: return MEMORY_ACCESS_CYCLE_COUNT + FETCH_CYCLE_COUNT;
+      case  7: return ALU_CYCLE_COUNT + FETCH_CYCLE_COUNT;
+      case  8: return JUMP_CYCLE_COUNT + FETCH_CYCLE_COUNT;
+      case  9: return (hasFormat(word, FORMAT_WAKE) ? WAKE_CYCLE_COUNT : SLEEP_CYCLE_COUNT) + FETCH_CYCLE_COUNT;
+      case 10: return TSENS_CYCLE_COUNT + getField(word, FIELD_TSENS_WAIT_CYCLES) + FETCH_CYCLE_COUNT;
+      case 11: return HALT_CYCLE_COUNT;
+      case 13: return MEMORY_ACCESS_CYCLE_COUNT + FETCH_CYCLE_COUNT;
+   }
+   return 0;
+}
@@ -0,0 +1,19 @@
+#ifndef assembler_cycle_count_h
+#define assembler_cycle_count_h
+
+#include <stdint.h>
+
+// Cycles the ULP needs to fetch the next command (not required after halt).
+#define FETCH_CYCLE_COUNT      4
+
+/**
+ * Returns the number of RTC_FAST_CLK cycles the ULP needs to execute the command represented by word (little endian,
+ * byte0 is the least significant byte) and to fetch the next one, according to the ESP32 ULP instruction set
+ * documentation. The duration of adc, i2c_rd and i2c_wr depends on the configuration of the peripherals -> the
+ * returned values are based on their default configuration.
+ *
+ * Returns 0 if the word is not a command.
+ */
+uint32_t getCycleCount(uint32_t word);
+
+#endif
@@ -0,0 +1,65 @@
+#include <stdbool.h>
+
+#include "DirtyRanges.h"
+
+void clearDirtyRanges(DirtyRanges *dirtyRanges) {
+   dirtyRanges->rangeCount = 0;
+}
+
+void markDirty(DirtyRanges *dirtyRanges, size_t firstWord, size_t wordCount) {
+   WordRange *ranges = dirtyRanges->ranges;
+   size_t endWord    = firstWord + wordCount;
+
+   if (wordCount == 0) {
+      return;
+   }
+
+   // skip all ranges ending before the new one (adjacent ranges get merged)
+   size_t index = 0;
+   while (index < dirtyRanges->rangeCount && ranges[index].endWord < firstWord) {
+      index++;
+   }
+
+   size_t end = index;
+   while (end < dirtyRanges->rangeCount && ranges[end].firstWord <= endWord) {
+      firstWord = ranges[end].firstWord < firstWord ? ranges[end].firstWord : firstWord;
+      endWord   = ranges[end].endWord > endWord ? ranges[end].endWord : endWord;
+      end++;
+   }
+
+   if (end == index && dirtyRanges->rangeCount == dirtyRanges->maxRangeCount) {
+      bool hasLeft       = index > 0;
+      bool hasRight      = index < dirtyRanges->rangeCount;
+      size_t leftGap     = hasLeft ? firstWord - ranges[index - 1].endWord : SIZE_MAX;
+      size_t rightGap    = hasRight ? ranges[index].firstWord - endWord : SIZE_MAX;
+      if (leftGap <= rightGap) {
+         markDirty(dirtyRanges, ranges[index - 1].firstWord, endWord - ranges[index - 1].firstWord);
+      } else {
+         markDirty(dirtyRanges, firstWord, ranges[index].endWord - firstWord);
+      }
+      return;
+   }
+
+   // replace the ranges [index, end) by the new one
+   size_t removedCount = end - index;
+   if (removedCount == 0) {
+      for (size_t position = dirtyRanges->rangeCount; position > index; position--) {
+         ranges[position] = ranges[position - 1];
+      }
+      dirtyRanges->rangeCount++;
+   } else {
+      for (size_t position = end; position < dirtyRanges->rangeCount; position++) {
+         ranges[position - removedCount + 1] = ranges[position];
+      }
+      dirtyRanges->rangeCount -= removedCount - 1;
+   }
+   ranges[index] = (WordRange){firstWord, endWord};
+}
+
+size_t getDirtyWordCount(const DirtyRanges *dirtyRanges) {
+   size_t wordCount = 0;
+   for (size_t index = 0; index < dirtyRanges->rangeCount; index++) {
+      wordCount += dirtyRanges->ranges[index].endWord - dirtyRanges->ranges[index].firstWord;
+   }
+   return wordCount;
+}
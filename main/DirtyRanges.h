@@ -0,0 +1,32 @@
+#ifndef assembler_dirty_ranges_h
+#define assembler_dirty_ranges_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The words [firstWord, endWord) got modified.
+typedef struct {
+   uint16_t firstWord;
+   uint16_t endWord;
+} WordRange;
+
+// The caller provides the memory for the ranges. They are sorted, do not overlap and are not adjacent.
+typedef struct {
+   WordRange   *ranges;
+   size_t      maxRangeCount;          // needs to be at least 1
+   size_t      rangeCount;
+} DirtyRanges;
+
+void clearDirtyRanges(DirtyRanges *dirtyRanges);
+
+/**
+ * Marks wordCount words starting at firstWord as modified. Overlapping and adjacent ranges get merged. If there is no
+ * space for an additional range, the new range gets merged with its closest neighbour (the words in between are
+ * considered to be modified too).
+ */
+void markDirty(DirtyRanges *dirtyRanges, size_t firstWord, size_t wordCount);
+
+// Returns the sum of the words in all ranges.
+size_t getDirtyWordCount(const DirtyRanges *dirtyRanges);
+
+#endif
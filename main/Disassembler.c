@@ -0,0 +1,186 @@
+#include <stdio.h>
+
+#include "Disassembler.h"
+#include "InstructionSet.h"
+
+static const char *ALU_OPERATIONS[]        = {[ALU_ADD] = "add", [ALU_SUB] = "sub", [ALU_AND] = "and", [ALU_OR] = "or", [ALU_MOVE] = "move", [ALU_LSH] = "lsh", [ALU_RSH] = "rsh"};
+static const char *STAGE_COUNT_OPERATIONS[] = {[STAGE_INC] = "stage_inc", [STAGE_DEC] = "stage_dec", [STAGE_RST] = "stage_rst"};
+static const char *ABSOLUTE_JUMP_TYPES[]   = {[JUMP_ALWAYS] = NULL, [JUMP_IF_EQ] = "eq", [JUMP_IF_OV] = "ov"};
+static const char *JUMPR_CONDITIONS[]      = {[JUMPR_LT] = "lt", [JUMPR_GE] = "ge"};
+static const char *JUMPS_CONDITIONS[]      = {[JUMPS_LT] = "lt", [JUMPS_GE] = "ge", [JUMPS_LE] = "le"};
+
+// The bit layouts of the commands are defined in InstructionSet.h.
+
+static bool writeRegister(uint32_t word, char *text) {
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "reg_wr %u, %u, %u, %u", getField(word, FIELD_REGISTER_ADDRESS), getField(word, FIELD_REGISTER_END_BIT), getField(word, FIELD_REGISTER_START_BIT), getField(word, FIELD_REGISTER_DATA));
+   return true;
+}
+
+static bool readRegister(uint32_t word, char *text) {
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "reg_rd %u, %u, %u", getField(word, FIELD_REGISTER_ADDRESS), getField(word, FIELD_REGISTER_END_BIT), getField(word, FIELD_REGISTER_START_BIT));
+   return true;
+}
+
+static bool i2cReadWrite(uint32_t word, char *text) {
+   if (getField(word, FIELD_I2C_DIRECTION) == 0) {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "i2c_rd %u, %u, %u, %u", getField(word, FIELD_I2C_SUB_ADDRESS), getField(word, FIELD_I2C_MASK_HIGH), getField(word, FIELD_I2C_MASK_LOW), getField(word, FIELD_I2C_SLAVE_REGISTER));
+   } else {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "i2c_wr %u, %u, %u, %u, %u", getField(word, FIELD_I2C_SUB_ADDRESS), getField(word, FIELD_I2C_DATA), getField(word, FIELD_I2C_MASK_HIGH), getField(word, FIELD_I2C_MASK_LOW), getField(word, FIELD_I2C_SLAVE_REGISTER));
+   }
+   return true;
+}
+
+static bool wait(uint32_t word, char *text) {
+   uint32_t cycles = getField(word, FIELD_WAIT_CYCLES);
+   if (cycles == 0) {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "nop");
+   } else {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "wait %u", cycles);
+   }
+   return true;
+}
+
+static bool adc(uint32_t word, char *text) {
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "adc r%u, %u, %u", getField(word, FIELD_ADC_DESTINATION_REGISTER), getField(word, FIELD_ADC_SAR_SELECT), getField(word, FIELD_ADC_PAD));
+   return true;
+}
+
+static bool storeDataInMemory(uint32_t word, char *text) {
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "st r%u, r%u, %u", getField(word, FIELD_MEMORY_DATA_REGISTER), getField(word, FIELD_MEMORY_ADDRESS_REGISTER), getField(word, FIELD_MEMORY_OFFSET) * 4);
+   return true;
+}
+
+static bool loadDataFromMemory(uint32_t word, char *text) {
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "ld r%u, r%u, %u", getField(word, FIELD_MEMORY_DATA_REGISTER), getField(word, FIELD_MEMORY_ADDRESS_REGISTER), getField(word, FIELD_MEMORY_OFFSET) * 4);
+   return true;
+}
+
+static bool aluOperationAmongRegisters(uint32_t word, char *text) {
+   uint32_t operation = getField(word, FIELD_ALU_OPERATION);
+   if (operation >= sizeof(ALU_OPERATIONS) / sizeof(ALU_OPERATIONS[0])) {
+      return false;
+   }
+   if (operation == ALU_MOVE) {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "move r%u, r%u", getField(word, FIELD_ALU_DESTINATION_REGISTER), getField(word, FIELD_ALU_SOURCE_REGISTER1));
+   } else {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "%s r%u, r%u, r%u", ALU_OPERATIONS[operation], getField(word, FIELD_ALU_DESTINATION_REGISTER), getField(word, FIELD_ALU_SOURCE_REGISTER1), getField(word, FIELD_ALU_SOURCE_REGISTER2));
+   }
+   return true;
+}
+
+static bool aluOperationWithImmediateValue(uint32_t word, char *text) {
+   uint32_t operation = getField(word, FIELD_ALU_OPERATION);
+   if (operation >= sizeof(ALU_OPERATIONS) / sizeof(ALU_OPERATIONS[0])) {
+      return false;
+   }
+   if (operation == ALU_MOVE) {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "move r%u, %u", getField(word, FIELD_ALU_DESTINATION_REGISTER), getField(word, FIELD_ALU_IMMEDIATE));
+   } else {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "%s r%u, r%u, %u", ALU_OPERATIONS[operation], getField(word, FIELD_ALU_DESTINATION_REGISTER), getField(word, FIELD_ALU_SOURCE_REGISTER1), getField(word, FIELD_ALU_IMMEDIATE));
+   }
+   return true;
+}
+
+static bool stageCountOperation(uint32_t word, char *text) {
+   uint32_t operation = getField(word, FIELD_ALU_OPERATION);
+   if (operation >= sizeof(STAGE_COUNT_OPERATIONS) / sizeof(STAGE_COUNT_OPERATIONS[0])) {
+      return false;
+   }
+   if (operation == STAGE_RST) {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "%s", STAGE_COUNT_OPERATIONS[operation]);
+   } else {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "%s %u", STAGE_COUNT_OPERATIONS[operation], getField(word, FIELD_STAGE_COUNT_IMMEDIATE));
+   }
+   return true;
+}
+
+// Returns the step of a relative jump in bytes.
+static int relativeJumpStep(uint32_t word) {
+   int stepInBytes = getField(word, FIELD_RELATIVE_JUMP_STEP) * 4;
+   return getField(word, FIELD_RELATIVE_JUMP_SIGN) ? -stepInBytes : stepInBytes;
+}
+
+static bool jumpToAbsoluteAddress(uint32_t word, char *text) {
+   uint32_t jumpType = getField(word, FIELD_JUMP_TYPE);
+   if (jumpType >= sizeof(ABSOLUTE_JUMP_TYPES) / sizeof(ABSOLUTE_JUMP_TYPES[0])) {
+      return false;
+   }
+   char target[8];
+   if (getField(word, FIELD_JUMP_ADDRESS_IN_REGISTER)) {
+      snprintf(target, sizeof(target), "r%u", getField(word, FIELD_JUMP_REGISTER));
+   } else {
+      snprintf(target, sizeof(target), "%u", getField(word, FIELD_JUMP_ADDRESS) * 4);
+   }
+   if (jumpType == JUMP_ALWAYS) {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "jump %s", target);
+   } else {
+      snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "jump %s, %s", target, ABSOLUTE_JUMP_TYPES[jumpType]);
+   }
+   return true;
+}
+
+static bool jumpConditionalUponR0(uint32_t word, char *text) {
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "jumpr %d, %u, %s", relativeJumpStep(word), getField(word, FIELD_JUMPR_THRESHOLD), JUMPR_CONDITIONS[getField(word, FIELD_JUMPR_CONDITION)]);
+   return true;
+}
+
+static bool jumpConditionalUponStageCount(uint32_t word, char *text) {
+   uint32_t condition = getField(word, FIELD_JUMPS_CONDITION);
+   if (condition >= sizeof(JUMPS_CONDITIONS) / sizeof(JUMPS_CONDITIONS[0])) {
+      return false;
+   }
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "jumps %d, %u, %s", relativeJumpStep(word), getField(word, FIELD_JUMPS_THRESHOLD), JUMPS_CONDITIONS[condition]);
+   return true;
+}
+
+static bool wake(uint32_t word, char *text) {
+   (void)word;
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "wake");
+   return true;
+}
+
+static bool sleep(uint32_t word, char *text) {
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "sleep %u", getField(word, FIELD_SLEEP_CYCLE_REGISTER));
+   return true;
+}
+
+static bool tsens(uint32_t word, char *text) {
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "tsens r%u, %u", getField(word, FIELD_TSENS_DESTINATION_REGISTER), getField(word, FIELD_TSENS_WAIT_CYCLES));
+   return true;
+}
+
+static bool halt(uint32_t word, char *text) {
+   (void)word;
+   snprintf(text, MAX_DISASSEMBLED_COMMAND_LENGTH, "halt");
+   return true;
+}
+
+static bool (*const DISASSEMBLERS[FORMAT_COUNT])(uint32_t word, char *text) = {
+   [FORMAT_REG_WR]         = writeRegister,
+   [FORMAT_REG_RD]         = readRegister,
+   [FORMAT_I2C]            = i2cReadWrite,
+   [FORMAT_WAIT]           = wait,
+   [FORMAT_ADC]            = adc,
+   [FORMAT_ST]             = storeDataInMemory,
+   [FORMAT_ALU_REGISTERS]  = aluOperationAmongRegisters,
+   [FORMAT_ALU_IMMEDIATE]  = aluOperationWithImmediateValue,
+   [FORMAT_STAGE_COUNT]    = stageCountOperation,
+   [FORMAT_JUMP]           = jumpToAbsoluteAddress,
+   [FORMAT_JUMPR]          = jumpConditionalUponR0,
+   [FORMAT_JUMPS]          = jumpConditionalUponStageCount,
+   [FORMAT_WAKE]           = wake,
+   [FORMAT_SLEEP]          = sleep,
+   [FORMAT_TSENS]          = tsens,
+   [FORMAT_HALT]           = halt,
+   [FORMAT_LD]             = loadDataFromMemory,
+};
+
+bool disassemble(uint32_t word, char *text) {
+   int format = getFormat(word);
+
+   if (format == NO_FORMAT || !DISASSEMBLERS[format](word, text)) {
+      text[0] = 0;
+      return false;
+   }
+   return true;
+}
@@ -0,0 +1,20 @@
+#ifndef assembler_disassembler_h
+#define assembler_disassembler_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAX_DISASSEMBLED_COMMAND_LENGTH   40
+
+/**
+ * Writes the command represented by word (little endian, byte0 is the least significant byte) to text in the syntax
+ * accepted by getCommandBytesFor (e.g. "move r1, 5"). Numbers get written as unsigned decimal values, except the steps
+ * of relative jumps. text needs to provide space for at least MAX_DISASSEMBLED_COMMAND_LENGTH characters (including
+ * 0 termination).
+ *
+ * Returns false (and an empty text) if the word is not a ULP command (e.g. a variable).
+ */
+bool disassemble(uint32_t word, char *text);
+
+#endif
@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "EncodeCache.h"
+
+// FNV-1a, 0 marks unused entries -> never returns 0
+static uint32_t hashLine(const uint8_t *line, size_t lineLength) {
+   uint32_t hash = 2166136261u;
+   for (size_t index = 0; index < lineLength; index++) {
+      hash = (hash ^ line[index]) * 16777619u;
+   }
+   return hash == 0 ? 1 : hash;
+}
+
+static bool isSameLine(const CachedCommand *entry, uint32_t hash, const uint8_t *line, size_t lineLength) {
+   return entry->hash == hash && entry->lineLength == lineLength && memcmp(entry->line, line, lineLength) == 0;
+}
+
+static Result toResult(const CachedCommand *entry, const uint8_t *line) {
+   Result result = {
+      .commandBytes           = entry->commandBytes[0],
+      .errorMessage           = entry->errorMessage,
+      .label                  = entry->labelLength > 0 ? line + entry->labelOffset : NULL,
+      .labelLength            = entry->labelLength,
+      .additionalCommandCount = entry->additionalCommandCount,
+   };
+   for (size_t index = 0; index < entry->additionalCommandCount; index++) {
+      result.additionalCommandBytes[index] = entry->commandBytes[index + 1];
+   }
+   return result;
+}
+
+static void store(CachedCommand *entry, uint32_t hash, const uint8_t *line, size_t lineLength, const Result *result) {
+   entry->hash                   = hash;
+   entry->lineLength             = lineLength;
+   entry->labelOffset            = result->label != NULL ? result->label - line : 0;
+   entry->labelLength            = result->label != NULL ? result->labelLength : 0;
+   entry->additionalCommandCount = result->additionalCommandCount;
+   entry->commandBytes[0]        = result->commandBytes;
+   entry->errorMessage           = result->errorMessage;
+   memcpy(entry->line, line, lineLength);
+   for (size_t index = 0; index < result->additionalCommandCount; index++) {
+      entry->commandBytes[index + 1] = result->additionalCommandBytes[index];
+   }
+}
+
+void resetEncodeCache(EncodeCache *cache) {
+   for (size_t index = 0; index < cache->capacity; index++) {
+      cache->entries[index].hash = 0;
+   }
+   cache->hitCount  = 0;
+   cache->missCount = 0;
+}
+
+Result getCachedCommandBytesForLine(EncodeCache *cache, const uint8_t *line, size_t lineLength) {
+   if (lineLength > MAX_CACHED_LINE_LENGTH || cache->capacity == 0) {
+      cache->missCount++;
+      return getCommandBytesForLine(line, lineLength);
+   }
+
+   uint32_t hash          = hashLine(line, lineLength);
+   size_t   mask          = cache->capacity - 1;
+   size_t   homeIndex     = hash & mask;
+   CachedCommand *unused  = NULL;
+   for (size_t probe = 0; probe < MAX_PROBE_COUNT && probe < cache->capacity; probe++) {
+      CachedCommand *entry = &cache->entries[(homeIndex + probe) & mask];
+      if (entry->hash == 0) {
+         unused = entry;
+         break;
+      }
+      if (isSameLine(entry, hash, line, lineLength)) {
+         cache->hitCount++;
+         return toResult(entry, line);
+      }
+   }
+
+   cache->missCount++;
+   Result result = getCommandBytesForLine(line, lineLength);
+   store(unused != NULL ? unused : &cache->entries[homeIndex], hash, line, lineLength, &result);
+   return result;
+}
@@ -0,0 +1,46 @@
+#ifndef assembler_encode_cache_h
+#define assembler_encode_cache_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Commands.h"
+
+#define MAX_CACHED_LINE_LENGTH   32       // longer lines get encoded each time
+#define MAX_PROBE_COUNT          4
+
+// A cached Result of getCommandBytesForLine. The label (if any) is stored as offset into the line.
+typedef struct {
+   uint32_t       hash;                               // 0 for unused entries
+   uint8_t        lineLength;
+   uint8_t        labelOffset;
+   uint8_t        labelLength;
+   uint8_t        additionalCommandCount;
+   uint8_t        line[MAX_CACHED_LINE_LENGTH];
+   CommandBytes   commandBytes[MAX_COMMANDS_PER_LINE];
+   char           *errorMessage;
+} CachedCommand;
+
+/**
+ * The caller provides the memory for the entries (capacity needs to be a power of 2) -> the cache has a fixed size. The
+ * entries are an open-addressed hash table: a line can be stored in the MAX_PROBE_COUNT entries following the entry its
+ * hash selects. If all of them are used, the selected entry gets replaced.
+ */
+typedef struct {
+   CachedCommand  *entries;
+   size_t         capacity;
+   size_t         hitCount;
+   size_t         missCount;         // includes the lines that are too long to get cached
+} EncodeCache;
+
+// Removes all entries and sets the counters to 0.
+void resetEncodeCache(EncodeCache *cache);
+
+/**
+ * Returns the same result as getCommandBytesForLine(line, lineLength). Lines encoded before (byte by byte the same,
+ * e.g. normalized lines pasted again) get taken from the cache instead of getting parsed again. Result.label points
+ * into line as usual.
+ */
+Result getCachedCommandBytesForLine(EncodeCache *cache, const uint8_t *line, size_t lineLength);
+
+#endif
@@ -0,0 +1,210 @@
+#include <stdbool.h>
+
+#include "ExecutionTime.h"
+#include "CycleCount.h"
+#include "InstructionSet.h"
+
+#define UNKNOWN_STAGE_COUNTER    256
+#define NO_STATE                 UINT32_MAX
+#define MAX_SUCCESSOR_COUNT      2
+
+enum { STATE_UNUSED, STATE_NEW, STATE_IN_PROGRESS, STATE_DONE };
+
+typedef struct {
+   size_t   commandIndex;
+   uint32_t stageCounter;
+   size_t   firstCommandIndex;   // command following the one of the state (commandIndex if there are no commands without state in between)
+   uint64_t cycleCount;          // cycles of the commands without state in front of commandIndex
+} Successor;
+
+// Only commands that can have several successors (jumps) or none (halt) get a state. All other commands continue with
+// the next one -> their cycles get added to the successor. Each loop contains a jump -> each loop contains a state.
+static bool needsState(uint32_t word) {
+   UlpFormat format = getFormat(word);
+   return format == FORMAT_JUMP || format == FORMAT_JUMPR || format == FORMAT_JUMPS || format == FORMAT_HALT;
+}
+
+static uint32_t getNextStageCounter(uint32_t word, uint32_t stageCounter) {
+   bool isKnown   = stageCounter != UNKNOWN_STAGE_COUNTER;
+   uint32_t value = getField(word, FIELD_STAGE_COUNT_IMMEDIATE);
+   switch (getField(word, FIELD_ALU_OPERATION)) {
+      case STAGE_INC: return isKnown ? (stageCounter + value) & 0xff : stageCounter;
+      case STAGE_DEC: return isKnown ? (stageCounter - value) & 0xff : stageCounter;
+      case STAGE_RST: return 0;
+   }
+   return stageCounter;
+}
+
+// Moves the successor behind the commands without state that follow it. Returns false if one of them is no command or
+// the last command is no jump or halt (failedCommandIndex contains its index).
+static bool skipCommandsWithoutState(const uint32_t *words, size_t wordCount, Successor *successor, size_t *failedCommandIndex) {
+   while (!needsState(words[successor->commandIndex])) {
+      uint32_t word = words[successor->commandIndex];
+      if (getCycleCount(word) == 0 || successor->commandIndex + 1 >= wordCount) {
+         *failedCommandIndex = successor->commandIndex;
+         return false;
+      }
+      if (getFormat(word) == FORMAT_STAGE_COUNT) {
+         successor->stageCounter = getNextStageCounter(word, successor->stageCounter);
+      }
+      successor->cycleCount += getCycleCount(word);
+      successor->commandIndex++;
+   }
+   return true;
+}
+
+// Returns the number of successors (0 for halt) or -1 if the successors are unknown (status contains the reason and
+// failedCommandIndex the command causing it).
+static int getSuccessors(const uint32_t *words, size_t wordCount, size_t commandIndex, uint32_t stageCounter, Successor *successors, ExecutionTimeStatus *status, size_t *failedCommandIndex) {
+   uint32_t word          = words[commandIndex];
+   int count              = 0;
+   Successor next         = {commandIndex + 1, stageCounter, commandIndex + 1, 0};
+   bool isKnown           = stageCounter != UNKNOWN_STAGE_COUNTER;
+
+   *failedCommandIndex = commandIndex;
+   if (getCycleCount(word) == 0) {
+      *status = EXECUTION_TIME_INVALID_COMMAND;
+      return -1;
+   }
+
+   int32_t step           = getField(word, FIELD_RELATIVE_JUMP_SIGN) ? -(int32_t)getField(word, FIELD_RELATIVE_JUMP_STEP) : (int32_t)getField(word, FIELD_RELATIVE_JUMP_STEP);
+   Successor jump         = {commandIndex + step, stageCounter, commandIndex + step, 0};
+
+   switch (getFormat(word)) {
+      case FORMAT_STAGE_COUNT:
+         next.stageCounter   = getNextStageCounter(word, stageCounter);
+         successors[count++] = next;
+         break;
+      case FORMAT_JUMP:
+         if (getField(word, FIELD_JUMP_ADDRESS_IN_REGISTER)) {
+            *status = EXECUTION_TIME_INDIRECT_JUMP;
+            return -1;
+         }
+         jump.commandIndex      = getField(word, FIELD_JUMP_ADDRESS);
+         jump.firstCommandIndex = jump.commandIndex;
+         successors[count++]    = jump;
+         if (getField(word, FIELD_JUMP_TYPE) != JUMP_ALWAYS) {
+            successors[count++] = next;
+         }
+         break;
+      case FORMAT_JUMPR:
+         successors[count++] = jump;
+         successors[count++] = next;
+         break;
+      case FORMAT_JUMPS: {
+         uint32_t threshold = getField(word, FIELD_JUMPS_THRESHOLD);
+         bool isTaken       = false;
+         switch (getField(word, FIELD_JUMPS_CONDITION)) {
+            case JUMPS_LT: isTaken = stageCounter < threshold;  break;
+            case JUMPS_GE: isTaken = stageCounter >= threshold; break;
+            case JUMPS_LE: isTaken = stageCounter <= threshold; break;
+         }
+         if (!isKnown || isTaken) {
+            successors[count++] = jump;
+         }
+         if (!isKnown || !isTaken) {
+            successors[count++] = next;
+         }
+         break;
+      }
+      case FORMAT_HALT:
+         break;
+      default:
+         successors[count++] = next;
+   }
+
+   for (int index = 0; index < count; index++) {
+      if (successors[index].commandIndex >= wordCount) {
+         *status = EXECUTION_TIME_INVALID_COMMAND;
+         return -1;
+      }
+      if (!skipCommandsWithoutState(words, wordCount, &successors[index], failedCommandIndex)) {
+         *status = EXECUTION_TIME_INVALID_COMMAND;
+         return -1;
+      }
+   }
+   return count;
+}
+
+// Returns the index of the state in the hash table (inserts it if necessary) or NO_STATE if the table is full.
+static uint32_t findOrInsertState(ExecutionState *states, size_t stateCapacity, size_t commandIndex, uint32_t stageCounter) {
+   size_t mask  = stateCapacity - 1;
+   size_t index = ((commandIndex * (UNKNOWN_STAGE_COUNTER + 1) + stageCounter) * 2654435761u) & mask;
+
+   for (size_t probe = 0; probe < stateCapacity; probe++, index = (index + 1) & mask) {
+      ExecutionState *state = &states[index];
+      if (state->status == STATE_UNUSED) {
+         *state = (ExecutionState){commandIndex, stageCounter, STATE_NEW, 0, NO_STATE, 0, 0};
+         return index;
+      }
+      if (state->commandIndex == commandIndex && state->stageCounter == stageCounter) {
+         return index;
+      }
+   }
+   return NO_STATE;
+}
+
+static ExecutionTime failure(ExecutionTimeStatus status, size_t commandIndex) {
+   return (ExecutionTime){status, commandIndex, 0, 0};
+}
+
+// Depth first search without recursion (the parent of each state gets stored in the state) -> the cycles till the end
+// of the program are known for all successors when a state gets finished.
+ExecutionTime analyzeExecutionTime(const uint32_t *words, size_t wordCount, size_t entryPoint, ExecutionState *states, size_t stateCapacity) {
+   Successor successors[MAX_SUCCESSOR_COUNT];
+   ExecutionTimeStatus status = EXECUTION_TIME_BOUNDED;
+   size_t failedCommandIndex  = entryPoint;
+
+   if (entryPoint >= wordCount) {
+      return failure(EXECUTION_TIME_INVALID_COMMAND, entryPoint);
+   }
+   for (size_t index = 0; index < stateCapacity; index++) {
+      states[index].status = STATE_UNUSED;
+   }
+
+   uint32_t current = findOrInsertState(states, stateCapacity, entryPoint, UNKNOWN_STAGE_COUNTER);
+   uint32_t root    = current;
+   states[root].status = STATE_IN_PROGRESS;
+
+   while (current != NO_STATE) {
+      ExecutionState *state = &states[current];
+      int successorCount    = getSuccessors(words, wordCount, state->commandIndex, state->stageCounter, successors, &status, &failedCommandIndex);
+      if (successorCount < 0) {
+         return failure(status, failedCommandIndex);
+      }
+
+      if (state->nextSuccessor < successorCount) {
+         Successor *successor = &successors[state->nextSuccessor++];
+         uint32_t index       = findOrInsertState(states, stateCapacity, successor->commandIndex, successor->stageCounter);
+         if (index == NO_STATE) {
+            return failure(EXECUTION_TIME_TOO_COMPLEX, successor->firstCommandIndex);
+         }
+         if (states[index].status == STATE_IN_PROGRESS) {
+            return failure(EXECUTION_TIME_UNBOUNDED_LOOP, successor->firstCommandIndex);
+         }
+         if (states[index].status == STATE_NEW) {
+            states[index].status = STATE_IN_PROGRESS;
+            states[index].parent = current;
+            current              = index;
+         }
+         continue;
+      }
+
+      uint64_t cycleCount = getCycleCount(words[state->commandIndex]);
+      uint64_t bestCase   = successorCount == 0 ? 0 : UINT64_MAX;
+      uint64_t worstCase  = 0;
+      for (int index = 0; index < successorCount; index++) {
+         ExecutionState *successor = &states[findOrInsertState(states, stateCapacity, successors[index].commandIndex, successors[index].stageCounter)];
+         uint64_t successorBestCase  = successors[index].cycleCount + successor->bestCaseCycleCount;
+         uint64_t successorWorstCase = successors[index].cycleCount + successor->worstCaseCycleCount;
+         bestCase  = successorBestCase < bestCase ? successorBestCase : bestCase;
+         worstCase = successorWorstCase > worstCase ? successorWorstCase : worstCase;
+      }
+      state->bestCaseCycleCount  = cycleCount + bestCase;
+      state->worstCaseCycleCount = cycleCount + worstCase;
+      state->status              = STATE_DONE;
+      current                    = state->parent;
+   }
+
+   return (ExecutionTime){EXECUTION_TIME_BOUNDED, 0, states[root].bestCaseCycleCount, states[root].worstCaseCycleCount};
+}
@@ -0,0 +1,46 @@
+#ifndef assembler_execution_time_h
+#define assembler_execution_time_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+   EXECUTION_TIME_BOUNDED,
+   EXECUTION_TIME_UNBOUNDED_LOOP,      // the program contains a loop that does not depend on the stage counter
+   EXECUTION_TIME_INDIRECT_JUMP,       // the target of "jump <register>" is unknown
+   EXECUTION_TIME_INVALID_COMMAND,     // the program executes a word that is not a command or runs past its end
+   EXECUTION_TIME_TOO_COMPLEX          // the program has more states than the provided state table can hold
+} ExecutionTimeStatus;
+
+typedef struct {
+   ExecutionTimeStatus status;
+   size_t              commandIndex;          // command that caused the status (if it is not EXECUTION_TIME_BOUNDED)
+   uint64_t            bestCaseCycleCount;    // only valid if the status is EXECUTION_TIME_BOUNDED
+   uint64_t            worstCaseCycleCount;   // only valid if the status is EXECUTION_TIME_BOUNDED
+} ExecutionTime;
+
+// A command together with the value of the stage counter when executing it.
+typedef struct {
+   uint16_t commandIndex;
+   uint16_t stageCounter;
+   uint8_t  status;
+   uint8_t  nextSuccessor;
+   uint32_t parent;
+   uint64_t bestCaseCycleCount;
+   uint64_t worstCaseCycleCount;
+} ExecutionState;
+
+/**
+ * Calculates the best and worst case number of cycles (see getCycleCount) the program needs when starting at entryPoint
+ * till it halts. The analysis follows all possible paths of the control flow graph. Conditional jumps depending on r0 or
+ * the ALU flags can go both ways. The stage counter gets tracked exactly after the first stage_rst -> loops using
+ * stage_inc/stage_dec and jumps are bounded. All other loops result in EXECUTION_TIME_UNBOUNDED_LOOP. Modifications
+ * of the program by st commands do not get considered.
+ *
+ * states is a hash table (stateCapacity needs to be a power of 2) used for the analysis. Each jump and halt needs one
+ * state per value of the stage counter it gets executed with, the cycles of all other commands get added to the state
+ * of the following jump or halt (e.g. a loop of 255 iterations ending with jumps needs about 256 states).
+ */
+ExecutionTime analyzeExecutionTime(const uint32_t *words, size_t wordCount, size_t entryPoint, ExecutionState *states, size_t stateCapacity);
+
+#endif
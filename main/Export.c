@@ -0,0 +1,111 @@
+#include <string.h>
+
+#include "Export.h"
+#include "FrameCodec.h"
+
+#define INTEL_HEX_DATA_RECORD          0x00
+#define INTEL_HEX_END_OF_FILE_RECORD   ":00000001FF\n"
+
+static const char UPPER_CASE_HEX_DIGITS[] = "0123456789ABCDEF";
+static const char BASE64_DIGITS[]        = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+bool parseExportFormat(const char *name, ExportFormat *format) {
+   if (strcmp(name, "bin") == 0) {
+      *format = EXPORT_BINARY;
+   } else if (strcmp(name, "hex") == 0) {
+      *format = EXPORT_INTEL_HEX;
+   } else if (strcmp(name, "c") == 0) {
+      *format = EXPORT_C_ARRAY;
+   } else {
+      return false;
+   }
+   return true;
+}
+
+// Intel HEX expects upper case digits.
+static void appendUpperCaseHexByte(OutputBuffer *output, uint8_t value) {
+   uint8_t digits[] = {UPPER_CASE_HEX_DIGITS[value >> 4], UPPER_CASE_HEX_DIGITS[value & 0x0f]};
+   appendBytes(output, digits, sizeof(digits));
+}
+
+// Each record contains up to INTEL_HEX_BYTES_PER_RECORD bytes and the two's complement of the sum of its bytes.
+static void exportIntelHex(OutputBuffer *output, const uint8_t *image, size_t imageSize) {
+   for (size_t address = 0; address < imageSize; address += INTEL_HEX_BYTES_PER_RECORD) {
+      size_t count = imageSize - address < INTEL_HEX_BYTES_PER_RECORD ? imageSize - address : INTEL_HEX_BYTES_PER_RECORD;
+      uint8_t header[] = {count, (address >> 8) & 0xff, address & 0xff, INTEL_HEX_DATA_RECORD};
+      uint8_t sum      = 0;
+
+      appendText(output, ":");
+      for (size_t index = 0; index < sizeof(header); index++) {
+         appendUpperCaseHexByte(output, header[index]);
+         sum += header[index];
+      }
+      for (size_t index = 0; index < count; index++) {
+         appendUpperCaseHexByte(output, image[address + index]);
+         sum += image[address + index];
+      }
+      appendUpperCaseHexByte(output, -sum);
+      appendText(output, "\n");
+   }
+   appendText(output, INTEL_HEX_END_OF_FILE_RECORD);
+}
+
+// The console uses XON/XOFF and translates line ends -> the raw bytes get sent as Base64 text (RFC 4648, lines of
+// BASE64_BYTES_PER_LINE bytes) behind a line containing their count, "base64 -d" turns these lines into the .bin file.
+static void exportBase64(OutputBuffer *output, const uint8_t *image, size_t imageSize) {
+   appendText(output, "Base64 of ");
+   appendDecimal(output, imageSize, 0);
+   appendText(output, " bytes:\n");
+   for (size_t index = 0; index < imageSize; index += 3) {
+      size_t   count    = imageSize - index < 3 ? imageSize - index : 3;
+      uint32_t group    = ((uint32_t)image[index] << 16) | (count > 1 ? image[index + 1] << 8 : 0) | (count > 2 ? image[index + 2] : 0);
+      uint8_t  digits[] = {BASE64_DIGITS[(group >> 18) & 0x3f], BASE64_DIGITS[(group >> 12) & 0x3f],
+                           count > 1 ? BASE64_DIGITS[(group >> 6) & 0x3f] : '=', count > 2 ? BASE64_DIGITS[group & 0x3f] : '='};
+      appendBytes(output, digits, sizeof(digits));
+      if ((index + 3) % BASE64_BYTES_PER_LINE == 0 || index + 3 >= imageSize) {
+         appendText(output, "\n");
+      }
+   }
+}
+
+static void exportCArray(OutputBuffer *output, const uint8_t *image, size_t imageSize) {
+   appendText(output, "// load it with ulp_load_binary(0, ulp_program, sizeof(ulp_program) / sizeof(uint32_t))\n");
+   appendText(output, "const uint8_t ulp_program[");
+   appendDecimal(output, imageSize, 0);
+   appendText(output, "] __attribute__((aligned(4))) = {\n");
+   for (size_t index = 0; index < imageSize; index++) {
+      appendText(output, (index % C_ARRAY_BYTES_PER_LINE == 0) ? "   0x" : " 0x");
+      appendHexByte(output, image[index]);
+      if (index + 1 < imageSize) {
+         appendText(output, ",");
+      }
+      if ((index + 1) % C_ARRAY_BYTES_PER_LINE == 0 || index + 1 == imageSize) {
+         appendText(output, "\n");
+      }
+   }
+   appendText(output, "};\n");
+}
+
+uint32_t exportImage(OutputBuffer *output, const uint8_t *image, size_t imageSize, ExportFormat format) {
+   uint32_t crc = calculateCrc32(0, image, imageSize);
+
+   switch (format) {
+      case EXPORT_BINARY:
+         exportBase64(output, image, imageSize);
+         break;
+      case EXPORT_INTEL_HEX:
+         exportIntelHex(output, image, imageSize);
+         break;
+      case EXPORT_C_ARRAY:
+         exportCArray(output, image, imageSize);
+         break;
+   }
+
+   appendText(output, format == EXPORT_C_ARRAY ? "// CRC-32: 0x" : "CRC-32: 0x");
+   for (int shift = 24; shift >= 0; shift -= 8) {
+      appendHexByte(output, crc >> shift);
+   }
+   appendText(output, "\n");
+   flushOutput(output);
+   return crc;
+}
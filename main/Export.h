@@ -0,0 +1,29 @@
+#ifndef assembler_export_h
+#define assembler_export_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OutputBuffer.h"
+
+#define INTEL_HEX_BYTES_PER_RECORD  16
+#define C_ARRAY_BYTES_PER_LINE      12
+#define BASE64_BYTES_PER_LINE       57    // 76 characters like MIME
+
+typedef enum {
+   EXPORT_BINARY,       // bytes as expected by ulp_load_binary, sent as Base64 text
+   EXPORT_INTEL_HEX,
+   EXPORT_C_ARRAY       // const uint8_t[] initializer that firmware can embed
+} ExportFormat;
+
+// Returns false if name is none of "bin", "hex" and "c".
+bool parseExportFormat(const char *name, ExportFormat *format);
+
+/**
+ * Streams image (a ULP binary consisting of the header and the text) in format to output and appends a line containing
+ * the CRC-32 of the image ("CRC-32: 0x..."). Returns the CRC-32.
+ */
+uint32_t exportImage(OutputBuffer *output, const uint8_t *image, size_t imageSize, ExportFormat format);
+
+#endif
@@ -0,0 +1,66 @@
+#include "FrameCodec.h"
+
+#define MAX_COBS_CODE   0xff
+
+// CRC-32 (reflected polynomial 0xedb88320) of each nibble -> small enough for the ESP32 and fast enough for uploads.
+static const uint32_t CRC32_NIBBLE_TABLE[16] = {
+   0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+   0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+uint32_t calculateCrc32(uint32_t crc, const uint8_t *bytes, size_t byteCount) {
+   crc = ~crc;
+   for (size_t index = 0; index < byteCount; index++) {
+      crc ^= bytes[index];
+      crc  = (crc >> 4) ^ CRC32_NIBBLE_TABLE[crc & 0x0f];
+      crc  = (crc >> 4) ^ CRC32_NIBBLE_TABLE[crc & 0x0f];
+   }
+   return ~crc;
+}
+
+size_t encodeCobs(const uint8_t *input, size_t length, uint8_t *output) {
+   size_t codePosition   = 0;
+   size_t outputPosition = 1;
+   uint8_t code          = 1;
+
+   for (size_t index = 0; index < length; index++) {
+      if (input[index] == 0) {
+         output[codePosition] = code;
+         codePosition         = outputPosition++;
+         code                 = 1;
+      } else {
+         output[outputPosition++] = input[index];
+         code++;
+         if (code == MAX_COBS_CODE) {
+            output[codePosition] = code;
+            codePosition         = outputPosition++;
+            code                 = 1;
+         }
+      }
+   }
+   output[codePosition] = code;
+   return outputPosition;
+}
+
+size_t decodeCobs(const uint8_t *input, size_t length, uint8_t *output) {
+   size_t inputPosition  = 0;
+   size_t outputPosition = 0;
+
+   while (inputPosition < length) {
+      uint8_t code = input[inputPosition++];
+      if (code == 0 || inputPosition + code - 1 > length) {
+         return INVALID_FRAME;
+      }
+      for (uint8_t index = 1; index < code; index++) {
+         uint8_t byte = input[inputPosition++];
+         if (byte == 0) {
+            return INVALID_FRAME;
+         }
+         output[outputPosition++] = byte;
+      }
+      if (code < MAX_COBS_CODE && inputPosition < length) {
+         output[outputPosition++] = 0;
+      }
+   }
+   return outputPosition;
+}
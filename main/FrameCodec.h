@@ -0,0 +1,27 @@
+#ifndef assembler_frame_codec_h
+#define assembler_frame_codec_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define INVALID_FRAME              SIZE_MAX
+
+// Maximum length of the COBS encoding of length bytes (without the terminating 0x00).
+#define MAX_COBS_ENCODED_LENGTH(length)   ((length) + (length) / 254 + 1)
+
+/**
+ * Calculates the CRC-32 (IEEE 802.3, the same as zlib) of bytes. Pass 0 as crc for the first block and the result of
+ * the previous call for the following ones.
+ */
+uint32_t calculateCrc32(uint32_t crc, const uint8_t *bytes, size_t byteCount);
+
+/**
+ * Encodes length bytes with Consistent Overhead Byte Stuffing -> the output does not contain 0x00 and a 0x00 can
+ * terminate the frame. Returns the number of bytes written to output (at most MAX_COBS_ENCODED_LENGTH(length)).
+ */
+size_t encodeCobs(const uint8_t *input, size_t length, uint8_t *output);
+
+// Decodes a COBS frame (without the terminating 0x00). Returns the decoded length or INVALID_FRAME.
+size_t decodeCobs(const uint8_t *input, size_t length, uint8_t *output);
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef assembler_instruction_set_h
+#define assembler_instruction_set_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bit layouts of the ULP commands (see technical reference manual "29.4 ULP Coprocessor Instruction Set"). The encoder
+// (Commands.c) with its range checks and the decoders (disassembler, optimizer, execution time analysis) use these
+// tables only -> a layout gets changed in one place.
+//
+// byte3      byte2      byte1      byte0
+// ------------------------------------------
+// 1098 7654  3210 9876  5432 1098  7654 3210   position
+// oooo sss.  ....  ....  ....  ....  ....      o = OPCODE, s = SUB_OPCODE (if the format has one)
+
+#define NO_SUB_OPCODE   -1
+#define NO_FORMAT       -1
+
+// X(format, opCode, subOpCode)
+#define ULP_FORMATS(X) \
+   X(FORMAT_REG_WR,           1, NO_SUB_OPCODE) \
+   X(FORMAT_REG_RD,           2, NO_SUB_OPCODE) \
+   X(FORMAT_I2C,              3, NO_SUB_OPCODE) \
+   X(FORMAT_WAIT,             4, NO_SUB_OPCODE) \
+   X(FORMAT_ADC,              5, NO_SUB_OPCODE) \
+   X(FORMAT_ST,               6, 4)             \
+   X(FORMAT_ALU_REGISTERS,    7, 0)             \
+   X(FORMAT_ALU_IMMEDIATE,    7, 1)             \
+   X(FORMAT_STAGE_COUNT,      7, 2)             \
+   X(FORMAT_JUMP,             8, 0)             \
+   X(FORMAT_JUMPR,            8, 1)             \
+   X(FORMAT_JUMPS,            8, 2)             \
+   X(FORMAT_WAKE,             9, 0)             \
+   X(FORMAT_SLEEP,            9, 1)             \
+   X(FORMAT_TSENS,           10, NO_SUB_OPCODE) \
+   X(FORMAT_HALT,            11, NO_SUB_OPCODE) \
+   X(FORMAT_LD,              13, NO_SUB_OPCODE)
+
+// X(field, firstBit, bitCount, isSigned) - signed fields accept -2^(bitCount-1) .. 2^bitCount - 1 (two's complement)
+#define ULP_FIELDS(X) \
+   X(FIELD_OPCODE,                     28,  4, false) \
+   X(FIELD_SUB_OPCODE,                 25,  3, false) \
+   /* FORMAT_ALU_REGISTERS, FORMAT_ALU_IMMEDIATE and FORMAT_STAGE_COUNT */ \
+   X(FIELD_ALU_DESTINATION_REGISTER,    0,  2, false) \
+   X(FIELD_ALU_SOURCE_REGISTER1,        2,  2, false) \
+   X(FIELD_ALU_SOURCE_REGISTER2,        4,  2, false) \
+   X(FIELD_ALU_IMMEDIATE,               4, 16, true)  \
+   X(FIELD_STAGE_COUNT_IMMEDIATE,       4,  8, false) \
+   X(FIELD_ALU_OPERATION,              21,  4, false) \
+   /* FORMAT_ST and FORMAT_LD, the offset is in 32-bit words */ \
+   X(FIELD_MEMORY_DATA_REGISTER,        0,  2, false) \
+   X(FIELD_MEMORY_ADDRESS_REGISTER,     2,  2, false) \
+   X(FIELD_MEMORY_OFFSET,              10, 11, false) \
+   /* FORMAT_JUMP, the address is in 32-bit words */ \
+   X(FIELD_JUMP_REGISTER,               0,  2, false) \
+   X(FIELD_JUMP_ADDRESS,                2, 11, false) \
+   X(FIELD_JUMP_ADDRESS_IN_REGISTER,   21,  1, false) \
+   X(FIELD_JUMP_TYPE,                  22,  3, false) \
+   /* FORMAT_JUMPR and FORMAT_JUMPS, the step is in 32-bit words (sign 1 -> PC - step) */ \
+   X(FIELD_JUMPR_THRESHOLD,             0, 16, false) \
+   X(FIELD_JUMPS_THRESHOLD,             0,  8, false) \
+   X(FIELD_JUMPS_CONDITION,            15,  2, false) \
+   X(FIELD_JUMPR_CONDITION,            16,  1, false) \
+   X(FIELD_RELATIVE_JUMP_STEP,         17,  7, false) \
+   X(FIELD_RELATIVE_JUMP_SIGN,         24,  1, false) \
+   /* FORMAT_ADC */ \
+   X(FIELD_ADC_DESTINATION_REGISTER,    0,  2, false) \
+   X(FIELD_ADC_PAD,                     2,  4, false) \
+   X(FIELD_ADC_SAR_SELECT,              6,  1, false) \
+   /* FORMAT_I2C */ \
+   X(FIELD_I2C_SUB_ADDRESS,             0,  8, false) \
+   X(FIELD_I2C_DATA,                    8,  8, false) \
+   X(FIELD_I2C_MASK_LOW,               16,  3, false) \
+   X(FIELD_I2C_MASK_HIGH,              19,  3, false) \
+   X(FIELD_I2C_SLAVE_REGISTER,         22,  4, false) \
+   X(FIELD_I2C_DIRECTION,              27,  1, false) \
+   /* FORMAT_REG_RD and FORMAT_REG_WR */ \
+   X(FIELD_REGISTER_ADDRESS,            0, 10, false) \
+   X(FIELD_REGISTER_DATA,              10,  8, false) \
+   X(FIELD_REGISTER_START_BIT,         18,  5, false) \
+   X(FIELD_REGISTER_END_BIT,           23,  5, false) \
+   /* FORMAT_WAIT, FORMAT_WAKE, FORMAT_SLEEP and FORMAT_TSENS */ \
+   X(FIELD_WAIT_CYCLES,                 0, 16, false) \
+   X(FIELD_WAKE_SIGNAL,                 0,  1, false) \
+   X(FIELD_SLEEP_CYCLE_REGISTER,        0,  4, false) \
+   X(FIELD_TSENS_DESTINATION_REGISTER,  0,  2, false) \
+   X(FIELD_TSENS_WAIT_CYCLES,           2, 14, false)
+
+// values of FIELD_ALU_OPERATION
+enum { ALU_ADD, ALU_SUB, ALU_AND, ALU_OR, ALU_MOVE, ALU_LSH, ALU_RSH, ALU_OPERATION_COUNT };
+enum { STAGE_INC, STAGE_DEC, STAGE_RST, STAGE_OPERATION_COUNT };
+
+// values of FIELD_JUMP_TYPE, FIELD_JUMPR_CONDITION and FIELD_JUMPS_CONDITION (NO_ENCODING: the ULP does not support it)
+#define NO_ENCODING  -1
+enum { JUMP_ALWAYS, JUMP_IF_EQ, JUMP_IF_OV, JUMP_TYPE_COUNT };
+enum { JUMPR_LT, JUMPR_GE };
+enum { JUMPS_LT, JUMPS_GE, JUMPS_LE, JUMPS_CONDITION_COUNT };
+
+typedef enum {
+#define ULP_FORMAT_ENUM(format, opCode, subOpCode)   format,
+   ULP_FORMATS(ULP_FORMAT_ENUM)
+#undef ULP_FORMAT_ENUM
+   FORMAT_COUNT
+} UlpFormat;
+
+typedef enum {
+#define ULP_FIELD_ENUM(field, firstBit, bitCount, isSigned)   field,
+   ULP_FIELDS(ULP_FIELD_ENUM)
+#undef ULP_FIELD_ENUM
+   FIELD_COUNT
+} UlpField;
+
+typedef struct {
+   uint8_t  opCode;
+   int8_t   subOpCode;
+} FormatLayout;
+
+typedef struct {
+   uint8_t  firstBit;
+   uint8_t  bitCount;
+   bool     isSigned;
+} FieldLayout;
+
+static const FormatLayout FORMAT_LAYOUTS[FORMAT_COUNT] = {
+#define ULP_FORMAT_LAYOUT(format, opCode, subOpCode)   [format] = {opCode, subOpCode},
+   ULP_FORMATS(ULP_FORMAT_LAYOUT)
+#undef ULP_FORMAT_LAYOUT
+};
+
+// FORMATS_BY_OPCODE[opCode][subOpCode] contains format + 1 (0 -> no format). Formats without sub-opcode use the entry
+// of sub-opcode 0 -> the sub-opcodes of each opcode need to be unique.
+#define OPCODE_COUNT                    16
+#define SUB_OPCODE_COUNT                8
+#define SUB_OPCODE_INDEX(subOpCode)     ((subOpCode) == NO_SUB_OPCODE ? 0 : (subOpCode))
+
+static const uint8_t FORMATS_BY_OPCODE[OPCODE_COUNT][SUB_OPCODE_COUNT] = {
+#define ULP_FORMAT_BY_OPCODE(format, opCode, subOpCode)   [opCode][SUB_OPCODE_INDEX(subOpCode)] = format + 1,
+   ULP_FORMATS(ULP_FORMAT_BY_OPCODE)
+#undef ULP_FORMAT_BY_OPCODE
+};
+
+static const FieldLayout FIELD_LAYOUTS[FIELD_COUNT] = {
+#define ULP_FIELD_LAYOUT(field, firstBit, bitCount, isSigned)   [field] = {firstBit, bitCount, isSigned},
+   ULP_FIELDS(ULP_FIELD_LAYOUT)
+#undef ULP_FIELD_LAYOUT
+};
+
+// The layouts are constants -> the compiler turns the following functions into single shift and mask operations.
+
+static inline uint32_t getFieldMask(UlpField field) {
+   return (1u << FIELD_LAYOUTS[field].bitCount) - 1;
+}
+
+static inline uint32_t getField(uint32_t word, UlpField field) {
+   return (word >> FIELD_LAYOUTS[field].firstBit) & getFieldMask(field);
+}
+
+// Writes the bits of value that fit into the field (the IDF truncates values out of range the same way).
+static inline uint32_t setField(uint32_t word, UlpField field, int32_t value) {
+   uint32_t mask = getFieldMask(field) << FIELD_LAYOUTS[field].firstBit;
+   return (word & ~mask) | (((uint32_t)value << FIELD_LAYOUTS[field].firstBit) & mask);
+}
+
+static inline int32_t getFieldMinimum(UlpField field) {
+   return FIELD_LAYOUTS[field].isSigned ? -(int32_t)(getFieldMask(field) >> 1) - 1 : 0;
+}
+
+static inline int32_t getFieldMaximum(UlpField field) {
+   return (int32_t)getFieldMask(field);
+}
+
+static inline bool isInFieldRange(UlpField field, int32_t value) {
+   return value >= getFieldMinimum(field) && value <= getFieldMaximum(field);
+}
+
+// Returns the word containing the opcode and the sub-opcode of the format, all other fields are 0.
+static inline uint32_t createWord(UlpFormat format) {
+   uint32_t word = setField(0, FIELD_OPCODE, FORMAT_LAYOUTS[format].opCode);
+   return FORMAT_LAYOUTS[format].subOpCode == NO_SUB_OPCODE ? word : setField(word, FIELD_SUB_OPCODE, FORMAT_LAYOUTS[format].subOpCode);
+}
+
+static inline bool hasFormat(uint32_t word, UlpFormat format) {
+   return getField(word, FIELD_OPCODE) == FORMAT_LAYOUTS[format].opCode &&
+          (FORMAT_LAYOUTS[format].subOpCode == NO_SUB_OPCODE || (int32_t)getField(word, FIELD_SUB_OPCODE) == FORMAT_LAYOUTS[format].subOpCode);
+}
+
+// Returns the format of the command or NO_FORMAT if the word is not a ULP command (e.g. a variable).
+static inline int getFormat(uint32_t word) {
+   const uint8_t *formats = FORMATS_BY_OPCODE[getField(word, FIELD_OPCODE)];
+   int format             = formats[getField(word, FIELD_SUB_OPCODE)] - 1;
+   if (format == NO_FORMAT && formats[0] != 0 && FORMAT_LAYOUTS[formats[0] - 1].subOpCode == NO_SUB_OPCODE) {
+      // the bits of the sub-opcode belong to the fields of this format
+      format = formats[0] - 1;
+   }
+   return format;
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include <string.h>
+
+#include "LineReader.h"
+
+#define CR                 0x0d
+#define LF                 0x0a
+#define SCAN_BLOCK_SIZE    16
+
+void initializeLineReader(LineReader *reader, const ByteStream *stream, uint8_t *ringBuffer, size_t ringCapacity, uint8_t *line, size_t maxLineLength) {
+   *reader = (LineReader){
+      .stream        = stream,
+      .ringBuffer    = ringBuffer,
+      .ringCapacity  = ringCapacity,
+      .line          = line,
+      .maxLineLength = maxLineLength
+   };
+}
+
+static void sendFlowControl(LineReader *reader, uint8_t character) {
+   reader->stream->write(reader->stream->context, &character, 1);
+   reader->isPaused = character == XOFF;
+}
+
+size_t receiveBytes(LineReader *reader, uint32_t timeoutInMilliseconds) {
+   size_t head       = reader->head;
+   size_t tail       = __atomic_load_n(&reader->tail, __ATOMIC_ACQUIRE);
+   size_t usedSpace  = head - tail;
+   size_t offset     = head & (reader->ringCapacity - 1);
+   size_t byteCount  = 0;
+
+   // resume before waiting for new bytes because the peer does not send anything while it is paused
+   if (reader->isPaused && usedSpace <= reader->ringCapacity / 4) {
+      sendFlowControl(reader, XON);
+   }
+
+   if (usedSpace < reader->ringCapacity) {
+      size_t freeSpace           = reader->ringCapacity - usedSpace;
+      size_t contiguousFreeSpace = reader->ringCapacity - offset;
+      byteCount = reader->stream->read(reader->stream->context, reader->ringBuffer + offset, contiguousFreeSpace < freeSpace ? contiguousFreeSpace : freeSpace, timeoutInMilliseconds);
+      __atomic_store_n(&reader->head, head + byteCount, __ATOMIC_RELEASE);
+   }
+
+   if (!reader->isPaused && usedSpace + byteCount >= reader->ringCapacity / 4 * 3) {
+      sendFlowControl(reader, XOFF);
+   }
+   return byteCount;
+}
+
+// Returns the position of the first CR or LF (count if there is none). Blocks without line ends get skipped without a
+// branch per byte -> the compiler can vectorize the inner loop.
+static size_t findLineEnd(const uint8_t *bytes, size_t count) {
+   size_t position = 0;
+
+   while (position + SCAN_BLOCK_SIZE <= count) {
+      uint8_t found = 0;
+      for (size_t index = 0; index < SCAN_BLOCK_SIZE; index++) {
+         uint8_t byte = bytes[position + index];
+         found |= (byte == CR) | (byte == LF);
+      }
+      if (found) {
+         break;
+      }
+      position += SCAN_BLOCK_SIZE;
+   }
+
+   while (position < count && bytes[position] != CR && bytes[position] != LF) {
+      position++;
+   }
+   return position;
+}
+
+static void appendToLine(LineReader *reader, const uint8_t *bytes, size_t count) {
+   size_t remainingSpace = reader->maxLineLength - reader->lineLength;
+   if (count > remainingSpace) {
+      reader->isLineTooLong = true;
+      count                 = remainingSpace;
+   }
+   memcpy(reader->line + reader->lineLength, bytes, count);
+   reader->lineLength += count;
+}
+
+static void releasePreviousLine(LineReader *reader) {
+   if (reader->isLineReady) {
+      reader->isLineReady   = false;
+      reader->lineLength    = 0;
+      reader->isLineTooLong = false;
+   }
+}
+
+bool getNextLine(LineReader *reader, LineStatus *status) {
+   size_t head = __atomic_load_n(&reader->head, __ATOMIC_ACQUIRE);
+   size_t tail = reader->tail;
+
+   releasePreviousLine(reader);
+
+   while (!reader->isLineReady && tail != head) {
+      size_t offset        = tail & (reader->ringCapacity - 1);
+      size_t count         = head - tail < reader->ringCapacity - offset ? head - tail : reader->ringCapacity - offset;
+      const uint8_t *bytes = reader->ringBuffer + offset;
+
+      if (reader->skipLineFeed) {
+         reader->skipLineFeed = false;
+         if (bytes[0] == LF) {
+            tail++;
+            continue;
+         }
+      }
+
+      size_t position = findLineEnd(bytes, count);
+      appendToLine(reader, bytes, position);
+      tail += position;
+
+      if (position < count) {
+         reader->skipLineFeed = bytes[position] == CR;
+         reader->isLineReady  = true;
+         tail++;
+      }
+   }
+   __atomic_store_n(&reader->tail, tail, __ATOMIC_RELEASE);
+
+   if (reader->isLineReady) {
+      reader->line[reader->lineLength] = 0;
+      *status = reader->isLineTooLong ? LINE_TOO_LONG : LINE_COMPLETE;
+   }
+   return reader->isLineReady;
+}
+
+size_t takeBytes(LineReader *reader, uint8_t *buffer, size_t maxByteCount) {
+   size_t head       = __atomic_load_n(&reader->head, __ATOMIC_ACQUIRE);
+   size_t tail       = reader->tail;
+   size_t byteCount  = 0;
+
+   releasePreviousLine(reader);
+
+   while (byteCount < maxByteCount && tail != head) {
+      size_t offset        = tail & (reader->ringCapacity - 1);
+      size_t count         = head - tail < reader->ringCapacity - offset ? head - tail : reader->ringCapacity - offset;
+      const uint8_t *bytes = reader->ringBuffer + offset;
+
+      if (reader->skipLineFeed) {
+         reader->skipLineFeed = false;
+         if (bytes[0] == LF) {
+            tail++;
+            continue;
+         }
+      }
+
+      count = count < maxByteCount - byteCount ? count : maxByteCount - byteCount;
+      memcpy(buffer + byteCount, bytes, count);
+      byteCount += count;
+      tail      += count;
+   }
+   __atomic_store_n(&reader->tail, tail, __ATOMIC_RELEASE);
+   return byteCount;
+}
@@ -0,0 +1,60 @@
+#ifndef assembler_line_reader_h
+#define assembler_line_reader_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define XON    0x11
+#define XOFF   0x13
+
+// Source of the received bytes (e.g. the UART of the ESP32 or a pty on Linux).
+typedef struct {
+   void     *context;
+   // Returns the number of bytes copied into buffer (at most maxByteCount). Waits at most timeoutInMilliseconds for the
+   // first byte and returns 0 if none arrived.
+   size_t   (*read)(void *context, uint8_t *buffer, size_t maxByteCount, uint32_t timeoutInMilliseconds);
+   // Sends bytes to the peer (used for the software flow control characters XON and XOFF).
+   void     (*write)(void *context, const uint8_t *bytes, size_t byteCount);
+} ByteStream;
+
+typedef enum {
+   LINE_COMPLETE,
+   LINE_TOO_LONG        // line contains the first maxLineLength bytes, the rest got dropped
+} LineStatus;
+
+/**
+ * Splits the received bytes into lines terminated by CR, LF or CRLF. The bytes get received in bulk into a ring buffer
+ * by receiveBytes (producer) and get framed into lines by getNextLine (consumer). Both functions can get called by
+ * different tasks. The producer sends XOFF as soon as the ring buffer is filled to 3/4 and XON when it drained to 1/4.
+ */
+typedef struct {
+   const ByteStream *stream;
+   uint8_t          *ringBuffer;
+   size_t           ringCapacity;        // needs to be a power of 2
+   size_t           head;                // total number of received bytes (written by the producer)
+   size_t           tail;                // total number of framed bytes (written by the consumer)
+   bool             isPaused;            // XOFF got sent
+   uint8_t          *line;               // needs space for maxLineLength + 1 bytes (line gets null terminated)
+   size_t           maxLineLength;
+   size_t           lineLength;
+   bool             isLineTooLong;
+   bool             isLineReady;         // the last call of getNextLine returned the content of line
+   bool             skipLineFeed;        // the previous line ended with CR -> an immediately following LF belongs to it
+} LineReader;
+
+void initializeLineReader(LineReader *reader, const ByteStream *stream, uint8_t *ringBuffer, size_t ringCapacity, uint8_t *line, size_t maxLineLength);
+
+// Reads all available bytes (as much as fits into the ring buffer) and returns their number.
+size_t receiveBytes(LineReader *reader, uint32_t timeoutInMilliseconds);
+
+// Returns true if reader->line contains the next line (its length is reader->lineLength).
+bool getNextLine(LineReader *reader, LineStatus *status);
+
+/**
+ * Copies up to maxByteCount received bytes without framing them into lines (e.g. for binary uploads) and returns their
+ * number. A LF that terminates the previously returned line together with a CR gets skipped.
+ */
+size_t takeBytes(LineReader *reader, uint8_t *buffer, size_t maxByteCount);
+
+#endif
@@ -0,0 +1,179 @@
+#include <stdbool.h>
+
+#include "Optimizer.h"
+#include "Commands.h"
+#include "CycleCount.h"
+#include "InstructionSet.h"
+
+#define IS_JUMP_TARGET        1
+
+// The bit layouts of the commands are defined in InstructionSet.h.
+
+static uint32_t toWord(CommandBytes *commandBytes) {
+   return commandBytes->byte0 | (commandBytes->byte1 << 8) | (commandBytes->byte2 << 16) | ((uint32_t)commandBytes->byte3 << 24);
+}
+
+static CommandBytes toCommandBytes(uint32_t word) {
+   return (CommandBytes){word & 0xff, (word >> 8) & 0xff, (word >> 16) & 0xff, word >> 24};
+}
+
+static bool isAluOperation(uint32_t word, UlpFormat format, uint32_t operation) {
+   return hasFormat(word, format) && getField(word, FIELD_ALU_OPERATION) == operation;
+}
+
+static bool isWait(uint32_t word) {
+   return hasFormat(word, FORMAT_WAIT);
+}
+
+static bool isJump(uint32_t word) {
+   return getField(word, FIELD_OPCODE) == FORMAT_LAYOUTS[FORMAT_JUMP].opCode;
+}
+
+static bool isAbsoluteJump(uint32_t word) {
+   return hasFormat(word, FORMAT_JUMP);
+}
+
+static bool isIndirectJump(uint32_t word) {
+   return isAbsoluteJump(word) && getField(word, FIELD_JUMP_ADDRESS_IN_REGISTER);
+}
+
+// Returns the step of a relative jump (jumpr and jumps) in words.
+static int32_t relativeJumpStep(uint32_t word) {
+   int32_t step = getField(word, FIELD_RELATIVE_JUMP_STEP);
+   return getField(word, FIELD_RELATIVE_JUMP_SIGN) ? -step : step;
+}
+
+static bool isMoveToItself(uint32_t word) {
+   return isAluOperation(word, FORMAT_ALU_REGISTERS, ALU_MOVE) && getField(word, FIELD_ALU_DESTINATION_REGISTER) == getField(word, FIELD_ALU_SOURCE_REGISTER1);
+}
+
+// "add rX, rY, 0" -> "move rX, rY" (Rsrc2 = Rsrc1 like the IDF does for move).
+static uint32_t foldAddOfZero(uint32_t word) {
+   if (!isAluOperation(word, FORMAT_ALU_IMMEDIATE, ALU_ADD) || getField(word, FIELD_ALU_IMMEDIATE) != 0) {
+      return word;
+   }
+   uint32_t sourceRegister = getField(word, FIELD_ALU_SOURCE_REGISTER1);
+   uint32_t move           = setField(createWord(FORMAT_ALU_REGISTERS), FIELD_ALU_OPERATION, ALU_MOVE);
+   move                    = setField(move, FIELD_ALU_DESTINATION_REGISTER, getField(word, FIELD_ALU_DESTINATION_REGISTER));
+   move                    = setField(move, FIELD_ALU_SOURCE_REGISTER1, sourceRegister);
+   return setField(move, FIELD_ALU_SOURCE_REGISTER2, sourceRegister);
+}
+
+// Returns true if the ALU flags set by the command at commandIndex get overwritten by an ALU operation before a
+// conditional absolute jump reads them. Other jumps end the search (their targets are not followed).
+static bool areFlagsOverwrittenBeforeUse(const uint32_t *words, size_t wordCount, size_t commandIndex) {
+   for (size_t index = commandIndex + 1; index < wordCount; index++) {
+      uint32_t word = words[index];
+      if (hasFormat(word, FORMAT_ALU_REGISTERS) || hasFormat(word, FORMAT_ALU_IMMEDIATE)) {
+         return true;
+      }
+      if (hasFormat(word, FORMAT_HALT)) {
+         return true;
+      }
+      if (isJump(word)) {
+         return false;
+      }
+   }
+   return false;
+}
+
+// Returns the index of the target or -1 for indirect jumps.
+static int64_t getJumpTarget(uint32_t word, size_t commandIndex) {
+   if (isIndirectJump(word)) {
+      return -1;
+   }
+   return isAbsoluteJump(word) ? (int64_t)getField(word, FIELD_JUMP_ADDRESS) : (int64_t)commandIndex + relativeJumpStep(word);
+}
+
+static size_t getNewIndex(const size_t *newIndices, size_t wordCount, size_t index) {
+   return index <= wordCount ? newIndices[index] : index - wordCount + newIndices[wordCount];
+}
+
+static Optimization failure(OptimizationStatus status, size_t commandIndex, size_t wordCount) {
+   return (Optimization){status, commandIndex, wordCount, 0, wordCount, 0};
+}
+
+static void setModified(Optimization *result, size_t index) {
+   result->firstModifiedIndex = index < result->firstModifiedIndex ? index : result->firstModifiedIndex;
+}
+
+Optimization optimizeProgram(uint32_t *words, size_t wordCount, size_t *newIndices) {
+   Optimization result         = {OPTIMIZATION_DONE, 0, 0, 0, wordCount, 0};
+   size_t firstRemovableIndex  = 0;
+
+   // first pass: find the variables and mark the jump targets
+   for (size_t index = 0; index <= wordCount; index++) {
+      newIndices[index] = 0;
+   }
+   for (size_t index = 0; index < wordCount; index++) {
+      uint32_t word = words[index];
+      if (getCycleCount(word) == 0) {
+         firstRemovableIndex = index + 1;
+      } else if (isJump(word)) {
+         int64_t target = getJumpTarget(word, index);
+         if (isIndirectJump(word)) {
+            return failure(OPTIMIZATION_INDIRECT_JUMP, index, wordCount);
+         }
+         if (target < 0) {
+            return failure(OPTIMIZATION_INVALID_JUMP, index, wordCount);
+         }
+         if ((size_t)target < wordCount) {
+            newIndices[target] = IS_JUMP_TARGET;
+         }
+      }
+   }
+
+   // second pass: remove and merge commands (the remaining ones move to their new index)
+   size_t newWordCount = 0;
+   for (size_t index = 0; index < wordCount; index++) {
+      uint32_t word       = words[index];
+      bool isJumpTarget   = newIndices[index] == IS_JUMP_TARGET;
+      newIndices[index]   = newWordCount;
+
+      if (index >= firstRemovableIndex) {
+         word = foldAddOfZero(word);
+         if (isWait(word) && getField(word, FIELD_WAIT_CYCLES) == 0) {
+            result.savedCycleCount += getCycleCount(word);
+            setModified(&result, newWordCount);
+            continue;
+         }
+         if (isMoveToItself(word) && areFlagsOverwrittenBeforeUse(words, wordCount, index)) {
+            result.savedCycleCount += getCycleCount(word);
+            setModified(&result, newWordCount);
+            continue;
+         }
+         uint32_t previousWord = newWordCount > firstRemovableIndex ? words[newWordCount - 1] : 0;
+         if (isWait(word) && !isJumpTarget && isWait(previousWord) && getField(previousWord, FIELD_WAIT_CYCLES) + getField(word, FIELD_WAIT_CYCLES) <= (uint32_t)getFieldMaximum(FIELD_WAIT_CYCLES)) {
+            words[newWordCount - 1] = previousWord + getField(word, FIELD_WAIT_CYCLES);
+            result.savedCycleCount += getCycleCount(word) - getField(word, FIELD_WAIT_CYCLES);
+            setModified(&result, newWordCount - 1);
+            continue;
+         }
+      }
+      if (word != words[index]) {
+         setModified(&result, newWordCount);
+      }
+      words[newWordCount++] = word;
+   }
+   newIndices[wordCount] = newWordCount;
+
+   // third pass: update the targets of the jumps that remained
+   for (size_t index = 0; index < wordCount; index++) {
+      size_t newIndex = newIndices[index];
+      bool isRemoved  = newIndices[index + 1] == newIndex;
+      if (isRemoved || !isJump(words[newIndex])) {
+         continue;
+      }
+      CommandBytes commandBytes = toCommandBytes(words[newIndex]);
+      size_t newTarget          = getNewIndex(newIndices, wordCount, getJumpTarget(words[newIndex], index));
+      setJumpTarget(&commandBytes, newIndex * 4, newTarget * 4);
+      if (toWord(&commandBytes) != words[newIndex]) {
+         words[newIndex] = toWord(&commandBytes);
+         setModified(&result, newIndex);
+      }
+   }
+
+   result.wordCount        = newWordCount;
+   result.removedWordCount = wordCount - newWordCount;
+   return result;
+}
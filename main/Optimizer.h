@@ -0,0 +1,39 @@
+#ifndef assembler_optimizer_h
+#define assembler_optimizer_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+   OPTIMIZATION_DONE,
+   OPTIMIZATION_INDIRECT_JUMP,   // the targets of the jump to a register are unknown -> no word can get removed
+   OPTIMIZATION_INVALID_JUMP     // a relative jump leads in front of the program
+} OptimizationStatus;
+
+typedef struct {
+   OptimizationStatus status;
+   size_t             commandIndex;        // of the jump that prevented the optimization
+   size_t             wordCount;           // after the optimization
+   size_t             removedWordCount;
+   size_t             firstModifiedIndex;  // index of the first word that changed (wordCount if none changed)
+   uint32_t           savedCycleCount;     // assuming each command gets executed once
+} Optimization;
+
+/**
+ * Peephole optimization of the assembled words (in place):
+ *
+ *    - "add rX, rY, 0" becomes "move rX, rY"
+ *    - "move rX, rX" gets removed if the ALU flags it sets get overwritten before a "jump ..., eq|ov" reads them
+ *    - "nop" gets removed
+ *    - consecutive "wait" commands get merged (if the second one is no jump target and the sum fits into 16 bit)
+ *
+ * Only words behind the last variable (word that is no command) get removed because ld and st address the variables
+ * by their index. The targets of relative and absolute jumps get updated. Jumps behind the program (e.g. into commands
+ * appended later) keep their distance to the end of the program.
+ *
+ * newIndices needs space for wordCount + 1 entries and receives the index of each word after the optimization (the
+ * index of the next remaining word for removed words). newIndices[wordCount] contains the new word count.
+ */
+Optimization optimizeProgram(uint32_t *words, size_t wordCount, size_t *newIndices);
+
+#endif
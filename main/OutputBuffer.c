@@ -0,0 +1,52 @@
+#include <string.h>
+
+#include "OutputBuffer.h"
+
+#define MAX_DECIMAL_DIGIT_COUNT  10
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+void flushOutput(OutputBuffer *output) {
+   if (output->length > 0) {
+      output->write(output->context, output->block, output->length);
+      output->length = 0;
+   }
+}
+
+void appendBytes(OutputBuffer *output, const uint8_t *bytes, size_t byteCount) {
+   while (byteCount > 0) {
+      if (output->length == output->capacity) {
+         flushOutput(output);
+      }
+      size_t freeSpace = output->capacity - output->length;
+      size_t count     = byteCount < freeSpace ? byteCount : freeSpace;
+      memcpy(output->block + output->length, bytes, count);
+      output->length += count;
+      bytes          += count;
+      byteCount      -= count;
+   }
+}
+
+void appendText(OutputBuffer *output, const char *text) {
+   appendBytes(output, (const uint8_t*)text, strlen(text));
+}
+
+void appendHexByte(OutputBuffer *output, uint8_t value) {
+   uint8_t digits[] = {HEX_DIGITS[value >> 4], HEX_DIGITS[value & 0x0f]};
+   appendBytes(output, digits, sizeof(digits));
+}
+
+void appendDecimal(OutputBuffer *output, uint32_t value, size_t minWidth) {
+   uint8_t digits[MAX_DECIMAL_DIGIT_COUNT];
+   size_t start = MAX_DECIMAL_DIGIT_COUNT;
+
+   do {
+      digits[--start] = '0' + (value % 10);
+      value          /= 10;
+   } while (value > 0);
+
+   for (size_t width = MAX_DECIMAL_DIGIT_COUNT - start; width < minWidth; width++) {
+      appendBytes(output, (const uint8_t*)" ", 1);
+   }
+   appendBytes(output, digits + start, MAX_DECIMAL_DIGIT_COUNT - start);
+}
@@ -0,0 +1,31 @@
+#ifndef assembler_output_buffer_h
+#define assembler_output_buffer_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Collects text in a caller provided block and passes it to write as soon as the block is full or flushOutput gets
+ * called. Numbers get formatted without the stdio functions.
+ */
+typedef struct {
+   uint8_t  *block;
+   size_t   capacity;
+   size_t   length;
+   void     *context;
+   void     (*write)(void *context, const uint8_t *bytes, size_t byteCount);
+} OutputBuffer;
+
+void appendBytes(OutputBuffer *output, const uint8_t *bytes, size_t byteCount);
+
+void appendText(OutputBuffer *output, const char *text);
+
+// Appends two lower case hex digits.
+void appendHexByte(OutputBuffer *output, uint8_t value);
+
+// Appends the decimal representation of value, right aligned with spaces to at least minWidth characters.
+void appendDecimal(OutputBuffer *output, uint32_t value, size_t minWidth);
+
+void flushOutput(OutputBuffer *output);
+
+#endif
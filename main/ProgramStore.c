@@ -0,0 +1,75 @@
+#include <stdio.h>
+
+#include "ProgramStore.h"
+#include "FrameCodec.h"
+#include "UlpBinary.h"
+
+#define WORD_SIZE_IN_BYTES    4
+#define IMAGE_KEY_FORMAT      "image%u"
+#define METADATA_KEY_FORMAT   "meta%u"
+#define AUTORUN_KEY           "autorun"
+
+static size_t getImageSize(const StoredProgram *program) {
+   return ULP_PROGRAM_HEADER_SIZE_IN_BYTES + (size_t)program->wordCount * WORD_SIZE_IN_BYTES;
+}
+
+StoreStatus saveProgram(const ProgramStorage *storage, uint32_t slot, const uint8_t *image, StoredProgram *program) {
+   char key[MAX_STORAGE_KEY_LENGTH + 1];
+
+   if (slot >= PROGRAM_SLOT_COUNT) {
+      return STORE_INVALID_SLOT;
+   }
+   program->magic    = STORED_PROGRAM_MAGIC;
+   program->reserved = 0;
+   program->crc      = calculateCrc32(0, image, getImageSize(program));
+
+   snprintf(key, sizeof(key), IMAGE_KEY_FORMAT, (unsigned)slot);
+   if (!storage->writeBlob(storage->context, key, image, getImageSize(program))) {
+      return STORE_WRITE_FAILED;
+   }
+   snprintf(key, sizeof(key), METADATA_KEY_FORMAT, (unsigned)slot);
+   return storage->writeBlob(storage->context, key, program, sizeof(StoredProgram)) ? STORE_DONE : STORE_WRITE_FAILED;
+}
+
+StoreStatus loadProgram(const ProgramStorage *storage, uint32_t slot, uint8_t *image, size_t maxImageSize, StoredProgram *program) {
+   char key[MAX_STORAGE_KEY_LENGTH + 1];
+   size_t byteCount;
+
+   if (slot >= PROGRAM_SLOT_COUNT) {
+      return STORE_INVALID_SLOT;
+   }
+   snprintf(key, sizeof(key), METADATA_KEY_FORMAT, (unsigned)slot);
+   if (!storage->readBlob(storage->context, key, program, sizeof(StoredProgram), &byteCount)) {
+      return STORE_EMPTY_SLOT;
+   }
+   if (byteCount != sizeof(StoredProgram) || program->magic != STORED_PROGRAM_MAGIC || program->entryIndex >= program->wordCount) {
+      return STORE_CORRUPTED;
+   }
+   if (getImageSize(program) > maxImageSize) {
+      return STORE_TOO_LARGE;
+   }
+
+   snprintf(key, sizeof(key), IMAGE_KEY_FORMAT, (unsigned)slot);
+   if (!storage->readBlob(storage->context, key, image, maxImageSize, &byteCount) || byteCount != getImageSize(program) ||
+       calculateCrc32(0, image, byteCount) != program->crc) {
+      return STORE_CORRUPTED;
+   }
+   return STORE_DONE;
+}
+
+StoreStatus setAutorunSlot(const ProgramStorage *storage, uint32_t slot) {
+   if (slot >= PROGRAM_SLOT_COUNT && slot != NO_AUTORUN_SLOT) {
+      return STORE_INVALID_SLOT;
+   }
+   return storage->writeBlob(storage->context, AUTORUN_KEY, &slot, sizeof(slot)) ? STORE_DONE : STORE_WRITE_FAILED;
+}
+
+uint32_t getAutorunSlot(const ProgramStorage *storage) {
+   uint32_t slot;
+   size_t byteCount;
+
+   if (!storage->readBlob(storage->context, AUTORUN_KEY, &slot, sizeof(slot), &byteCount) || byteCount != sizeof(slot) || slot >= PROGRAM_SLOT_COUNT) {
+      return NO_AUTORUN_SLOT;
+   }
+   return slot;
+}
@@ -0,0 +1,62 @@
+#ifndef assembler_program_store_h
+#define assembler_program_store_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROGRAM_SLOT_COUNT        8
+#define NO_AUTORUN_SLOT           UINT32_MAX
+#define STORED_PROGRAM_MAGIC      0x53706c75
+#define MAX_STORAGE_KEY_LENGTH    15
+
+/**
+ * Non-volatile key/value storage of blobs (NVS on the ESP32, files on the host). Writing a blob replaces the previous
+ * one with the same key as a whole.
+ */
+typedef struct {
+   void  *context;
+   bool  (*writeBlob)(void *context, const char *key, const void *bytes, size_t byteCount);
+   // Copies the blob into bytes. Returns false if there is no blob with this key or it is larger than maxByteCount.
+   bool  (*readBlob)(void *context, const char *key, void *bytes, size_t maxByteCount, size_t *byteCount);
+} ProgramStorage;
+
+// Metadata stored next to the image of a program.
+typedef struct {
+   uint32_t magic;
+   uint16_t entryIndex;      // index of the first command to execute
+   uint16_t wordCount;       // words following the header of the image (commands and variables)
+   uint16_t variableCount;
+   uint16_t reserved;
+   uint32_t crc;             // CRC-32 of the image
+} StoredProgram;
+
+typedef enum {
+   STORE_DONE,
+   STORE_INVALID_SLOT,
+   STORE_EMPTY_SLOT,
+   STORE_CORRUPTED,          // the image does not match its metadata (e.g. power loss while saving)
+   STORE_TOO_LARGE,
+   STORE_WRITE_FAILED
+} StoreStatus;
+
+/**
+ * Stores image (a ULP binary consisting of the header and program->wordCount words) in slot. The image gets written
+ * before the metadata -> an interrupted save leaves a slot that loadProgram reports as corrupted. Sets magic and crc of
+ * program.
+ */
+StoreStatus saveProgram(const ProgramStorage *storage, uint32_t slot, const uint8_t *image, StoredProgram *program);
+
+/**
+ * Copies the image stored in slot into image and its metadata into program. Returns STORE_CORRUPTED if the CRC-32 of
+ * the image does not match (the content of image is undefined in this case).
+ */
+StoreStatus loadProgram(const ProgramStorage *storage, uint32_t slot, uint8_t *image, size_t maxImageSize, StoredProgram *program);
+
+// Defines the slot whose program gets started at boot (NO_AUTORUN_SLOT disables it).
+StoreStatus setAutorunSlot(const ProgramStorage *storage, uint32_t slot);
+
+// Returns NO_AUTORUN_SLOT if no autorun slot got defined.
+uint32_t getAutorunSlot(const ProgramStorage *storage);
+
+#endif
@@ -0,0 +1,146 @@
+#include "Scanner.h"
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAS_X86_VECTOR_UNIT
+#endif
+
+#define BLOCK_SIZE         64
+#define LINE_FEED          '\n'
+#define CARRIAGE_RETURN    '\r'
+#define SLASH              '/'
+
+static void classifyBlockScalar(const uint8_t *block, size_t count, uint64_t *lineBreaks, uint64_t *slashes) {
+   *lineBreaks = 0;
+   *slashes    = 0;
+   for (size_t index = 0; index < count; index++) {
+      uint64_t bit = (uint64_t)1 << index;
+      *lineBreaks |= (block[index] == LINE_FEED || block[index] == CARRIAGE_RETURN) ? bit : 0;
+      *slashes    |= (block[index] == SLASH) ? bit : 0;
+   }
+}
+
+#ifdef HAS_X86_VECTOR_UNIT
+static void classifyBlockSse2(const uint8_t *block, uint64_t *lineBreaks, uint64_t *slashes) {
+   const __m128i lineFeeds       = _mm_set1_epi8(LINE_FEED);
+   const __m128i carriageReturns = _mm_set1_epi8(CARRIAGE_RETURN);
+   const __m128i slashCharacters = _mm_set1_epi8(SLASH);
+   *lineBreaks = 0;
+   *slashes    = 0;
+   for (size_t offset = 0; offset < BLOCK_SIZE; offset += sizeof(__m128i)) {
+      __m128i bytes  = _mm_loadu_si128((const __m128i*)(block + offset));
+      __m128i breaks = _mm_or_si128(_mm_cmpeq_epi8(bytes, lineFeeds), _mm_cmpeq_epi8(bytes, carriageReturns));
+      *lineBreaks   |= (uint64_t)(uint16_t)_mm_movemask_epi8(breaks) << offset;
+      *slashes      |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, slashCharacters)) << offset;
+   }
+}
+
+// Gets compiled for AVX2 even if the compiler targets an older CPU -> call it only if the CPU supports AVX2.
+__attribute__((target("avx2")))
+static void classifyBlockAvx2(const uint8_t *block, uint64_t *lineBreaks, uint64_t *slashes) {
+   const __m256i lineFeeds       = _mm256_set1_epi8(LINE_FEED);
+   const __m256i carriageReturns = _mm256_set1_epi8(CARRIAGE_RETURN);
+   const __m256i slashCharacters = _mm256_set1_epi8(SLASH);
+   *lineBreaks = 0;
+   *slashes    = 0;
+   for (size_t offset = 0; offset < BLOCK_SIZE; offset += sizeof(__m256i)) {
+      __m256i bytes  = _mm256_loadu_si256((const __m256i*)(block + offset));
+      __m256i breaks = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, lineFeeds), _mm256_cmpeq_epi8(bytes, carriageReturns));
+      *lineBreaks   |= (uint64_t)(uint32_t)_mm256_movemask_epi8(breaks) << offset;
+      *slashes      |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, slashCharacters)) << offset;
+   }
+}
+#endif
+
+// The last block is shorter than BLOCK_SIZE in most cases and gets classified by the scalar implementation (the vector
+// implementations would read behind the text).
+static void loadBlock(Scanner *scanner, size_t blockStart) {
+   const uint8_t *block = scanner->text + blockStart;
+   size_t count         = scanner->length - blockStart < BLOCK_SIZE ? scanner->length - blockStart : BLOCK_SIZE;
+   uint64_t slashes     = 0;
+
+#ifdef HAS_X86_VECTOR_UNIT
+   if (count == BLOCK_SIZE && scanner->implementation == SCANNER_AVX2) {
+      classifyBlockAvx2(block, &scanner->lineBreaks, &slashes);
+   } else if (count == BLOCK_SIZE && scanner->implementation == SCANNER_SSE2) {
+      classifyBlockSse2(block, &scanner->lineBreaks, &slashes);
+   } else {
+      classifyBlockScalar(block, count, &scanner->lineBreaks, &slashes);
+   }
+#else
+   classifyBlockScalar(block, count, &scanner->lineBreaks, &slashes);
+#endif
+
+   // a comment starts at each slash followed by a slash (the second one might be the first byte of the next block)
+   bool isSlashBehindBlock = blockStart + BLOCK_SIZE < scanner->length && block[BLOCK_SIZE] == SLASH;
+   scanner->blockStart     = blockStart;
+   scanner->comments       = slashes & ((slashes >> 1) | ((uint64_t)isSlashBehindBlock << (BLOCK_SIZE - 1)));
+}
+
+ScannerImplementation getFastestScannerImplementation(void) {
+#ifdef HAS_X86_VECTOR_UNIT
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2") ? SCANNER_AVX2 : SCANNER_SSE2;
+#else
+   return SCANNER_SCALAR;
+#endif
+}
+
+void initScanner(Scanner *scanner, const uint8_t *text, size_t length, ScannerImplementation implementation) {
+   scanner->text           = text;
+   scanner->length         = length;
+   scanner->position       = 0;
+   scanner->blockStart     = 0;
+   scanner->lineBreaks     = 0;
+   scanner->comments       = 0;
+   scanner->implementation = implementation;
+   if (length > 0) {
+      loadBlock(scanner, 0);
+   }
+}
+
+bool nextLine(Scanner *scanner, SourceLine *line) {
+   size_t start = scanner->position;
+   if (start >= scanner->length) {
+      return false;
+   }
+
+   size_t   lineEnd      = scanner->length;
+   size_t   commentStart = scanner->length;
+   bool     hasComment   = false;
+   uint64_t fromStart    = ~(uint64_t)0 << (start - scanner->blockStart);
+   while (true) {
+      uint64_t lineBreaks = scanner->lineBreaks & fromStart;
+      uint64_t comments   = scanner->comments & fromStart;
+      if (lineBreaks != 0) {
+         lineEnd   = scanner->blockStart + __builtin_ctzll(lineBreaks);
+         comments &= (lineBreaks & -lineBreaks) - 1;     // only the comments in front of the line break
+      }
+      if (!hasComment && comments != 0) {
+         commentStart = scanner->blockStart + __builtin_ctzll(comments);
+         hasComment   = true;
+      }
+      if (lineBreaks != 0 || scanner->blockStart + BLOCK_SIZE >= scanner->length) {
+         break;
+      }
+      loadBlock(scanner, scanner->blockStart + BLOCK_SIZE);
+      fromStart = ~(uint64_t)0;
+   }
+
+   line->start         = scanner->text + start;
+   line->length        = lineEnd - start;
+   line->commandLength = (hasComment ? commentStart : lineEnd) - start;
+
+   size_t next = lineEnd;
+   if (next < scanner->length && scanner->text[next] == CARRIAGE_RETURN) {
+      next++;
+   }
+   if (next < scanner->length && scanner->text[next] == LINE_FEED) {
+      next++;
+   }
+   while (next < scanner->length && next >= scanner->blockStart + BLOCK_SIZE) {
+      loadBlock(scanner, scanner->blockStart + BLOCK_SIZE);
+   }
+   scanner->position = next;
+   return true;
+}
@@ -0,0 +1,49 @@
+#ifndef assembler_scanner_h
+#define assembler_scanner_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+   SCANNER_SCALAR,
+   SCANNER_SSE2,      // 16 bytes per instruction
+   SCANNER_AVX2       // 32 bytes per instruction
+} ScannerImplementation;
+
+typedef struct {
+   const uint8_t *start;            // points into the scanned text
+   size_t         length;           // without the line break
+   size_t         commandLength;    // bytes in front of the comment ("//"), length if the line contains no comment
+} SourceLine;
+
+typedef struct {
+   const uint8_t          *text;
+   size_t                 length;
+   size_t                 position;      // start of the next line
+   size_t                 blockStart;
+   uint64_t               lineBreaks;    // one bit per byte of the current block (CR or LF)
+   uint64_t               comments;      // one bit per byte of the current block that starts "//"
+   ScannerImplementation  implementation;
+} Scanner;
+
+/**
+ * Returns the fastest implementation the CPU supports. Each implementation in front of it is available as well (the
+ * ESP32 uses the scalar one).
+ */
+ScannerImplementation getFastestScannerImplementation(void);
+
+/**
+ * Prepares splitting text (length bytes, no 0 termination required) into lines. The scanner classifies 64 bytes at a
+ * time (line breaks and comment markers) and finds the next line by counting trailing zeros of the resulting bit masks
+ * instead of comparing each byte. All implementations return the same lines.
+ */
+void initScanner(Scanner *scanner, const uint8_t *text, size_t length, ScannerImplementation implementation);
+
+/**
+ * Writes the next line to line and returns true, or returns false at the end of the text. Lines get separated by LF,
+ * CR or CRLF.
+ */
+bool nextLine(Scanner *scanner, SourceLine *line);
+
+#endif
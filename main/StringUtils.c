@@ -2,52 +2,47 @@
 
 #include "StringUtils.h"
 
-#define CR           0x0a
+#define LF           0x0a
+#define CR           0x0d
 #define TAB          0x09
 #define SPACE        0x20
+#define COMMA        0x2c
 
-static bool isWhitespace(uint8_t character) {
-   return character == SPACE || character == TAB || character == CR;
-} 
-
-uint8_t* trim(uint8_t* text) {
-   size_t indexOfFirstNonWhitespace = 0;
-   uint8_t currentChar = *(text + indexOfFirstNonWhitespace);
+static bool isSeparator(uint8_t character) {
+   return character == SPACE || character == TAB || character == CR || character == LF || character == COMMA;
+}
 
-   while (currentChar != 0) {
-      if (isWhitespace(currentChar)) {
-         indexOfFirstNonWhitespace++;
-         currentChar = *(text + indexOfFirstNonWhitespace);
-      } else {
-         break;
+// The write position never passes the read position -> the line can get normalized in place.
+size_t normalizeLine(uint8_t *line, size_t lineLength, TokenView *tokens, size_t maxTokenCount, size_t *tokenCount) {
+   size_t length          = 0;
+   size_t count           = 0;
+   bool   isInsideToken   = false;
+
+   for (size_t index = 0; index < lineLength; index++) {
+      uint8_t character = line[index];
+      if (isSeparator(character)) {
+         isInsideToken = false;
+         continue;
       }
-   }
-
-   if (indexOfFirstNonWhitespace > 0) {
-      size_t offset = 0;
-      while (*(text + indexOfFirstNonWhitespace + offset) != 0) {
-         *(text + offset) = *(text + indexOfFirstNonWhitespace + offset);
-         offset++;
+      if (!isInsideToken) {
+         if (count > 0) {
+            line[length++] = SPACE;
+         }
+         if (tokens != NULL && count < maxTokenCount) {
+            tokens[count] = (TokenView){line + length, 0};
+         }
+         count++;
+         isInsideToken = true;
+      }
+      line[length++] = tolower(character);
+      if (tokens != NULL && count <= maxTokenCount) {
+         tokens[count - 1].length++;
       }
-      *(text + offset) = 0;
    }
 
-   size_t indexOfFirstTrailingWhitespace = strlen((char*)text);
-   
-   for (size_t index = strlen((char*)text) - 1; isWhitespace(*(text + index)); index--) {
-      indexOfFirstTrailingWhitespace = index;
-   }
-   
-   if (indexOfFirstTrailingWhitespace < strlen((char*)text)) {
-      *(text + indexOfFirstTrailingWhitespace) = 0;
+   line[length] = 0;
+   if (tokenCount != NULL) {
+      *tokenCount = count;
    }
-   return text;
+   return length;
 }
-
-uint8_t* toLowerCase(uint8_t* text) {
-   for(uint8_t* currentChar = text; *currentChar != 0; currentChar++) {
-      uint8_t lowerCaseChar = tolower(*currentChar);
-      *currentChar = lowerCaseChar;
-   }
-   return text;
-}
\ No newline at end of file
@@ -5,16 +5,20 @@
 #include <string.h>
 #include <stdbool.h>
 
-/**
- * Replaces every character in text by its lower case representation and returns the pointer to the first character.
- * The replacement happens in place -> the returned pointer is the same pointer as text.
- */
-uint8_t* toLowerCase(uint8_t* text);
+typedef struct {
+   const uint8_t *start;      // points into the normalized line
+   size_t         length;
+} TokenView;
 
 /**
- * Removes leading and trailing whitespaces and returns the pointer to the first whitespace that is not a whitespace.
- * Trimming happens in place.
+ * Normalizes the line (lineLength bytes, no 0 termination required) in place and in a single pass: leading and trailing
+ * whitespace gets removed, all characters become lower case, commas become spaces and consecutive whitespace (space,
+ * tab, CR, LF and commas) collapses into a single space. The normalized line gets 0 terminated (line needs space for
+ * lineLength + 1 bytes) and its length gets returned.
+ *
+ * If tokens is not NULL, it receives the start and length of the first maxTokenCount tokens (the words between the
+ * spaces of the normalized line) without copying them. tokenCount (can be NULL) receives the number of all tokens.
  */
-uint8_t* trim(uint8_t* text);
+size_t normalizeLine(uint8_t *line, size_t lineLength, TokenView *tokens, size_t maxTokenCount, size_t *tokenCount);
 
-#endif
\ No newline at end of file
+#endif
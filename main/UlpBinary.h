@@ -0,0 +1,18 @@
+#ifndef assembler_ulp_binary_h
+#define assembler_ulp_binary_h
+
+#include <stdint.h>
+
+#define ULP_BINARY_MAGIC                        0x00706c75
+#define ULP_PROGRAM_HEADER_SIZE_IN_BYTES        12
+
+// ULP program binary according to https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-guides/ulp.html?highlight=ulp%20magic#_CPPv415ulp_load_binary8uint32_tPK7uint8_t6size_t
+struct UlpBinary {
+   uint32_t magic;
+   uint16_t textOffset;
+   uint16_t textSize;
+   uint16_t dataSize;
+   uint16_t bssSize;
+};
+
+#endif
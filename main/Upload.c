@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Upload.h"
+
+static const char UNKNOWN_FRAME_TYPE[]   = "unknown frame type";
+static const char UNEXPECTED_OFFSET[]    = "unexpected offset";
+static const char IMAGE_TOO_LARGE[]      = "image too large";
+static const char IMAGE_SIZE_MISMATCH[]  = "image size mismatch";
+static const char IMAGE_CRC_MISMATCH[]   = "image CRC mismatch";
+
+static uint16_t readUint16(const uint8_t *bytes) {
+   return bytes[0] | (bytes[1] << 8);
+}
+
+static uint32_t readUint32(const uint8_t *bytes) {
+   return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static void sendResponse(Upload *upload, const char *keyword, uint32_t value) {
+   char response[MAX_UPLOAD_RESPONSE_LENGTH];
+   snprintf(response, sizeof(response), "%s %u\n", keyword, (unsigned int)value);
+   upload->sendResponse(upload->context, response);
+}
+
+void startUpload(Upload *upload, uint8_t *image, size_t maxImageSize, void *context, void (*sendResponse)(void *context, const char *response)) {
+   *upload = (Upload){
+      .image         = image,
+      .maxImageSize  = maxImageSize,
+      .context       = context,
+      .sendResponse  = sendResponse
+   };
+}
+
+void abortUpload(Upload *upload, const char *reason) {
+   char response[MAX_UPLOAD_RESPONSE_LENGTH];
+   upload->errorMessage = reason;
+   snprintf(response, sizeof(response), "ERROR %s\n", reason);
+   upload->sendResponse(upload->context, response);
+}
+
+// Requests the frame with the expected sequence number again (only once until it arrived).
+static void requestMissingFrame(Upload *upload) {
+   if (!upload->isNakSent) {
+      upload->isNakSent = true;
+      sendResponse(upload, "NAK", upload->expectedSequence);
+   }
+}
+
+static UploadStatus fail(Upload *upload, const char *reason) {
+   abortUpload(upload, reason);
+   return UPLOAD_FAILED;
+}
+
+static UploadStatus processData(Upload *upload, uint16_t offset, const uint8_t *payload, size_t payloadLength) {
+   if (offset != upload->imageSize) {
+      return fail(upload, UNEXPECTED_OFFSET);
+   }
+   if (upload->imageSize + payloadLength > upload->maxImageSize) {
+      return fail(upload, IMAGE_TOO_LARGE);
+   }
+   memcpy(upload->image + upload->imageSize, payload, payloadLength);
+   upload->imageSize += payloadLength;
+   if ((upload->expectedSequence + 1) % UPLOAD_WINDOW_SIZE == 0) {
+      sendResponse(upload, "ACK", upload->expectedSequence);
+   }
+   return UPLOAD_IN_PROGRESS;
+}
+
+static UploadStatus processEnd(Upload *upload, uint16_t imageSize, const uint8_t *payload, size_t payloadLength) {
+   if (payloadLength != UPLOAD_END_PAYLOAD_SIZE || imageSize != upload->imageSize) {
+      return fail(upload, IMAGE_SIZE_MISMATCH);
+   }
+   if (readUint32(payload) != calculateCrc32(0, upload->image, upload->imageSize)) {
+      return fail(upload, IMAGE_CRC_MISMATCH);
+   }
+   sendResponse(upload, "DONE", upload->imageSize);
+   return UPLOAD_COMPLETE;
+}
+
+static UploadStatus processFrame(Upload *upload) {
+   uint8_t frame[MAX_ENCODED_UPLOAD_FRAME_SIZE];
+   size_t length = decodeCobs(upload->encodedFrame, upload->encodedFrameLength, frame);
+
+   if (length == INVALID_FRAME || length < UPLOAD_FRAME_HEADER_SIZE + UPLOAD_FRAME_CRC_SIZE || length > MAX_UPLOAD_FRAME_SIZE) {
+      requestMissingFrame(upload);
+      return UPLOAD_IN_PROGRESS;
+   }
+
+   size_t payloadLength = length - UPLOAD_FRAME_HEADER_SIZE - UPLOAD_FRAME_CRC_SIZE;
+   if (readUint32(frame + length - UPLOAD_FRAME_CRC_SIZE) != calculateCrc32(0, frame, length - UPLOAD_FRAME_CRC_SIZE)) {
+      requestMissingFrame(upload);
+      return UPLOAD_IN_PROGRESS;
+   }
+
+   uint16_t sequence = readUint16(frame + 1);
+   if (sequence != upload->expectedSequence) {
+      if (sequence < upload->expectedSequence && upload->expectedSequence > 0) {
+         // the host did not receive the last acknowledgement
+         sendResponse(upload, "ACK", upload->expectedSequence - 1);
+      } else {
+         requestMissingFrame(upload);
+      }
+      return UPLOAD_IN_PROGRESS;
+   }
+
+   uint16_t argument        = readUint16(frame + 3);
+   const uint8_t *payload   = frame + UPLOAD_FRAME_HEADER_SIZE;
+   UploadStatus status;
+
+   switch (frame[0]) {
+      case UPLOAD_FRAME_TYPE_DATA:  status = processData(upload, argument, payload, payloadLength);   break;
+      case UPLOAD_FRAME_TYPE_END:   status = processEnd(upload, argument, payload, payloadLength);    break;
+      default:                      return fail(upload, UNKNOWN_FRAME_TYPE);
+   }
+   upload->expectedSequence++;
+   upload->isNakSent = false;
+   return status;
+}
+
+UploadStatus receiveUploadBytes(Upload *upload, const uint8_t *bytes, size_t byteCount, size_t *consumedByteCount) {
+   UploadStatus status = UPLOAD_IN_PROGRESS;
+   size_t index        = 0;
+
+   while (status == UPLOAD_IN_PROGRESS && index < byteCount) {
+      uint8_t byte = bytes[index++];
+      if (byte != 0) {
+         if (upload->encodedFrameLength < MAX_ENCODED_UPLOAD_FRAME_SIZE) {
+            upload->encodedFrame[upload->encodedFrameLength++] = byte;
+         } else {
+            upload->isFrameTooLong = true;
+         }
+         continue;
+      }
+
+      if (upload->isFrameTooLong) {
+         requestMissingFrame(upload);
+      } else if (upload->encodedFrameLength > 0) {
+         status = processFrame(upload);
+      }
+      upload->encodedFrameLength = 0;
+      upload->isFrameTooLong     = false;
+   }
+
+   *consumedByteCount = index;
+   return status;
+}
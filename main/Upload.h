@@ -0,0 +1,69 @@
+#ifndef assembler_upload_h
+#define assembler_upload_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FrameCodec.h"
+
+/**
+ * Binary upload protocol
+ *
+ * The host sends frames encoded with COBS and terminated by 0x00. Each decoded frame has the layout
+ *
+ *    type (1 byte) | sequence number (2 bytes) | argument (2 bytes) | payload | CRC-32 of all previous bytes (4 bytes)
+ *
+ * with all numbers in little endian. A DATA frame contains the image bytes starting at the offset in argument. The
+ * END frame contains the size of the image in argument and the CRC-32 of the whole image as payload.
+ *
+ * The receiver answers with text lines:
+ *
+ *    ACK <sequence>    all frames up to sequence got received (sent after each window of UPLOAD_WINDOW_SIZE frames)
+ *    NAK <sequence>    frame sequence is missing or damaged -> the host has to send again starting with it
+ *    DONE <size>       the image got completely received
+ *    ERROR <reason>    the upload got aborted
+ */
+#define UPLOAD_FRAME_TYPE_DATA         1
+#define UPLOAD_FRAME_TYPE_END          2
+#define UPLOAD_FRAME_HEADER_SIZE       5
+#define UPLOAD_FRAME_CRC_SIZE          4
+#define UPLOAD_END_PAYLOAD_SIZE        4
+#define MAX_UPLOAD_PAYLOAD_SIZE        128
+#define MAX_UPLOAD_FRAME_SIZE          (UPLOAD_FRAME_HEADER_SIZE + MAX_UPLOAD_PAYLOAD_SIZE + UPLOAD_FRAME_CRC_SIZE)
+#define MAX_ENCODED_UPLOAD_FRAME_SIZE  MAX_COBS_ENCODED_LENGTH(MAX_UPLOAD_FRAME_SIZE)
+#define UPLOAD_WINDOW_SIZE             8
+#define MAX_UPLOAD_RESPONSE_LENGTH     32
+
+typedef enum {
+   UPLOAD_IN_PROGRESS,
+   UPLOAD_COMPLETE,
+   UPLOAD_FAILED
+} UploadStatus;
+
+typedef struct {
+   uint8_t     *image;                 // destination of the received bytes
+   size_t      maxImageSize;
+   size_t      imageSize;              // number of bytes received in sequence
+   uint16_t    expectedSequence;
+   bool        isNakSent;              // NAK for expectedSequence got already sent
+   uint8_t     encodedFrame[MAX_ENCODED_UPLOAD_FRAME_SIZE];
+   size_t      encodedFrameLength;
+   bool        isFrameTooLong;
+   const char  *errorMessage;
+   void        *context;
+   void        (*sendResponse)(void *context, const char *response);
+} Upload;
+
+void startUpload(Upload *upload, uint8_t *image, size_t maxImageSize, void *context, void (*sendResponse)(void *context, const char *response));
+
+/**
+ * Processes received bytes and returns the state of the upload. Processing stops after the upload completed or failed
+ * -> consumedByteCount contains the number of processed bytes and the remaining ones do not belong to the upload.
+ */
+UploadStatus receiveUploadBytes(Upload *upload, const uint8_t *bytes, size_t byteCount, size_t *consumedByteCount);
+
+// Aborts the upload (e.g. because the host stopped sending) and sends an ERROR response.
+void abortUpload(Upload *upload, const char *reason);
+
+#endif
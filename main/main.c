@@ -1,46 +1,160 @@
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
-#include <regex.h>
 
+#include "sdkconfig.h"
 #include "esp_log.h"
 #include "esp_sleep.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "nvs_flash.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "soc/rtc_periph.h"
 #include "driver/rtc_io.h"
 #include "driver/uart.h"
 #include "esp32/ulp.h"
+#include "esp32/rom/ets_sys.h"
 #include "ulp_main.h"
 
 #include "StringUtils.h"
 #include "Commands.h"
+#include "Assembler.h"
+#include "Disassembler.h"
+#include "ExecutionTime.h"
+#include "CompletionDetector.h"
+#include "DirtyRanges.h"
+#include "LineReader.h"
+#include "OutputBuffer.h"
+#include "Upload.h"
+#include "Export.h"
+#include "Optimizer.h"
+#include "EncodeCache.h"
+#include "ProgramStore.h"
+#include "UlpBinary.h"
 
 #define SERIAL_PORT  UART_NUM_0
 #define MILLIS(ms)   ((ms) * 1000)
-#define LF           0x0d
-#define CR           0x0a
 
-#define ULP_PROGRAM_MAX_COMMAND_COUNT           50
-#define ULP_PROGRAM_HEADER_SIZE_IN_BYTES        12
+// The UART driver buffers at most SERIAL_DRIVER_BUFFER_SIZE bytes. The receive task moves them in bulk into a ring
+// buffer and stops the sender by XOFF when it is filled to 3/4.
+#define SERIAL_DRIVER_BUFFER_SIZE               1024
+#define SERIAL_RING_BUFFER_SIZE                 4096
+#define SERIAL_RECEIVE_TIMEOUT_IN_MILLISECONDS  100
+#define MAX_LINE_LENGTH                         255
+#define MAX_TOKEN_COUNT                         2
+#define OUTPUT_BLOCK_SIZE                       512
+#define UPLOAD_TIMEOUT_IN_MILLISECONDS          2000
+#define NVS_NAMESPACE                           "ulpPrograms"
+
+#ifdef CONFIG_ESP32_ULP_COPROC_RESERVE_MEM
+#define ULP_RESERVED_MEMORY_IN_BYTES            CONFIG_ESP32_ULP_COPROC_RESERVE_MEM
+#else
+#define ULP_RESERVED_MEMORY_IN_BYTES            CONFIG_ULP_COPROC_RESERVE_MEM
+#endif
+
+// The RTC slow memory reserved for the ULP (see sdkconfig) holds the commands and variables entered by the user followed by the halt commands and the completion marker.
 #define ULP_PROGRAM_COMMAND_SIZE_IN_BYTES       4
-#define ULP_PROGRAM_HALT_COMMANDS_COUNT         2
+#define ULP_PROGRAM_HALT_COMMANDS_COUNT         4
+#define ULP_PROGRAM_COMPLETION_MARKER_COUNT     1
+#define ULP_PROGRAM_EPILOGUE_WORD_COUNT         (ULP_PROGRAM_HALT_COMMANDS_COUNT + ULP_PROGRAM_COMPLETION_MARKER_COUNT)
+#define ULP_PROGRAM_MAX_WORD_COUNT              (ULP_RESERVED_MEMORY_IN_BYTES / ULP_PROGRAM_COMMAND_SIZE_IN_BYTES)
+#define ULP_PROGRAM_MAX_COMMAND_COUNT           (ULP_PROGRAM_MAX_WORD_COUNT - ULP_PROGRAM_EPILOGUE_WORD_COUNT)
+#define SYMBOL_CAPACITY                         64
+#define MAX_DIRTY_RANGE_COUNT                   8
+#define ENCODE_CACHE_CAPACITY                   256
+
+#if ULP_PROGRAM_MAX_WORD_COUNT <= ULP_PROGRAM_EPILOGUE_WORD_COUNT
+#error "CONFIG_ULP_COPROC_RESERVE_MEM is too small to hold a ULP program."
+#endif
+#define EXECUTION_STATE_CAPACITY                512
+#define DEFAULT_TIMEOUT_IN_MICROSECONDS         MILLIS(500)
+#define MIN_POLL_INTERVAL_IN_MICROSECONDS       10
+#define MAX_POLL_INTERVAL_IN_MICROSECONDS       MILLIS(10)
+
+// The ULP gets clocked by RTC_FAST_CLK (nominal 8.5 MHz). The lower bound takes the frequency tolerance into account
+// to never stop waiting before the ULP program finished.
+#define ULP_MIN_CLOCK_FREQUENCY_HZ              7000000
 
 // extern const uint8_t ulp_main_bin_start[] asm("_binary_ulp_main_bin_start");
 
-static uint8_t ulpProgram[ULP_PROGRAM_HEADER_SIZE_IN_BYTES + (ULP_PROGRAM_MAX_COMMAND_COUNT + ULP_PROGRAM_HALT_COMMANDS_COUNT) * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES];
+static uint8_t ulpProgram[ULP_PROGRAM_HEADER_SIZE_IN_BYTES + ULP_PROGRAM_MAX_WORD_COUNT * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES] __attribute__((aligned(4)));
+
+// The assembler writes the commands directly into ulpProgram and resolves the labels entered by the user. Pasting a
+// program again takes the encoded commands from the cache.
+static CachedCommand cachedCommands[ENCODE_CACHE_CAPACITY];
+static EncodeCache encodeCache = {cachedCommands, ENCODE_CACHE_CAPACITY, 0, 0};
+static Diagnostic diagnostics[1];
+static Symbol symbols[SYMBOL_CAPACITY];
+static Fixup fixups[ULP_PROGRAM_MAX_COMMAND_COUNT];
+static Assembler assembler = {
+   .words              = (uint32_t*)(ulpProgram + ULP_PROGRAM_HEADER_SIZE_IN_BYTES),
+   .maxWordCount       = ULP_PROGRAM_MAX_COMMAND_COUNT,
+   .diagnostics        = diagnostics,
+   .maxDiagnosticCount = 1,
+   .symbols            = symbols,
+   .symbolCapacity     = SYMBOL_CAPACITY,
+   .fixups             = fixups,
+   .maxFixupCount      = ULP_PROGRAM_MAX_COMMAND_COUNT,
+   .encodeCache        = &encodeCache
+};
 
+// The st command sets the completion marker (the word following the halt commands) to tell the CPU that the program finished (r1 gets overwritten).
 // The reg_wr command disables the ULP timer to ensure that the ULP program gets executed only once (see technical reference manual "29.5 ULP Program Execution").
-static char *HALT_COMMANDS[ULP_PROGRAM_HALT_COMMANDS_COUNT] = { "reg_wr 6, 24, 24, 0", "halt"};
+static char *HALT_COMMANDS[ULP_PROGRAM_HALT_COMMANDS_COUNT] = { "move r1, %u", "st r1, r1, 0", "reg_wr 6, 24, 24, 0", "halt"};
+static uint32_t timeoutInMicroseconds = DEFAULT_TIMEOUT_IN_MICROSECONDS;
+static ExecutionState executionStates[EXECUTION_STATE_CAPACITY];
+// Words of ulpProgram that differ from the content of RTC_SLOW_MEM -> run copies only them.
+static WordRange dirtyWordRanges[MAX_DIRTY_RANGE_COUNT];
+static DirtyRanges dirtyRanges = {dirtyWordRanges, MAX_DIRTY_RANGE_COUNT, 0};
+static uint8_t serialRingBuffer[SERIAL_RING_BUFFER_SIZE];
+static uint8_t receivedLine[MAX_LINE_LENGTH + 1];
+static LineReader lineReader;
+static TaskHandle_t commandHandlingTask;
+
+// Memory dumps and the echoes of entered commands get collected in outputBlock and sent by one uart_write_bytes call.
+static void writeOutputBlock(void *context, const uint8_t *bytes, size_t byteCount);
+static uint8_t outputBlock[OUTPUT_BLOCK_SIZE];
+static OutputBuffer output = {outputBlock, OUTPUT_BLOCK_SIZE, 0, NULL, writeOutputBlock};
+static bool isQuiet = false;
+
+// The optimizer runs before the program gets loaded. It moves the commands behind removed ones to lower indices.
+static bool isOptimizing = false;
+static size_t newIndices[ULP_PROGRAM_MAX_COMMAND_COUNT + 1];
+// Relaxing jumps moves the commands behind them -> resolveJumpTargets needs to know which jumps it relaxed and which
+// jumps got new targets.
+static bool wasRelaxed[ULP_PROGRAM_MAX_COMMAND_COUNT];
+static uint32_t previousJumpWords[ULP_PROGRAM_MAX_COMMAND_COUNT];
+
+// Binary images sent by the host tool ulpUpload get written directly into ulpProgram (see Upload.h for the protocol).
+static Upload upload;
+static uint8_t uploadBytes[MAX_ENCODED_UPLOAD_FRAME_SIZE];
+
+// save, load and autorun keep programs in the NVS flash (see ProgramStore.h). The index of the first command of the last
+// run gets saved together with the program.
+static nvs_handle_t nvsHandle;
+static bool writeBlobToNvs(void *context, const char *key, const void *bytes, size_t byteCount);
+static bool readBlobFromNvs(void *context, const char *key, void *bytes, size_t maxByteCount, size_t *byteCount);
+static const ProgramStorage nvsStorage = {&nvsHandle, writeBlobToNvs, readBlobFromNvs};
+static size_t lastIndexOfFirstCommand = 0;
+
+// Console commands (in contrast to ULP commands) flush the collected echoes before printing their output.
+static const char *CONSOLE_COMMANDS[] = {"", "help", "list", "mem", "reset", "quiet on", "quiet off", "optimize on", "optimize off", "upload", "autorun off"};
+static const char *CONSOLE_COMMANDS_WITH_NUMBER[] = {"run ", "timeout ", "save ", "load ", "autorun "};
+static const char EXPORT_COMMAND[] = "export ";
+
 static size_t nextCommandIndex = 0;
+static size_t variableCount = 0;
 static bool userEnteredNewCommands = false;
 
+static void writeUlpBinaryHeader(const uint8_t *program, size_t textWordCount);
 static void appendHaltCommandsToUlpProgram(const uint8_t *program);
 static void loadUlpProgram(const uint8_t *program);
 static void startUlpProgram(size_t indexOfFirstCommand);
 static void initSerialInterface();
 static void handleCommands(void *parameters);
-static void processNextLine(const uint8_t *line);
+static void receiveFromSerialInterface(void *parameters);
+static void processNextLine(uint8_t *line, size_t lineLength);
 static void printCommands(const uint8_t *firstByteOfFirstCommand, size_t commandCount);
 static void printUlpProgram(const uint8_t *programStart);
 static void printRtcSlowMemory();
@@ -48,18 +162,27 @@ static void initializeUlpProgram();
 static void setBytesInUlpProgram(size_t commandIndex, CommandBytes *commandBytes);
 static void createVariable(const char *command);
 static void createCommand(const char *command);
-static bool runProgram(const char *command);
+static bool runProgram(const TokenView *indexToken, uint32_t *waitTimeInMicroseconds);
+static uint32_t getWaitTimeInMicroseconds(size_t indexOfFirstCommand);
+static void waitForUlpProgram(uint32_t waitTimeInMicroseconds);
+static void setTimeout(const TokenView *millisecondsToken);
+static void printMemoryUsage();
+static void uploadProgram();
+static bool applyImage(size_t imageSize);
+static void initStorage();
+static void saveToSlot(const TokenView *slotToken);
+static void loadFromSlot(const TokenView *slotToken);
+static bool restoreFromSlot(uint32_t slot);
+static void setAutorun(uint32_t slot);
+static void startAutorunProgram();
+static void printStoreError(StoreStatus status, uint32_t slot);
+static void exportProgram(const char *command);
+static bool resolveJumpTargets(size_t *indexOfFirstCommand);
+static void optimizeUlpProgram(size_t *indexOfFirstCommand);
 static void printHelp();
-static bool regexMatches(const char *text, const char *pattern);
-
-// ULP program binary according to https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-guides/ulp.html?highlight=ulp%20magic#_CPPv415ulp_load_binary8uint32_tPK7uint8_t6size_t
-struct UlpBinary {
-   uint32_t magic;
-   uint16_t textOffset;
-   uint16_t textSize;
-   uint16_t dataSize;
-   uint16_t bssSize;
-};
+static bool isNumberEnclosedBy(const char *text, const char *prefix, const char *suffix);
+static uint32_t toNumber(const TokenView *token);
+static bool isConsoleCommand(const char *line);
 
 struct Command {
    char* pattern;
@@ -70,14 +193,16 @@ void app_main()
 {
    //printUlpProgram(ulp_main_bin_start);
    initializeUlpProgram();
+   initStorage();
+   startAutorunProgram();
    xTaskCreate(handleCommands, "handle commands from serial interface", 4000, NULL, 10, NULL);
 }
 
 static void initializeUlpProgram() {
    printf("Initializing ULP program ...\n");
    struct UlpBinary* metaData = (struct UlpBinary*)ulpProgram;
-   metaData->magic       = 0x00706c75;
-   metaData->textOffset  = 12;
+   metaData->magic       = ULP_BINARY_MAGIC;
+   metaData->textOffset  = ULP_PROGRAM_HEADER_SIZE_IN_BYTES;
    metaData->textSize    = 0;
    metaData->dataSize    = 0;
    metaData->bssSize     = 0;
@@ -88,31 +213,63 @@ static void initializeUlpProgram() {
       setBytesInUlpProgram(commandIndex, &(noopCommand.commandBytes));
    }
 
+   // the content of RTC_SLOW_MEM is unknown -> the next run needs to copy everything
+   clearDirtyRanges(&dirtyRanges);
+   markDirty(&dirtyRanges, 0, ULP_PROGRAM_MAX_WORD_COUNT);
+
+   resetAssembler(&assembler);
    nextCommandIndex = 0; 
+   variableCount = 0;
+   lastIndexOfFirstCommand = 0;
    userEnteredNewCommands = false;     
 }
 
-static void appendHaltCommandsToUlpProgram(const uint8_t *program) {
+static void writeUlpBinaryHeader(const uint8_t *program, size_t textWordCount) {
    struct UlpBinary* metaData = (struct UlpBinary*)program;
-   metaData->magic      = 0x00706c75;
-   metaData->textOffset = 12;
-   metaData->textSize   = (nextCommandIndex + ULP_PROGRAM_HALT_COMMANDS_COUNT) * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+   metaData->magic      = ULP_BINARY_MAGIC;
+   metaData->textOffset = ULP_PROGRAM_HEADER_SIZE_IN_BYTES;
+   metaData->textSize   = textWordCount * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
    metaData->dataSize   = 0;
    metaData->bssSize    = 0;
+}
+
+static void appendHaltCommandsToUlpProgram(const uint8_t *program) {
+   writeUlpBinaryHeader(program, nextCommandIndex + ULP_PROGRAM_EPILOGUE_WORD_COUNT);
 
    size_t commandIndexOfFirstHaltCommand = nextCommandIndex;
+   size_t completionMarkerIndex          = nextCommandIndex + ULP_PROGRAM_HALT_COMMANDS_COUNT;
+   char haltCommand[32];
 
    for(size_t index = 0; index < ULP_PROGRAM_HALT_COMMANDS_COUNT; index++) {
-      Result command = getCommandBytesFor((uint8_t*)HALT_COMMANDS[index]);
+      snprintf(haltCommand, sizeof(haltCommand), HALT_COMMANDS[index], completionMarkerIndex);
+      Result command = getCommandBytesFor((uint8_t*)haltCommand);
       setBytesInUlpProgram(commandIndexOfFirstHaltCommand + index, &command.commandBytes);
    }
+
+   CommandBytes clearedMarker = {0, 0, 0, 0};
+   setBytesInUlpProgram(completionMarkerIndex, &clearedMarker);
 }
 
+// Copies only the modified words into RTC_SLOW_MEM (like ulp_load_binary with load address 0 would do) to keep the re-run
+// latency low and to not overwrite variables modified by the CPUs or the ULP in the meantime.
 static void loadUlpProgram(const uint8_t *program) {
-   printf("Loading your program into RTC memory ...\n");
-   struct UlpBinary* metaData = (struct UlpBinary*)program;
-   uint32_t programSizeInBytes = ULP_PROGRAM_HEADER_SIZE_IN_BYTES + metaData->textSize + metaData->dataSize + metaData->bssSize;
-   ESP_ERROR_CHECK(ulp_load_binary(0, program, programSizeInBytes / sizeof(uint32_t)));
+   const uint32_t *words = (const uint32_t*)(program + ULP_PROGRAM_HEADER_SIZE_IN_BYTES);
+
+   if (dirtyRanges.rangeCount == 0) {
+      printf("Your program did not change -> no need to load it into RTC memory.\n");
+   } else {
+      printf("Loading %u changed words of your program into RTC memory ...\n", getDirtyWordCount(&dirtyRanges));
+   }
+
+   for (size_t index = 0; index < dirtyRanges.rangeCount; index++) {
+      for (size_t wordIndex = dirtyWordRanges[index].firstWord; wordIndex < dirtyWordRanges[index].endWord; wordIndex++) {
+         RTC_SLOW_MEM[wordIndex] = words[wordIndex];
+      }
+   }
+   clearDirtyRanges(&dirtyRanges);
+
+   // the previous run set the completion marker
+   RTC_SLOW_MEM[nextCommandIndex + ULP_PROGRAM_HALT_COMMANDS_COUNT] = 0;
 }
 
 static void startUlpProgram(size_t indexOfFirstCommand)
@@ -133,35 +290,61 @@ static void initSerialInterface() {
    ESP_ERROR_CHECK(uart_param_config(SERIAL_PORT, &uart_config));
    // Set pins for UART0 (TX: IO4, RX: IO5, RTS: IO18, CTS: IO19)
    ESP_ERROR_CHECK(uart_set_pin(SERIAL_PORT, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
-   ESP_ERROR_CHECK(uart_driver_install(SERIAL_PORT, 1024, 0, 0, NULL, 0));
+   ESP_ERROR_CHECK(uart_driver_install(SERIAL_PORT, SERIAL_DRIVER_BUFFER_SIZE, 0, 0, NULL, 0));
+}
+
+static size_t readFromSerialInterface(void *context, uint8_t *buffer, size_t maxByteCount, uint32_t timeoutInMilliseconds) {
+   size_t bufferedByteCount = 0;
+   ESP_ERROR_CHECK(uart_get_buffered_data_len(SERIAL_PORT, &bufferedByteCount));
+
+   // uart_read_bytes waits till it got all requested bytes -> wait only for the first one
+   size_t byteCount = bufferedByteCount < maxByteCount ? bufferedByteCount : maxByteCount;
+   int readBytes    = (byteCount == 0) ? uart_read_bytes(SERIAL_PORT, buffer, 1, timeoutInMilliseconds / portTICK_PERIOD_MS)
+                                       : uart_read_bytes(SERIAL_PORT, buffer, byteCount, 0);
+   return readBytes > 0 ? readBytes : 0;
+}
+
+static void writeToSerialInterface(void *context, const uint8_t *bytes, size_t byteCount) {
+   uart_write_bytes(SERIAL_PORT, (const char*)bytes, byteCount);
+}
+
+static const ByteStream serialInterface = {NULL, readFromSerialInterface, writeToSerialInterface};
+
+static void writeOutputBlock(void *context, const uint8_t *bytes, size_t byteCount) {
+   // the text already passed to printf needs to appear first
+   fflush(stdout);
+   uart_write_bytes(SERIAL_PORT, (const char*)bytes, byteCount);
+}
+
+// Runs with a higher priority than handleCommands to drain the UART driver buffer while commands get processed.
+static void receiveFromSerialInterface(void *parameters) {
+   while (true) {
+      if (receiveBytes(&lineReader, SERIAL_RECEIVE_TIMEOUT_IN_MILLISECONDS) > 0) {
+         xTaskNotifyGive(commandHandlingTask);
+      } else {
+         vTaskDelay(1);
+      }
+   }
 }
 
 static void handleCommands(void *parameters) {
-   size_t readBytes;
-   uint8_t buffer[2];
-   size_t maxLineLength = 40;
-   uint8_t line[maxLineLength + 1];
-   size_t insertationPosition = 0;
-   
+   LineStatus status;
+
    vTaskDelay(100 / portTICK_PERIOD_MS);
    initSerialInterface();
+   initializeLineReader(&lineReader, &serialInterface, serialRingBuffer, SERIAL_RING_BUFFER_SIZE, receivedLine, MAX_LINE_LENGTH);
+   commandHandlingTask = xTaskGetCurrentTaskHandle();
+   xTaskCreate(receiveFromSerialInterface, "receive from serial interface", 2000, NULL, 11, NULL);
    
    while (true) {
-      readBytes = uart_read_bytes(SERIAL_PORT, buffer, 1, 1000 / portTICK_PERIOD_MS);
-      if (readBytes > 0) {
-         if (buffer[0] != LF) {
-            line[insertationPosition++] = buffer[0];
-         } else {
-            line[insertationPosition] = 0;
-            processNextLine(line);
-            insertationPosition = 0;
-         }
-
-         if (insertationPosition == maxLineLength) {
-            line[maxLineLength] = 0;
-            printf("ERROR: Maximum line length (%d) reached -> ignoring \"%s\".\n", maxLineLength, line);
-            insertationPosition = 0;
-         }
+      if (!getNextLine(&lineReader, &status)) {
+         flushOutput(&output);
+         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      } else if (status == LINE_TOO_LONG) {
+         flushOutput(&output);
+         printf("ERROR: Maximum line length (%d) reached -> ignoring \"%s...\".\n", MAX_LINE_LENGTH, receivedLine);
+      } else {
+         processNextLine(receivedLine, lineReader.lineLength);
       }
    }
    
@@ -170,41 +353,85 @@ static void handleCommands(void *parameters) {
 
 static void printHelp() {
    printf("\nIn addition to the ULP instructions (see https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-guides/ulp_instruction_set.html), the following commands are supported:\n\n");
+   printf("<label>:                    defines a label for the current command index (e.g. \"loop: add r0, r0, 1\"),\n");
+   printf("                            labels can be used as target of jump, jumpr and jumps (e.g. \"jumpr loop, 5, lt\")\n");
    printf("var(<value>)                stores <value> at the current command index\n");
-   printf("run <indexOfFirstCommand>   executes your program and displays the memory used by it\n");
+   printf("run <indexOfFirstCommand>   executes your program and displays the memory used by it as soon as it finished\n");
+   printf("timeout <milliseconds>      maximum time to wait for the end of programs with unknown execution time (default: %d)\n", DEFAULT_TIMEOUT_IN_MICROSECONDS / 1000);
    printf("list                        displays the memory used by your program\n");
+   printf("optimize on|off             optimize on removes needless commands (e.g. nop) before run loads your program\n");
+   printf("quiet on|off                quiet on suppresses the echo of entered commands and variables (e.g. while pasting)\n");
+   printf("mem                         displays the number of used and free words of the RTC slow memory reserved for the ULP\n");
+   printf("                            and the hits and misses of the cache of encoded commands\n");
+   printf("export bin|hex|c            prints your program as binary (Base64 encoded), Intel HEX or C array (e.g. to embed it\n");
+   printf("                            into your firmware)\n");
+   printf("upload                      receives a binary program sent by the host tool ulpUpload (replaces your program)\n");
+   printf("save <slot>                 stores your program and the index of the first command of the last run in the\n");
+   printf("                            NVS flash (slots 0 - %d)\n", PROGRAM_SLOT_COUNT - 1);
+   printf("load <slot>                 replaces your program with the one stored in the slot\n");
+   printf("autorun <slot>|off          starts the program stored in the slot after each boot\n");
    printf("reset                       removes all alreay entered commands\n\n");
    printf("For further details visit https://github.com/tederer/esp32-assembler.\n\n");
 }
 
-static void processNextLine(const uint8_t *line) {
-   size_t lineLength = strlen((const char*)line);
-   uint8_t copyOfLine[lineLength];
-   strcpy((char*)copyOfLine, (char*)line);
-   char *trimmedLineInLowerCase = (char*)toLowerCase(trim(copyOfLine));
+// The line gets normalized in place (see StringUtils.h) -> it does not get copied.
+static void processNextLine(uint8_t *line, size_t lineLength) {
+   TokenView tokens[MAX_TOKEN_COUNT];
+   normalizeLine(line, lineLength, tokens, MAX_TOKEN_COUNT, NULL);
+   const char *normalizedLine = (const char*)line;
 
-   if (regexMatches(trimmedLineInLowerCase, "run [0-9]+")) {
-      if (runProgram(trimmedLineInLowerCase)) {
+   if (isConsoleCommand(normalizedLine)) {
+      flushOutput(&output);
+   }
+
+   if (isNumberEnclosedBy(normalizedLine, "run ", "")) {
+      uint32_t waitTimeInMicroseconds;
+      if (runProgram(&tokens[1], &waitTimeInMicroseconds)) {
          userEnteredNewCommands = false; 
-         vTaskDelay(500 / portTICK_PERIOD_MS);
+         waitForUlpProgram(waitTimeInMicroseconds);
          printRtcSlowMemory();
       }
-   } else if (strcmp(trimmedLineInLowerCase, "list") == 0) {
+   } else if (isNumberEnclosedBy(normalizedLine, "timeout ", "")) {
+      setTimeout(&tokens[1]);
+   } else if (strcmp(normalizedLine, "mem") == 0) {
+      printMemoryUsage();
+   } else if (strcmp(normalizedLine, "upload") == 0) {
+      uploadProgram();
+   } else if (isNumberEnclosedBy(normalizedLine, "save ", "")) {
+      saveToSlot(&tokens[1]);
+   } else if (isNumberEnclosedBy(normalizedLine, "load ", "")) {
+      loadFromSlot(&tokens[1]);
+   } else if (isNumberEnclosedBy(normalizedLine, "autorun ", "")) {
+      setAutorun(toNumber(&tokens[1]));
+   } else if (strcmp(normalizedLine, "autorun off") == 0) {
+      setAutorun(NO_AUTORUN_SLOT);
+   } else if (strncmp(normalizedLine, EXPORT_COMMAND, strlen(EXPORT_COMMAND)) == 0) {
+      exportProgram(normalizedLine);
+   } else if (strcmp(normalizedLine, "list") == 0) {
       printRtcSlowMemory();  
-   } else if (strcmp(trimmedLineInLowerCase, "reset") == 0) {
+   } else if (strcmp(normalizedLine, "reset") == 0) {
       initializeUlpProgram();
-   } else if ((strcmp(trimmedLineInLowerCase, "help") == 0) || (strlen(trimmedLineInLowerCase) == 0)) {
+   } else if ((strcmp(normalizedLine, "quiet on") == 0) || (strcmp(normalizedLine, "quiet off") == 0)) {
+      isQuiet = strcmp(normalizedLine, "quiet on") == 0;
+   } else if ((strcmp(normalizedLine, "optimize on") == 0) || (strcmp(normalizedLine, "optimize off") == 0)) {
+      isOptimizing = strcmp(normalizedLine, "optimize on") == 0;
+   } else if ((strcmp(normalizedLine, "help") == 0) || (strlen(normalizedLine) == 0)) {
       printHelp(); 
-   } else if (regexMatches(trimmedLineInLowerCase, "var\\([0-9]+\\)")) {
-      createVariable(trimmedLineInLowerCase);
+   } else if (isNumberEnclosedBy(normalizedLine, "var(", ")")) {
+      createVariable(normalizedLine);
    } else {
-      createCommand(trimmedLineInLowerCase);
+      createCommand(normalizedLine);
    }
 }
 
 static void setBytesInUlpProgram(size_t commandIndex, CommandBytes *commandBytes) {
    size_t indexOfFirstByte = ULP_PROGRAM_HEADER_SIZE_IN_BYTES + (commandIndex * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES);
 
+   CommandBytes *currentBytes = (CommandBytes*)(ulpProgram + indexOfFirstByte);
+   if (memcmp(currentBytes, commandBytes, sizeof(CommandBytes)) != 0) {
+      markDirty(&dirtyRanges, commandIndex, 1);
+   }
+
    ulpProgram[indexOfFirstByte + 0] = commandBytes->byte0;
    ulpProgram[indexOfFirstByte + 1] = commandBytes->byte1;
    ulpProgram[indexOfFirstByte + 2] = commandBytes->byte2;
@@ -212,16 +439,25 @@ static void setBytesInUlpProgram(size_t commandIndex, CommandBytes *commandBytes
 }
 
 static void printCommands(const uint8_t *firstByteOfFirstCommand, size_t commandCount) {
-   char command[50];
+   char text[MAX_DISASSEMBLED_COMMAND_LENGTH];
    
-   printf("\nmemory dump:\n\n");
-   printf("     byte3  byte2  byte1  byte0\n");
+   appendText(&output, "\nmemory dump:\n\n");
+   appendText(&output, "     byte3  byte2  byte1  byte0  command\n");
    for (size_t commandIndex = 0; commandIndex < commandCount; commandIndex++) {
-      uint8_t *firstByteOfCommand = firstByteOfFirstCommand + (commandIndex * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES);
-      sprintf(command, "%2d:     %02x     %02x     %02x     %02x", commandIndex, *(firstByteOfCommand + 3), *(firstByteOfCommand + 2), *(firstByteOfCommand + 1), *(firstByteOfCommand));
-      printf("%s\n", command);
+      const uint8_t *firstByteOfCommand = firstByteOfFirstCommand + (commandIndex * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES);
+      uint32_t word = firstByteOfCommand[0] | (firstByteOfCommand[1] << 8) | (firstByteOfCommand[2] << 16) | ((uint32_t)firstByteOfCommand[3] << 24);
+      disassemble(word, text);
+      appendDecimal(&output, commandIndex, 2);
+      for (int byteIndex = 3; byteIndex >= 0; byteIndex--) {
+         appendText(&output, byteIndex == 3 ? ":     " : "     ");
+         appendHexByte(&output, firstByteOfCommand[byteIndex]);
+      }
+      appendText(&output, "  ");
+      appendText(&output, text);
+      appendText(&output, "\n");
    }
-   printf("\n");
+   appendText(&output, "\n");
+   flushOutput(&output);
 }
 
 static void printUlpProgram(const uint8_t *programStart) {
@@ -235,6 +471,225 @@ static void printUlpProgram(const uint8_t *programStart) {
    printCommands(programStart + ulpBinary->textOffset, ulpBinary->textSize);
 }
 
+static void printMemoryUsage() {
+   size_t commandWordCount = nextCommandIndex - variableCount;
+   size_t freeWordCount    = ULP_PROGRAM_MAX_COMMAND_COUNT - nextCommandIndex;
+
+   printf("RTC slow memory reserved for the ULP: %d bytes (%d words)\n", ULP_RESERVED_MEMORY_IN_BYTES, ULP_PROGRAM_MAX_WORD_COUNT);
+   printf("   commands:  %5u words\n", commandWordCount);
+   printf("   variables: %5u words\n", variableCount);
+   printf("   epilogue:  %5u words (halt commands and completion marker appended by run)\n", ULP_PROGRAM_EPILOGUE_WORD_COUNT);
+   printf("   free:      %5u words\n", freeWordCount);
+   printf("encode cache: %u hits, %u misses (%u entries)\n", encodeCache.hitCount, encodeCache.missCount, ENCODE_CACHE_CAPACITY);
+}
+
+static void sendUploadResponse(void *context, const char *response) {
+   fflush(stdout);
+   uart_write_bytes(SERIAL_PORT, response, strlen(response));
+}
+
+// Receives frames till the upload completed or failed. Bytes sent by the host after the END frame get dropped because
+// the host waits for the DONE response before it continues.
+static void uploadProgram() {
+   size_t maxImageSize = ULP_PROGRAM_HEADER_SIZE_IN_BYTES + ULP_PROGRAM_MAX_COMMAND_COUNT * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+   UploadStatus status = UPLOAD_IN_PROGRESS;
+
+   startUpload(&upload, ulpProgram, maxImageSize, NULL, sendUploadResponse);
+   sendUploadResponse(NULL, "READY\n");
+
+   while (status == UPLOAD_IN_PROGRESS) {
+      size_t byteCount = takeBytes(&lineReader, uploadBytes, sizeof(uploadBytes));
+      if (byteCount > 0) {
+         size_t consumedByteCount;
+         status = receiveUploadBytes(&upload, uploadBytes, byteCount, &consumedByteCount);
+      } else if (ulTaskNotifyTake(pdTRUE, UPLOAD_TIMEOUT_IN_MILLISECONDS / portTICK_PERIOD_MS) == 0) {
+         abortUpload(&upload, "timeout");
+         status = UPLOAD_FAILED;
+      }
+   }
+
+   if (status == UPLOAD_FAILED || !applyImage(upload.imageSize)) {
+      if (status == UPLOAD_FAILED) {
+         printf("ERROR: The upload failed (%s).\n", upload.errorMessage);
+      }
+      // the image might have overwritten parts of the previous program
+      initializeUlpProgram();
+   } else {
+      printf("Uploaded %u commands and %u variables.\n", nextCommandIndex - variableCount, variableCount);
+   }
+}
+
+// Takes over the image written into ulpProgram (a binary as written by ulpAssembler). Returns false if it is invalid.
+static bool applyImage(size_t imageSize) {
+   struct UlpBinary *metaData = (struct UlpBinary*)ulpProgram;
+   size_t wordCount           = (metaData->textSize + metaData->dataSize) / ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+   size_t bssWordCount        = metaData->bssSize / ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+
+   if (imageSize < ULP_PROGRAM_HEADER_SIZE_IN_BYTES || metaData->magic != ULP_BINARY_MAGIC || metaData->textOffset != ULP_PROGRAM_HEADER_SIZE_IN_BYTES ||
+       metaData->textSize % ULP_PROGRAM_COMMAND_SIZE_IN_BYTES != 0 || metaData->dataSize % ULP_PROGRAM_COMMAND_SIZE_IN_BYTES != 0 ||
+       imageSize != ULP_PROGRAM_HEADER_SIZE_IN_BYTES + metaData->textSize + metaData->dataSize) {
+      printf("ERROR: The image is not a valid ULP binary.\n");
+      return false;
+   }
+   if (wordCount + bssWordCount > ULP_PROGRAM_MAX_COMMAND_COUNT) {
+      printf("ERROR: The program does not fit into the provided memory (max. %d words, see \"mem\").\n", ULP_PROGRAM_MAX_COMMAND_COUNT);
+      return false;
+   }
+
+   // the labels of the previous program do not belong to the image
+   resetAssembler(&assembler);
+   markDirty(&dirtyRanges, 0, wordCount);
+
+   CommandBytes zero = {0, 0, 0, 0};
+   for (size_t index = 0; index < bssWordCount; index++) {
+      setBytesInUlpProgram(wordCount + index, &zero);
+   }
+
+   nextCommandIndex        = wordCount + bssWordCount;
+   variableCount           = (metaData->dataSize / ULP_PROGRAM_COMMAND_SIZE_IN_BYTES) + bssWordCount;
+   lastIndexOfFirstCommand = 0;
+   userEnteredNewCommands  = true;
+   return true;
+}
+
+static bool writeBlobToNvs(void *context, const char *key, const void *bytes, size_t byteCount) {
+   nvs_handle_t handle = *(nvs_handle_t*)context;
+   return nvs_set_blob(handle, key, bytes, byteCount) == ESP_OK && nvs_commit(handle) == ESP_OK;
+}
+
+static bool readBlobFromNvs(void *context, const char *key, void *bytes, size_t maxByteCount, size_t *byteCount) {
+   *byteCount = maxByteCount;
+   return nvs_get_blob(*(nvs_handle_t*)context, key, bytes, byteCount) == ESP_OK;
+}
+
+static void initStorage() {
+   esp_err_t result = nvs_flash_init();
+   if (result == ESP_ERR_NVS_NO_FREE_PAGES || result == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+      // the partition got truncated or written by a newer NVS version -> it needs to get erased
+      ESP_ERROR_CHECK(nvs_flash_erase());
+      result = nvs_flash_init();
+   }
+   if (result != ESP_OK || nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvsHandle) != ESP_OK) {
+      printf("WARNING: The NVS flash is not available -> save, load and autorun will fail.\n");
+   }
+}
+
+// Stores the entered program like export does (without the epilogue appended by run).
+static void saveToSlot(const TokenView *slotToken) {
+   uint32_t slot              = toNumber(slotToken);
+   size_t indexOfFirstCommand = lastIndexOfFirstCommand < nextCommandIndex ? lastIndexOfFirstCommand : 0;
+
+   if (nextCommandIndex == 0) {
+      printf("ERROR: You need to enter at least one command before calling \"save\".\n");
+   } else if (resolveJumpTargets(&indexOfFirstCommand)) {
+      StoredProgram program = {0, indexOfFirstCommand, nextCommandIndex, variableCount, 0, 0};
+      writeUlpBinaryHeader(ulpProgram, nextCommandIndex);
+
+      StoreStatus status = saveProgram(&nvsStorage, slot, ulpProgram, &program);
+      if (status == STORE_DONE) {
+         lastIndexOfFirstCommand = indexOfFirstCommand;
+         printf("Saved %u words in slot %u (first command: %u, CRC-32: 0x%08x).\n", nextCommandIndex, slot, indexOfFirstCommand, program.crc);
+      } else {
+         printStoreError(status, slot);
+      }
+   }
+}
+
+static void loadFromSlot(const TokenView *slotToken) {
+   if (restoreFromSlot(toNumber(slotToken))) {
+      printf("Enter \"run %u\" to start it.\n", lastIndexOfFirstCommand);
+   }
+}
+
+// Replaces the entered program with the one stored in slot. Returns false if it could not be loaded.
+static bool restoreFromSlot(uint32_t slot) {
+   size_t maxImageSize = ULP_PROGRAM_HEADER_SIZE_IN_BYTES + ULP_PROGRAM_MAX_COMMAND_COUNT * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+   StoredProgram program;
+   StoreStatus status  = loadProgram(&nvsStorage, slot, ulpProgram, maxImageSize, &program);
+
+   if (status != STORE_DONE) {
+      printStoreError(status, slot);
+      if (status == STORE_CORRUPTED) {
+         // the image might have overwritten parts of the previous program
+         initializeUlpProgram();
+      }
+      return false;
+   }
+   if (!applyImage(ULP_PROGRAM_HEADER_SIZE_IN_BYTES + program.wordCount * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES)) {
+      initializeUlpProgram();
+      return false;
+   }
+   variableCount           = program.variableCount;
+   lastIndexOfFirstCommand = program.entryIndex;
+   printf("Loaded %u commands and %u variables from slot %u.\n", nextCommandIndex - variableCount, variableCount, slot);
+   return true;
+}
+
+static void setAutorun(uint32_t slot) {
+   StoreStatus status = setAutorunSlot(&nvsStorage, slot);
+
+   if (status != STORE_DONE) {
+      printStoreError(status, slot);
+   } else if (slot == NO_AUTORUN_SLOT) {
+      printf("autorun = off\n");
+   } else {
+      printf("autorun = slot %u (the program gets started after each boot)\n", slot);
+   }
+}
+
+// Starts the program of the autorun slot before the serial interface gets initialized -> it runs a few milliseconds after
+// boot. It gets executed once like run does it, but without waiting for its end.
+static void startAutorunProgram() {
+   uint32_t slot = getAutorunSlot(&nvsStorage);
+
+   if (slot != NO_AUTORUN_SLOT && restoreFromSlot(slot)) {
+      appendHaltCommandsToUlpProgram(ulpProgram);
+      loadUlpProgram(ulpProgram);
+      startUlpProgram(lastIndexOfFirstCommand);
+      userEnteredNewCommands = false;
+   }
+}
+
+static void printStoreError(StoreStatus status, uint32_t slot) {
+   switch (status) {
+      case STORE_INVALID_SLOT:
+         printf("ERROR: The slot needs to be in the range [0, %d].\n", PROGRAM_SLOT_COUNT - 1);
+         break;
+      case STORE_EMPTY_SLOT:
+         printf("ERROR: Slot %u does not contain a program.\n", slot);
+         break;
+      case STORE_CORRUPTED:
+         printf("ERROR: The program in slot %u is corrupted (save it again).\n", slot);
+         break;
+      case STORE_TOO_LARGE:
+         printf("ERROR: The program in slot %u does not fit into the provided memory (max. %d words, see \"mem\").\n", slot, ULP_PROGRAM_MAX_COMMAND_COUNT);
+         break;
+      case STORE_WRITE_FAILED:
+         printf("ERROR: Writing to the NVS flash failed (it might be full).\n");
+         break;
+      case STORE_DONE:
+         break;
+   }
+}
+
+// Prints the entered commands and variables (without the epilogue appended by run) as a ULP binary. Firmware can load it
+// with ulp_load_binary like the binaries built by the IDF.
+static void exportProgram(const char *command) {
+   ExportFormat format;
+   size_t indexOfFirstCommand = 0;
+
+   if (!parseExportFormat(command + strlen(EXPORT_COMMAND), &format)) {
+      printf("ERROR: Unknown export format (supported: bin, hex and c).\n");
+   } else if (nextCommandIndex == 0) {
+      printf("ERROR: You need to enter at least one command before calling \"export\".\n");
+   } else if (resolveJumpTargets(&indexOfFirstCommand)) {
+      size_t imageSize = ULP_PROGRAM_HEADER_SIZE_IN_BYTES + nextCommandIndex * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+      writeUlpBinaryHeader(ulpProgram, nextCommandIndex);
+      printf("Exporting %u bytes ...\n", imageSize);
+      exportImage(&output, ulpProgram, imageSize, format);
+   }
+}
+
 static void printRtcSlowMemory() {
    size_t commandCount = nextCommandIndex;
 
@@ -251,30 +706,55 @@ static void printRtcSlowMemory() {
    printCommands((uint8_t*)RTC_SLOW_MEM, commandCount);
 }
 
-static bool regexMatches(const char *text, const char *pattern) {
-   bool matches = false;
-   regex_t regex;
-   char strictMatchingPattern[strlen(pattern) + 2];
-   sprintf(strictMatchingPattern, "^%s$", pattern);
-   if(regcomp(&regex, strictMatchingPattern, REG_EXTENDED) != 0) {
-      printf("ERROR: Failed to compile regex pattern \"%s\".\n", pattern);
-   } else {
-      int result = regexec(&regex, text, 0, NULL, 0);
-      regfree(&regex);
-      matches = result == 0;
+static bool isConsoleCommand(const char *line) {
+   if (strncmp(line, EXPORT_COMMAND, strlen(EXPORT_COMMAND)) == 0) {
+      return true;
+   }
+   for (size_t index = 0; index < sizeof(CONSOLE_COMMANDS) / sizeof(CONSOLE_COMMANDS[0]); index++) {
+      if (strcmp(line, CONSOLE_COMMANDS[index]) == 0) {
+         return true;
+      }
+   }
+   for (size_t index = 0; index < sizeof(CONSOLE_COMMANDS_WITH_NUMBER) / sizeof(CONSOLE_COMMANDS_WITH_NUMBER[0]); index++) {
+      if (isNumberEnclosedBy(line, CONSOLE_COMMANDS_WITH_NUMBER[index], "")) {
+         return true;
+      }
    }
-   return matches;
+   return false;
+}
+
+// Returns true if text consists of the prefix, followed by at least one decimal digit and the suffix.
+static bool isNumberEnclosedBy(const char *text, const char *prefix, const char *suffix) {
+   size_t prefixLength = strlen(prefix);
+   if (strncmp(text, prefix, prefixLength) != 0) {
+      return false;
+   }
+   const char *digits = text + prefixLength;
+   const char *end    = digits;
+   while (*end >= '0' && *end <= '9') {
+      end++;
+   }
+   return end > digits && strcmp(end, suffix) == 0;
+}
+
+// Converts a token consisting of decimal digits (checked by isNumberEnclosedBy) without copying it.
+static uint32_t toNumber(const TokenView *token) {
+   uint32_t number = 0;
+   for (size_t index = 0; index < token->length; index++) {
+      number = number * 10 + (token->start[index] - '0');
+   }
+   return number;
 }
 
 static void createVariable(const char *command) {
-   char copyOfCommand[strlen(command)];
-   strcpy(copyOfCommand, command);
-   strtok((char*)copyOfCommand, "(");
-   char *valueStart = strtok(NULL, "(");
-   uint32_t value = atoi(strtok(valueStart, ")"));
+   uint32_t value = atoi(command + strlen("var("));
    
    if(value > 65535) {
-      printf("ERROR: the value is too high for 16 bit (max: 65535).\n");
+      appendText(&output, "ERROR: the value is too high for 16 bit (max: 65535).\n");
+   } else if (nextCommandIndex >= ULP_PROGRAM_MAX_COMMAND_COUNT) {
+      appendText(&output, "ERROR: The program does not fit into the provided memory (max. ");
+      appendDecimal(&output, ULP_PROGRAM_MAX_COMMAND_COUNT, 0);
+      appendText(&output, " words, see \"mem\").\n");
    } else {
       uint8_t byte0 = (value & 0x00ff);
       uint8_t byte1 = (value & 0xff00) >> 8;
@@ -283,35 +763,119 @@ static void createVariable(const char *command) {
       CommandBytes commandBytes = {byte0, byte1, byte2, byte3};
 
       size_t commandIndex = nextCommandIndex++;
+      variableCount++;
       setBytesInUlpProgram(commandIndex, &commandBytes);
-      printf("%u: variable (value = %d)\n", commandIndex, value);
+      if (!isQuiet) {
+         appendDecimal(&output, commandIndex, 0);
+         appendText(&output, ": variable (value = ");
+         appendDecimal(&output, value, 0);
+         appendText(&output, ")\n");
+      }
       userEnteredNewCommands = true; 
    }
 }
 
 static void createCommand(const char *command) {
-   Result result = getCommandBytesFor((uint8_t*)command);
-
-   if (result.errorMessage != NULL) {
-      printf("ERROR: %s (input=\"%s\")\n", result.errorMessage, command);
+   // variables do not pass the assembler -> it needs to continue at the current command index
+   assembler.wordCount       = nextCommandIndex;
+   assembler.diagnosticCount = 0;
+
+   if (!assembleLine(&assembler, (const uint8_t*)command, strlen(command))) {
+      appendText(&output, "ERROR: ");
+      appendText(&output, diagnostics[0].errorMessage);
+      appendText(&output, " (input=\"");
+      appendText(&output, command);
+      appendText(&output, "\")\n");
    } else {
-      if (nextCommandIndex >= ULP_PROGRAM_MAX_COMMAND_COUNT) {
-         printf("maximum number (%d) of commands reached -> cannot add this command\n", ULP_PROGRAM_MAX_COMMAND_COUNT);
-      } else {
-         size_t commandIndex = nextCommandIndex++;
-         setBytesInUlpProgram(commandIndex, &(result.commandBytes));
-         printf("%u: \"%s\"\n", commandIndex, command);
+      if (!isQuiet) {
+         appendDecimal(&output, nextCommandIndex, 0);
+         appendText(&output, ": \"");
+         appendText(&output, command);
+         appendText(&output, "\"\n");
+      }
+      if (assembler.wordCount > nextCommandIndex) {
+         markDirty(&dirtyRanges, nextCommandIndex, assembler.wordCount - nextCommandIndex);
+         nextCommandIndex       = assembler.wordCount;
          userEnteredNewCommands = true;
       }
    }
 }
 
-static bool runProgram(const char *command) {
-   bool executedProgram = false;
-   char copyOfCommand[strlen(command)];
-   strcpy(copyOfCommand, command);
-   strtok((char*)copyOfCommand, " ");
-   size_t indexOfFirstCommand = atoi(strtok(NULL, " "));
+// Sets the targets of the jumps to labels. Relative jumps that do not reach their labels get relaxed (see Assembler.h), which
+// moves the commands behind them including the first command to execute. Returns false if at least one target could not get set.
+static bool resolveJumpTargets(size_t *indexOfFirstCommand) {
+   size_t previousWordCount   = assembler.wordCount;
+   size_t undefinedLabelCount = 0;
+
+   assembler.diagnosticCount = 0;
+   // resolveLabels only writes the word with the target, which is the second one of a relaxed jump
+   for (size_t index = 0; index < assembler.fixupCount; index++) {
+      wasRelaxed[index]        = fixups[index].isRelaxed;
+      previousJumpWords[index] = assembler.words[fixups[index].wordIndex + (fixups[index].isRelaxed ? 1 : 0)];
+   }
+   // relaxing a jump also changes the numeric jumps in front of it whose targets moved (see Assembler.h)
+   size_t firstChangedIndex = resolveLabels(&assembler);
+
+   // the fixups are sorted by their word index -> each word inserted in front of the first command moves it by one word
+   for (size_t index = 0; index < assembler.fixupCount; index++) {
+      Fixup *fixup = &fixups[index];
+      if (!symbols[fixup->symbolIndex].isDefined) {
+         printf("ERROR: The label \"%s\" used by command %u is not defined.\n", symbols[fixup->symbolIndex].name, fixup->wordIndex);
+         undefinedLabelCount++;
+      }
+      if (fixup->isRelaxed && !wasRelaxed[index]) {
+         *indexOfFirstCommand += fixup->wordIndex + 1 <= *indexOfFirstCommand ? 1 : 0;
+      } else if (assembler.words[fixup->wordIndex + (fixup->isRelaxed ? 1 : 0)] != previousJumpWords[index]) {
+         markDirty(&dirtyRanges, fixup->wordIndex + (fixup->isRelaxed ? 1 : 0), 1);
+      }
+   }
+   if (assembler.diagnosticCount > undefinedLabelCount) {
+      printf("ERROR: At least one label is out of the range of the jump that uses it.\n");
+   }
+   if (assembler.wordCount > previousWordCount) {
+      markDirty(&dirtyRanges, firstChangedIndex, assembler.wordCount - firstChangedIndex);
+      printf("relaxed %u jumps that did not reach their labels (the commands behind them moved).\n", assembler.wordCount - previousWordCount);
+      nextCommandIndex = assembler.wordCount;
+   }
+   return assembler.diagnosticCount == 0;
+}
+
+// Applies the peephole optimizer (see Optimizer.h) to the entered program. The labels and the index of the first command
+// get moved together with the commands.
+static void optimizeUlpProgram(size_t *indexOfFirstCommand) {
+   Optimization optimization = optimizeProgram(assembler.words, nextCommandIndex, newIndices);
+
+   switch (optimization.status) {
+      case OPTIMIZATION_INDIRECT_JUMP:
+         printf("WARNING: The program did not get optimized because of the jump to a register at command index %d.\n", optimization.commandIndex);
+         return;
+      case OPTIMIZATION_INVALID_JUMP:
+         printf("WARNING: The program did not get optimized because the jump at command index %d leads in front of the program.\n", optimization.commandIndex);
+         return;
+      case OPTIMIZATION_DONE:
+         break;
+   }
+
+   if (optimization.firstModifiedIndex < optimization.wordCount) {
+      markDirty(&dirtyRanges, optimization.firstModifiedIndex, optimization.wordCount - optimization.firstModifiedIndex);
+   }
+   for (size_t index = 0; index < assembler.symbolCapacity; index++) {
+      Symbol *symbol = &symbols[index];
+      if (symbol->name[0] != 0 && symbol->isDefined) {
+         symbol->address = newIndices[symbol->address / ULP_PROGRAM_COMMAND_SIZE_IN_BYTES] * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+      }
+   }
+   for (size_t index = 0; index < assembler.fixupCount; index++) {
+      fixups[index].wordIndex = newIndices[fixups[index].wordIndex];
+   }
+   *indexOfFirstCommand = newIndices[*indexOfFirstCommand];
+   nextCommandIndex     = optimization.wordCount;
+   printf("optimizer: removed %u words and %u cycles (each command executed once).\n", optimization.removedWordCount, optimization.savedCycleCount);
+}
+
+static bool runProgram(const TokenView *indexToken, uint32_t *waitTimeInMicroseconds) {
+   bool executedProgram       = false;
+   size_t indexOfFirstCommand = toNumber(indexToken);
 
    if(indexOfFirstCommand >= nextCommandIndex) {
       if (nextCommandIndex == 0) {
@@ -319,11 +883,90 @@ static bool runProgram(const char *command) {
       } else {
          printf("ERROR: Maximum allowed command index to start from is %d.\n", nextCommandIndex - 1);
       }
-   } else {
+   } else if (resolveJumpTargets(&indexOfFirstCommand)) {
+      if (isOptimizing) {
+         optimizeUlpProgram(&indexOfFirstCommand);
+      }
       appendHaltCommandsToUlpProgram(ulpProgram);
+      *waitTimeInMicroseconds = getWaitTimeInMicroseconds(indexOfFirstCommand);
       loadUlpProgram(ulpProgram);
       startUlpProgram(indexOfFirstCommand);
+      lastIndexOfFirstCommand = indexOfFirstCommand;
       executedProgram = true;
    }
    return executedProgram;
+}
+
+// Returns the time the ULP needs in the worst case to execute the program or the configured timeout if the program
+// cannot be analyzed.
+static uint32_t getWaitTimeInMicroseconds(size_t indexOfFirstCommand) {
+   size_t wordCount            = nextCommandIndex + ULP_PROGRAM_HALT_COMMANDS_COUNT;
+   ExecutionTime executionTime = analyzeExecutionTime(assembler.words, wordCount, indexOfFirstCommand, executionStates, EXECUTION_STATE_CAPACITY);
+
+   switch (executionTime.status) {
+      case EXECUTION_TIME_BOUNDED: {
+         uint64_t worstCaseMicroseconds = (executionTime.worstCaseCycleCount * 1000000 + ULP_MIN_CLOCK_FREQUENCY_HZ - 1) / ULP_MIN_CLOCK_FREQUENCY_HZ;
+         printf("execution time: %llu - %llu cycles (at most %llu us)\n", executionTime.bestCaseCycleCount, executionTime.worstCaseCycleCount, worstCaseMicroseconds);
+         return worstCaseMicroseconds < UINT32_MAX ? worstCaseMicroseconds : UINT32_MAX;
+      }
+      case EXECUTION_TIME_UNBOUNDED_LOOP:
+         printf("WARNING: The loop at command index %d might never end (only loops using the stage counter after stage_rst are bounded).\n", executionTime.commandIndex);
+         break;
+      case EXECUTION_TIME_INDIRECT_JUMP:
+         printf("WARNING: The execution time is unknown because of the jump to a register at command index %d.\n", executionTime.commandIndex);
+         break;
+      case EXECUTION_TIME_INVALID_COMMAND:
+         printf("WARNING: The program might execute a variable or run past its end at command index %d.\n", executionTime.commandIndex);
+         break;
+      case EXECUTION_TIME_TOO_COMPLEX:
+         printf("WARNING: The program is too complex to calculate its execution time.\n");
+         break;
+   }
+   printf("Waiting at most %d ms for the end of the program.\n", timeoutInMicroseconds / 1000);
+   return timeoutInMicroseconds;
+}
+
+static void setTimeout(const TokenView *millisecondsToken) {
+   uint32_t milliseconds = toNumber(millisecondsToken);
+   if (milliseconds == 0 || milliseconds > UINT32_MAX / 1000) {
+      printf("ERROR: The timeout needs to be in the range [1, %u].\n", UINT32_MAX / 1000);
+   } else {
+      timeoutInMicroseconds = MILLIS(milliseconds);
+      printf("timeout = %u ms\n", milliseconds);
+   }
+}
+
+static bool isUlpProgramCompleted(void *context) {
+   uint32_t completionMarkerIndex = *(uint32_t*)context;
+   return isCompletionMarkerSet(RTC_SLOW_MEM[completionMarkerIndex], completionMarkerIndex);
+}
+
+static uint64_t getTimeInMicroseconds(void *context) {
+   return esp_timer_get_time();
+}
+
+static void delay(void *context, uint32_t microseconds) {
+   uint32_t tickInMicroseconds = portTICK_PERIOD_MS * 1000;
+   if (microseconds < tickInMicroseconds) {
+      ets_delay_us(microseconds);
+   } else {
+      vTaskDelay(microseconds / tickInMicroseconds);
+   }
+}
+
+// Waits till the ULP program set the completion marker. The worst case execution time plus one tick serves as timeout
+// because the analysis does not know the exact frequency of RTC_FAST_CLK.
+static void waitForUlpProgram(uint32_t waitTimeInMicroseconds) {
+   uint32_t completionMarkerIndex = nextCommandIndex + ULP_PROGRAM_HALT_COMMANDS_COUNT;
+   uint32_t tickInMicroseconds    = portTICK_PERIOD_MS * 1000;
+   uint32_t timeout               = waitTimeInMicroseconds < UINT32_MAX - tickInMicroseconds ? waitTimeInMicroseconds + tickInMicroseconds : UINT32_MAX;
+   CompletionHardware hardware    = {&completionMarkerIndex, isUlpProgramCompleted, getTimeInMicroseconds, delay};
+   CompletionPolling polling      = {MIN_POLL_INTERVAL_IN_MICROSECONDS, MAX_POLL_INTERVAL_IN_MICROSECONDS, timeout};
+
+   CompletionResult result = waitForCompletion(&hardware, &polling);
+   if (result.isCompleted) {
+      printf("Program finished (detected after %llu us).\n", result.elapsedMicroseconds);
+   } else {
+      printf("WARNING: The program did not finish within %llu ms -> the following memory dump shows an intermediate state.\n", result.elapsedMicroseconds / 1000);
+   }
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "AllocationCounter.h"
+
+static bool   countAllocations = false;
+static size_t allocationCount  = 0;
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+
+void* malloc(size_t size) {
+   allocationCount += countAllocations ? 1 : 0;
+   return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+   allocationCount += countAllocations ? 1 : 0;
+   return __libc_calloc(count, size);
+}
+
+void* realloc(void *pointer, size_t size) {
+   allocationCount += countAllocations ? 1 : 0;
+   return __libc_realloc(pointer, size);
+}
+#endif
+
+void startCountingAllocations(void) {
+   allocationCount  = 0;
+   countAllocations = true;
+}
+
+size_t stopCountingAllocations(void) {
+   countAllocations = false;
+   return allocationCount;
+}
@@ -0,0 +1,16 @@
+#ifndef assembler_allocation_counter_h
+#define assembler_allocation_counter_h
+
+#include <stddef.h>
+
+/**
+ * Counts the calls of malloc, calloc and realloc between startCountingAllocations and stopCountingAllocations by
+ * replacing the allocator functions of glibc (the count stays 0 with other C libraries). Only the number of allocations
+ * gets measured, not the number of allocated or copied bytes.
+ */
+void startCountingAllocations(void);
+
+// Returns the number of allocations since startCountingAllocations.
+size_t stopCountingAllocations(void);
+
+#endif
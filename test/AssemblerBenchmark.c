@@ -0,0 +1,124 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../main/Assembler.h"
+
+// Measures the throughput of splitting a large source into lines (Scanner) and of assembling it (assembleWith) for each
+// scanner implementation the CPU supports and writes the results as JSON to stdout.
+//
+// usage: assemblerBenchmark [sourceMegabytes] [repetitions]
+
+#define DEFAULT_SOURCE_MEGABYTES    16
+#define DEFAULT_REPETITIONS         3
+#define SYMBOL_CAPACITY             16
+
+static const char *SOURCE_LINES[] = {
+   "   move r1, 0x10          // address of the counter",
+   "   ld r0, r1, 0",
+   "   add r0, r0, 1",
+   "   st r0, r1, 0",
+   "",
+   "   // wait a little bit before reading the sensor",
+   "   wait 0x1234",
+   "   tsens r2, 100",
+   "   jumpr 8, 0x7fed, lt",
+   "   stage_inc 0xab",
+   "   jumps -4, 5, le        // loop",
+   "   reg_rd 0x3ff48400, 3, 1",
+   "   halt",
+};
+
+static const char *IMPLEMENTATION_NAMES[] = {"scalar", "SSE2", "AVX2"};
+
+static uint64_t nowInNanoseconds() {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static size_t createSource(uint8_t *source, size_t maxLength, size_t *lineCount) {
+   size_t length        = 0;
+   size_t sampleCount   = sizeof(SOURCE_LINES) / sizeof(SOURCE_LINES[0]);
+   *lineCount           = 0;
+   for (size_t index = 0; true; index++) {
+      const char *line  = SOURCE_LINES[index % sampleCount];
+      size_t lineLength = strlen(line);
+      if (length + lineLength + 1 > maxLength) {
+         return length;
+      }
+      memcpy(source + length, line, lineLength);
+      source[length + lineLength] = '\n';
+      length += lineLength + 1;
+      (*lineCount)++;
+   }
+}
+
+static double megabytesPerSecond(size_t bytes, uint64_t nanoseconds) {
+   return nanoseconds > 0 ? (bytes / 1e6) / (nanoseconds / 1e9) : 0;
+}
+
+int main(int argc, char* argv[]) {
+   size_t megabytes   = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SOURCE_MEGABYTES;
+   size_t repetitions = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_REPETITIONS;
+   size_t maxLength   = (megabytes > 0 ? megabytes : 1) * 1000000;
+   repetitions        = repetitions > 0 ? repetitions : 1;
+
+   size_t   lineCount;
+   uint8_t  *source         = malloc(maxLength);
+   size_t   sourceLength    = createSource(source, maxLength, &lineCount);
+   uint32_t *words          = malloc(lineCount * sizeof(uint32_t));
+   uint32_t *referenceWords = malloc(lineCount * sizeof(uint32_t));
+   size_t   referenceCount  = 0;
+   bool     allEqual        = true;
+   Diagnostic diagnostics[1];
+   Symbol     symbols[SYMBOL_CAPACITY];
+   Fixup      fixups[1];
+
+   printf("{\n   \"benchmark\": \"assemble\",\n   \"sourceBytes\": %zu,\n   \"lines\": %zu,\n   \"implementations\": [\n", sourceLength, lineCount);
+   for (int implementation = SCANNER_SCALAR; implementation <= getFastestScannerImplementation(); implementation++) {
+      uint64_t scanNanoseconds     = UINT64_MAX;
+      uint64_t assembleNanoseconds = UINT64_MAX;
+      Assembler assembler = {.words   = words,   .maxWordCount   = lineCount,       .diagnostics = diagnostics, .maxDiagnosticCount = 1,
+                             .symbols = symbols, .symbolCapacity = SYMBOL_CAPACITY, .fixups      = fixups,      .maxFixupCount      = 1};
+
+      for (size_t repetition = 0; repetition < repetitions; repetition++) {
+         Scanner    scanner;
+         SourceLine line;
+         size_t     commandBytes = 0;
+         uint64_t   start        = nowInNanoseconds();
+         initScanner(&scanner, source, sourceLength, implementation);
+         while (nextLine(&scanner, &line)) {
+            commandBytes += line.commandLength;
+         }
+         uint64_t duration = nowInNanoseconds() - start;
+         scanNanoseconds   = duration < scanNanoseconds ? duration : scanNanoseconds;
+         allEqual          = allEqual && commandBytes > 0;
+
+         resetAssembler(&assembler);
+         start    = nowInNanoseconds();
+         assembleWith(&assembler, source, sourceLength, implementation);
+         duration = nowInNanoseconds() - start;
+         assembleNanoseconds = duration < assembleNanoseconds ? duration : assembleNanoseconds;
+      }
+
+      if (implementation == SCANNER_SCALAR) {
+         referenceCount = assembler.wordCount;
+         memcpy(referenceWords, words, referenceCount * sizeof(uint32_t));
+      }
+      bool isEqual = assembler.diagnosticCount == 0 && assembler.wordCount == referenceCount && memcmp(words, referenceWords, referenceCount * sizeof(uint32_t)) == 0;
+      allEqual     = allEqual && isEqual;
+
+      printf("%s      {\"implementation\": \"%s\", \"sameWords\": %s, \"scanMBPerSecond\": %.1f, \"assembleMBPerSecond\": %.1f, \"nsPerLine\": %.2f}",
+         implementation == SCANNER_SCALAR ? "" : ",\n", IMPLEMENTATION_NAMES[implementation], isEqual ? "true" : "false",
+         megabytesPerSecond(sourceLength, scanNanoseconds), megabytesPerSecond(sourceLength, assembleNanoseconds),
+         (double)assembleNanoseconds / lineCount);
+   }
+   printf("\n   ]\n}\n");
+
+   free(source);
+   free(words);
+   free(referenceWords);
+   return allEqual ? 0 : 1;
+}
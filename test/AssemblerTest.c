@@ -0,0 +1,156 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/Assembler.h"
+
+#define MAX_WORD_COUNT        140
+#define MAX_DIAGNOSTIC_COUNT  3
+#define SYMBOL_CAPACITY       16
+#define MAX_FIXUP_COUNT       4
+#define ENCODE_CACHE_CAPACITY 8
+
+#define EIGHT_NOPS            "nop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\n"
+#define EIGHT_NOP_WORDS       0x40000000, 0x40000000, 0x40000000, 0x40000000, 0x40000000, 0x40000000, 0x40000000, 0x40000000
+#define SIXTY_FOUR_NOPS       EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS
+#define SIXTY_FOUR_NOP_WORDS  EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS
+
+typedef struct {
+   char           *name;
+   char           *source;
+   size_t         maxWordCount;
+   size_t         expectedWordCount;
+   uint32_t       expectedWords[MAX_WORD_COUNT];
+   size_t         expectedDiagnosticCount;
+   size_t         expectedLineNumbers[MAX_DIAGNOSTIC_COUNT];
+} Testcase;
+
+Testcase testcases[] = {
+   {"empty source",             "",                                                MAX_WORD_COUNT, 0, {},                                   0, {}},
+   {"single line without LF",   "halt",                                            MAX_WORD_COUNT, 1, {0xb0000000},                         0, {}},
+   {"LF separated lines",       "nop\nmove r0, -1\nhalt\n",                        MAX_WORD_COUNT, 3, {0x40000000, 0x728ffff0, 0xb0000000}, 0, {}},
+   {"CRLF separated lines",     "nop\r\nwake\r\nhalt\r\n",                         MAX_WORD_COUNT, 3, {0x40000000, 0x90000001, 0xb0000000}, 0, {}},
+   {"CR separated lines",       "nop\rwake\rhalt",                                 MAX_WORD_COUNT, 3, {0x40000000, 0x90000001, 0xb0000000}, 0, {}},
+   {"comments and empty lines", "#include \"x.h\"\n\n   // comment\nwake // wake\n\t\nhalt", MAX_WORD_COUNT, 2, {0x90000001, 0xb0000000},     0, {}},
+   {"upper case and blanks",    "  ADD R1, R2, R3  \n",                            MAX_WORD_COUNT, 1, {0x70000039},                         0, {}},
+   {"erroneous lines",          "nop\nfoo\r\nhalt\njumpr 0, 0, ov\n",              MAX_WORD_COUNT, 2, {0x40000000, 0xb0000000},             2, {2, 4}},
+   {"more errors than stored",  "a\nb\nc\nd\ne",                                   MAX_WORD_COUNT, 0, {},                                   5, {1, 2, 3}},
+   {"labels and directives",    "   .global entry\nentry:\nnop\nloop: halt\n.text\n",  MAX_WORD_COUNT, 2, {0x40000000, 0xb0000000},             0, {}},
+   {"unsupported directive",    ".data\n.long 5\nnop",                             MAX_WORD_COUNT, 1, {0x40000000},                         2, {1, 2}},
+   {"too many words",           "nop\nnop\nnop",                                   2,              2, {0x40000000, 0x40000000},             1, {3}},
+   {"jump back to label",       "loop: nop\njumpr loop, 1, ge",                     MAX_WORD_COUNT, 2, {0x40000000, 0x83030001},             0, {}},
+   {"jump forward to label",    "jump end\nnop\nend: halt",                         MAX_WORD_COUNT, 3, {0x80000008, 0x40000000, 0xb0000000}, 0, {}},
+   {"jumps forward to label",   "jumps done, 3, lt\nnop\ndone:\nhalt",             MAX_WORD_COUNT, 3, {0x84040003, 0x40000000, 0xb0000000}, 0, {}},
+   {"conditional jump to label","start: jump start, eq",                           MAX_WORD_COUNT, 1, {0x80400000},                         0, {}},
+   {"undefined label",          "nop\njump missing\nhalt",                          MAX_WORD_COUNT, 3, {0x40000000, 0x80000000, 0xb0000000}, 1, {2}},
+   {"duplicate label",          "a: nop\na: halt",                                   MAX_WORD_COUNT, 1, {0x40000000},                         1, {2}},
+   {"reserved label names",     "r4: nop\nEQ: halt\nr4a: nop\njump r4a",              MAX_WORD_COUNT, 2, {0x40000000, 0x80000000},             2, {1, 2}},
+   {"jumpr 33 words forward",   "jumpr end, 0, ge\n" EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS "end: halt", MAX_WORD_COUNT, 34,
+                                {0x82430000, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, 0xb0000000}, 0, {}},
+   {"relaxed jumpr forward",    "jumpr end, 5, lt\n" SIXTY_FOUR_NOPS SIXTY_FOUR_NOPS "end: halt", MAX_WORD_COUNT, 131,
+                                {0x82050005, 0x80000208, SIXTY_FOUR_NOP_WORDS, SIXTY_FOUR_NOP_WORDS, 0xb0000000}, 0, {}},
+   {"relaxed jumps le backward","loop: " SIXTY_FOUR_NOPS SIXTY_FOUR_NOPS "jumps loop, 7, le", MAX_WORD_COUNT, 130,
+                                {SIXTY_FOUR_NOP_WORDS, SIXTY_FOUR_NOP_WORDS, 0x84048008, 0x80000000}, 0, {}},
+   {"relaxed jumps le 255",     "loop: " SIXTY_FOUR_NOPS SIXTY_FOUR_NOPS "jumps loop, 255, le", MAX_WORD_COUNT, 130,
+                                {SIXTY_FOUR_NOP_WORDS, SIXTY_FOUR_NOP_WORDS, 0x84040000, 0x80000000}, 0, {}},
+   {"relaxation moves label",   "jumpr x, 1, lt\njumps far, 2, lt\n" SIXTY_FOUR_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS EIGHT_NOPS
+                                "nop\nnop\nnop\nnop\nnop\nx: nop\nnop\nfar: halt", MAX_WORD_COUNT, 132,
+                                {0x82050001, 0x80000204, 0x84048002, 0x8000020c, SIXTY_FOUR_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS,
+                                 EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, EIGHT_NOP_WORDS, 0x40000000, 0x40000000, 0x40000000, 0x40000000,
+                                 0x40000000, 0x40000000, 0x40000000, 0xb0000000}, 0, {}},
+   {"jumpr eq to label",        "jumpr end, 5, eq\nnop\nend: halt",                MAX_WORD_COUNT, 4, {0x82050006, 0x82050005, 0x40000000, 0xb0000000}, 0, {}},
+   {"jumps eq back to label",   "loop: stage_inc 1\njumps loop, 3, eq",           MAX_WORD_COUNT, 3, {0x74000010, 0x84040003, 0x85050003},             0, {}},
+   {"two words do not fit",     "nop\njumpr 0, 5, eq",                            2,              1, {0x40000000},                         1, {2}},
+   {"relaxed jumpr eq",         "jumpr end, 5, eq\n" SIXTY_FOUR_NOPS SIXTY_FOUR_NOPS "end: halt", MAX_WORD_COUNT, 132,
+                                {0x82070006, 0x82040005, 0x8000020c, SIXTY_FOUR_NOP_WORDS, SIXTY_FOUR_NOP_WORDS, 0xb0000000}, 0, {}},
+   {"relaxed jumpr eq backward","loop: " SIXTY_FOUR_NOPS SIXTY_FOUR_NOPS "jumpr loop, 5, eq", MAX_WORD_COUNT, 131,
+                                {SIXTY_FOUR_NOP_WORDS, SIXTY_FOUR_NOP_WORDS, 0x82070006, 0x82040005, 0x80000000}, 0, {}},
+   {"no space for relaxation",  "loop: " SIXTY_FOUR_NOPS SIXTY_FOUR_NOPS "jumpr loop, 0, lt", 129, 128,
+                                {SIXTY_FOUR_NOP_WORDS, SIXTY_FOUR_NOP_WORDS}, 1, {129}},
+   {"relaxation moves numeric jumps", "jumpr end, 5, lt\njump 0x10\njumpr 8, 0, ge\njumpr -12, 0, ge\n" SIXTY_FOUR_NOPS SIXTY_FOUR_NOPS "end: halt", MAX_WORD_COUNT, 134,
+                                {0x82050005, 0x80000214, 0x80000014, 0x82050000, 0x83090000, SIXTY_FOUR_NOP_WORDS, SIXTY_FOUR_NOP_WORDS, 0xb0000000}, 0, {}},
+   {"numeric jump prevents relaxation", "jumpr 508, 0, ge\njumpr end, 5, lt\n" SIXTY_FOUR_NOPS SIXTY_FOUR_NOPS "end: halt", MAX_WORD_COUNT, 131,
+                                {0x82ff0000, 0x82000005, SIXTY_FOUR_NOP_WORDS, SIXTY_FOUR_NOP_WORDS, 0xb0000000}, 1, {2}},
+
+   {NULL, NULL, 0, 0, {}, 0, {}} // end
+};
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint32_t   words[MAX_WORD_COUNT];
+      Diagnostic diagnostics[MAX_DIAGNOSTIC_COUNT];
+      Symbol     symbols[SYMBOL_CAPACITY];
+      Fixup      fixups[MAX_FIXUP_COUNT];
+      Assembler  result = {.words   = words,   .maxWordCount   = testcase->maxWordCount, .diagnostics   = diagnostics, .maxDiagnosticCount = MAX_DIAGNOSTIC_COUNT,
+                           .symbols = symbols, .symbolCapacity = SYMBOL_CAPACITY,        .fixups        = fixups,      .maxFixupCount      = MAX_FIXUP_COUNT};
+      resetAssembler(&result);
+      assemble(&result, (uint8_t*)testcase->source, strlen(testcase->source));
+
+      if (result.wordCount != testcase->expectedWordCount) {
+         failTest(testcase, &testFailed);
+         printf("\tword count              expected: %ld\n", testcase->expectedWordCount);
+         printf("\t                        actual:   %ld\n\n", result.wordCount);
+      } else {
+         for (size_t index = 0; index < result.wordCount; index++) {
+            if (words[index] != testcase->expectedWords[index]) {
+               failTest(testcase, &testFailed);
+               printf("\tword %ld                  expected: 0x%08x\n", index, testcase->expectedWords[index]);
+               printf("\t                        actual:   0x%08x\n\n", words[index]);
+            }
+         }
+      }
+
+      if (result.diagnosticCount != testcase->expectedDiagnosticCount) {
+         failTest(testcase, &testFailed);
+         printf("\tdiagnostic count        expected: %ld\n", testcase->expectedDiagnosticCount);
+         printf("\t                        actual:   %ld\n\n", result.diagnosticCount);
+      } else {
+         for (size_t index = 0; index < result.diagnosticCount && index < MAX_DIAGNOSTIC_COUNT; index++) {
+            if (diagnostics[index].lineNumber != testcase->expectedLineNumbers[index] || diagnostics[index].errorMessage == NULL) {
+               failTest(testcase, &testFailed);
+               printf("\tdiagnostic %ld line       expected: %ld\n", index, testcase->expectedLineNumbers[index]);
+               printf("\t                        actual:   %ld\n\n", diagnostics[index].lineNumber);
+            }
+         }
+      }
+
+      // assembling the source twice using an encode cache (the second time from the cache) produces the same words
+      uint32_t      cachedWords[MAX_WORD_COUNT];
+      CachedCommand cachedCommands[ENCODE_CACHE_CAPACITY];
+      EncodeCache   encodeCache = {cachedCommands, ENCODE_CACHE_CAPACITY, 0, 0};
+      resetEncodeCache(&encodeCache);
+      for (int pass = 0; pass < 2; pass++) {
+         Assembler cached = result;
+         cached.words       = cachedWords;
+         cached.encodeCache = &encodeCache;
+         resetAssembler(&cached);
+         assemble(&cached, (uint8_t*)testcase->source, strlen(testcase->source));
+         if (cached.wordCount != result.wordCount || cached.diagnosticCount != result.diagnosticCount ||
+             memcmp(cachedWords, words, result.wordCount * sizeof(uint32_t)) != 0) {
+            failTest(testcase, &testFailed);
+            printf("	assembling with encode cache (pass %d) produced different words or diagnostics\n\n", pass);
+         }
+      }
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
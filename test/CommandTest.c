@@ -1,10 +1,12 @@
 #include <stdio.h>
+#include <time.h>
 #include "../main/Commands.h"
 
 typedef struct {
    char           *input;
    bool           expectErrorMessage;
    CommandBytes   expectedBytes;
+   CommandBytes   expectedAdditionalBytes;   // second command of pseudo commands (all bytes 0 if there is no second command)
 } Testcase;
 
 Testcase testcases[] = {
@@ -670,6 +672,11 @@ Testcase testcases[] = {
    {"jump r1",            false, {0x01, 0x00, 0x20, 0x80}},
    {"jump r2",            false, {0x02, 0x00, 0x20, 0x80}},
    {"jump r3",            false, {0x03, 0x00, 0x20, 0x80}},
+   {"jump r4",            true,  {0x00, 0x00, 0x00, 0x00}},
+   {"jump R9, eq",        true,  {0x00, 0x00, 0x00, 0x00}},
+   {"jump r10",           true,  {0x00, 0x00, 0x00, 0x00}},
+   {"jump eq",            true,  {0x00, 0x00, 0x00, 0x00}},
+   {"jump r4a",           false, {0x00, 0x00, 0x00, 0x80}},
 
    {"jump 0",             false, {0x00, 0x00, 0x00, 0x80}},
    {"jump 0x3fc",         false, {0xfc, 0x03, 0x00, 0x80}},   
@@ -714,11 +721,26 @@ Testcase testcases[] = {
 
    {"jumpr   -4,      0, lt", false, {0x00, 0x00, 0x02, 0x83}},
    {"jumpr   -8,      1, ge", false, {0x01, 0x00, 0x05, 0x83}},
+   {"jumpr  200,      0, lt", false, {0x00, 0x00, 0x64, 0x82}},
+   {"jumpr  508,      0, ge", false, {0x00, 0x00, 0xff, 0x82}},
+   {"jumpr -508,      0, lt", false, {0x00, 0x00, 0xfe, 0x83}},
+   {"jumpr  512,      0, lt", true,  {0x00, 0x00, 0x00, 0x00}},
+   {"jumpr -512,      0, ge", true,  {0x00, 0x00, 0x00, 0x00}},
    
-   // The conditions eq, le and gt are not supported by the ULP. The compiler replaces them by modified jumpr commands using ge and lt.
-   {"jumpr    0,      0, eq", true, {0x00, 0x00, 0x00, 0x00}},
-   {"jumpr    0,      0, le", true, {0x00, 0x00, 0x00, 0x00}},
-   {"jumpr    0,      0, gt", true, {0x00, 0x00, 0x00, 0x00}},
+   // The conditions eq, le and gt are not supported by the ULP -> they get replaced by jumpr commands using ge and lt.
+   {"jumpr    8,      5, le", false, {0x06, 0x00, 0x04, 0x82}},
+   {"jumpr    8, 0xffff, le", false, {0x00, 0x00, 0x05, 0x82}},
+   {"jumpr    8,      5, gt", false, {0x06, 0x00, 0x05, 0x82}},
+   {"jumpr    8, 0xffff, gt", false, {0x00, 0x00, 0x04, 0x82}},
+   {"jumpr    8,      0, eq", false, {0x01, 0x00, 0x04, 0x82}},
+   {"jumpr    8, 0xffff, eq", false, {0xff, 0xff, 0x05, 0x82}},
+   {"jumpr   12,      5, eq", false, {0x06, 0x00, 0x05, 0x82}, {0x05, 0x00, 0x05, 0x82}},
+   {"jumpr   -8,      5, eq", false, {0x06, 0x00, 0x05, 0x82}, {0x05, 0x00, 0x07, 0x83}},
+   {"jumpr  508,      5, eq", false, {0x06, 0x00, 0x05, 0x82}, {0x05, 0x00, 0xfd, 0x82}},
+   {"jumpr -508,      5, eq", true,  {0x00, 0x00, 0x00, 0x00}},
+   {"jumpr    0,      0, ov", true,  {0x00, 0x00, 0x00, 0x00}},
+   {"jumpr   r5,      0, lt", true,  {0x00, 0x00, 0x00, 0x00}},
+   {"jumpr   gt,      0, lt", true,  {0x00, 0x00, 0x00, 0x00}},
 
    {"jumps    0,    0, lt",    false, {0x00, 0x00, 0x00, 0x84}},
    {"jumps    1,    0, lt",    false, {0x00, 0x00, 0x00, 0x84}},
@@ -755,10 +777,17 @@ Testcase testcases[] = {
 
    {"jumps   -4,    0, lt",    false, {0x00, 0x00, 0x02, 0x85}},
    {"jumps   -8,    1, ge",    false, {0x01, 0x80, 0x04, 0x85}},
-
-   // The conditions eq and gt are not supported by the ULP. The compiler replaces them by modified jumps commands using lt, le and ge.
-   {"jumps    0,    0, eq",   true, {0x00, 0x00, 0x00, 0x00}},
-   {"jumps    0,    0, gt",   true, {0x00, 0x00, 0x00, 0x00}},
+   {"jumps -200,    0, lt",    false, {0x00, 0x00, 0x64, 0x85}},
+   {"jumps  508,    0, le",    false, {0x00, 0x00, 0xff, 0x84}},
+   {"jumps  512,    0, le",    true,  {0x00, 0x00, 0x00, 0x00}},
+
+   // The conditions eq and gt are not supported by the ULP -> they get replaced by jumps commands using lt, le and ge.
+   {"jumps    8,    5, gt",    false, {0x06, 0x80, 0x04, 0x84}},
+   {"jumps    8, 0xff, gt",    false, {0x00, 0x00, 0x04, 0x84}},
+   {"jumps    8,    0, eq",    false, {0x00, 0x00, 0x05, 0x84}},
+   {"jumps    8, 0xff, eq",    false, {0xff, 0x80, 0x04, 0x84}},
+   {"jumps   12,    5, eq",    false, {0x05, 0x00, 0x04, 0x84}, {0x05, 0x00, 0x05, 0x84}},
+   {"jumps    0,    0, ov",    true,  {0x00, 0x00, 0x00, 0x00}},
 
    {"stage_rst",      false, {0x00, 0x00, 0x40, 0x74}},
 
@@ -882,6 +911,7 @@ static void failTest(Testcase *testcase, bool *testFailed) {
 int main(int argc, char* argv[]) {  	
    size_t processedTestcaseCount = 0;
    size_t failedTestcaseCount    = 0;
+   clock_t start                 = clock();
       
    for (Testcase *testcase = testcases; testcase->input != NULL; testcase++) {
       bool testFailed = false;
@@ -903,15 +933,32 @@ int main(int argc, char* argv[]) {
          printf("\t                        actual:   0:0x%02x 1:0x%02x 2:0x%02x 3:0x%02x\n\n", result.commandBytes.byte0, result.commandBytes.byte1, result.commandBytes.byte2, result.commandBytes.byte3);
       }
 
+      CommandBytes expected          = testcase->expectedAdditionalBytes;
+      size_t expectedAdditionalCount = (expected.byte0 | expected.byte1 | expected.byte2 | expected.byte3) != 0 ? 1 : 0;
+      CommandBytes actual            = result.additionalCommandCount > 0 ? result.additionalCommandBytes[0] : (CommandBytes){0x00, 0x00, 0x00, 0x00};
+      if (!testcase->expectErrorMessage && 
+           (result.additionalCommandCount != expectedAdditionalCount || actual.byte0 != expected.byte0 || actual.byte1 != expected.byte1 || 
+            actual.byte2 != expected.byte2 || actual.byte3 != expected.byte3)) {
+         failTest(testcase, &testFailed);
+         printf("\tadditional bytes        expected: %ld x 0:0x%02x 1:0x%02x 2:0x%02x 3:0x%02x\n", expectedAdditionalCount, expected.byte0, expected.byte1, expected.byte2, expected.byte3);
+         printf("\t                        actual:   %ld x 0:0x%02x 1:0x%02x 2:0x%02x 3:0x%02x\n\n", result.additionalCommandCount, actual.byte0, actual.byte1, actual.byte2, actual.byte3);
+      }
+
       failedTestcaseCount += testFailed ? 1 : 0;
       processedTestcaseCount++;
    }
 
+   double elapsedSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   if (elapsedSeconds > 0) {
+      printf("\nprocessed %.0f lines/second\n", processedTestcaseCount / elapsedSeconds);
+   }
+
    if (failedTestcaseCount == 0) {
       printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
    } else {
       printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
    }
    
-   return 0;
+   return failedTestcaseCount == 0 ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include "../main/CompletionDetector.h"
+
+#define NEVER     UINT64_MAX
+
+typedef struct {
+   char      *name;
+   uint64_t  completionTimeInMicroseconds;   // time when the simulated ULP program halts
+   uint32_t  timeoutInMicroseconds;
+   bool      expectedCompleted;
+   uint64_t  expectedElapsedMicroseconds;
+   uint32_t  expectedPollCount;
+} Testcase;
+
+Testcase testcases[] = {
+   {"already completed",         0,      2000,  true,  0,    1},
+   {"completed before 2nd poll", 5,      2000,  true,  10,   2},
+   {"completed after 100us",     100,    2000,  true,  150,  5},
+   {"max poll interval",         5000,   10000, true,  5270, 12},
+   {"timeout",                   NEVER,  2000,  false, 2000, 9},
+   {"zero timeout",              NEVER,  0,     false, 0,    1},
+   {"completed at timeout",      2000,   2000,  true,  2000, 9},
+
+   {NULL, 0, 0, false, 0, 0} // end
+};
+
+// host stand-in for the ESP32: the time only advances when delay gets called
+typedef struct {
+   uint64_t now;
+   uint64_t completionTime;
+} FakeHardware;
+
+static bool isCompleted(void *context) {
+   FakeHardware *hardware = context;
+   return hardware->now >= hardware->completionTime;
+}
+
+static uint64_t getTimeInMicroseconds(void *context) {
+   return ((FakeHardware*)context)->now;
+}
+
+static void delay(void *context, uint32_t microseconds) {
+   ((FakeHardware*)context)->now += microseconds;
+}
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: %lu\n", name, expected);
+      printf("\t                        actual:   %lu\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed             = false;
+      uint64_t completionTime     = testcase->completionTimeInMicroseconds;
+      FakeHardware fakeHardware   = {1000, completionTime == NEVER ? NEVER : 1000 + completionTime};
+      CompletionHardware hardware = {&fakeHardware, isCompleted, getTimeInMicroseconds, delay};
+      CompletionPolling polling   = {10, 1000, testcase->timeoutInMicroseconds};
+
+      CompletionResult result = waitForCompletion(&hardware, &polling);
+
+      expectEqual(testcase, &testFailed, "completed", testcase->expectedCompleted, result.isCompleted);
+      expectEqual(testcase, &testFailed, "elapsed microseconds", testcase->expectedElapsedMicroseconds, result.elapsedMicroseconds);
+      expectEqual(testcase, &testFailed, "poll count", testcase->expectedPollCount, result.pollCount);
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   bool markerTestFailed = false;
+   Testcase markerTestcase = {"completion marker"};
+   expectEqual(&markerTestcase, &markerTestFailed, "cleared marker", false, isCompletionMarkerSet(0, 52));
+   expectEqual(&markerTestcase, &markerTestFailed, "written marker", true, isCompletionMarkerSet((51 << 21) | (1 << 16) | 52, 52));
+   expectEqual(&markerTestcase, &markerTestFailed, "other value", false, isCompletionMarkerSet(53, 52));
+   failedTestcaseCount += markerTestFailed ? 1 : 0;
+   processedTestcaseCount++;
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include "../main/DirtyRanges.h"
+
+#define MAX_MARK_COUNT     6
+#define MAX_RANGE_COUNT    3
+
+// a mark with wordCount = 0 ends the list of marks
+typedef struct {
+   size_t firstWord;
+   size_t wordCount;
+} Mark;
+
+typedef struct {
+   char        *name;
+   Mark        marks[MAX_MARK_COUNT];
+   size_t      expectedRangeCount;
+   WordRange   expectedRanges[MAX_RANGE_COUNT];
+} Testcase;
+
+Testcase testcases[] = {
+   {"nothing modified",          {{0, 0}},                                       0, {}},
+   {"one word",                  {{5, 1}},                                       1, {{5, 6}}},
+   {"appended words",            {{0, 1}, {1, 1}, {2, 3}},                       1, {{0, 5}}},
+   {"separate ranges",           {{10, 2}, {0, 2}, {5, 2}},                      3, {{0, 2}, {5, 7}, {10, 12}}},
+   {"overlapping ranges",        {{2, 4}, {4, 4}},                               1, {{2, 8}}},
+   {"range covering others",     {{2, 1}, {5, 1}, {8, 1}, {0, 20}},              1, {{0, 20}}},
+   {"range joining two others",  {{0, 2}, {5, 2}, {2, 3}},                       1, {{0, 7}}},
+   {"same word twice",           {{3, 1}, {3, 1}},                               1, {{3, 4}}},
+   {"full -> merge left",        {{0, 1}, {10, 1}, {20, 1}, {12, 1}},            3, {{0, 1}, {10, 13}, {20, 21}}},
+   {"full -> merge right",       {{0, 1}, {10, 1}, {20, 1}, {18, 1}},            3, {{0, 1}, {10, 11}, {18, 21}}},
+   {"full -> merge last",        {{0, 1}, {10, 1}, {20, 1}, {30, 2}},            3, {{0, 1}, {10, 11}, {20, 32}}},
+   {"full -> merge first",       {{10, 1}, {20, 1}, {30, 1}, {0, 2}},            3, {{0, 11}, {20, 21}, {30, 31}}},
+
+   {NULL, {}, 0, {}} // end
+};
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: %lu\n", name, expected);
+      printf("\t                        actual:   %lu\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      WordRange ranges[MAX_RANGE_COUNT];
+      DirtyRanges dirtyRanges = {ranges, MAX_RANGE_COUNT, 0};
+      size_t expectedWordCount = 0;
+
+      clearDirtyRanges(&dirtyRanges);
+      for (Mark *mark = testcase->marks; mark->wordCount > 0; mark++) {
+         markDirty(&dirtyRanges, mark->firstWord, mark->wordCount);
+      }
+
+      expectEqual(testcase, &testFailed, "range count", testcase->expectedRangeCount, dirtyRanges.rangeCount);
+      for (size_t index = 0; index < testcase->expectedRangeCount && index < dirtyRanges.rangeCount; index++) {
+         expectEqual(testcase, &testFailed, "first word", testcase->expectedRanges[index].firstWord, ranges[index].firstWord);
+         expectEqual(testcase, &testFailed, "end word", testcase->expectedRanges[index].endWord, ranges[index].endWord);
+         expectedWordCount += testcase->expectedRanges[index].endWord - testcase->expectedRanges[index].firstWord;
+      }
+      expectEqual(testcase, &testFailed, "dirty word count", expectedWordCount, getDirtyWordCount(&dirtyRanges));
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/Commands.h"
+#include "../main/Disassembler.h"
+
+typedef struct {
+   uint32_t       word;
+   char           *expectedText;   // NULL if the word is not a command
+} Testcase;
+
+Testcase testcases[] = {
+   {0x70000039, "add r1, r2, r3"},
+   {0x7220064c, "sub r0, r3, 100"},
+   {0x70400006, "and r2, r1, r0"},
+   {0x726fffff, "or r3, r3, 65535"},
+   {0x728ffff0, "move r0, 65535"},
+   {0x7080003e, "move r2, r3"},
+   {0x72a00045, "lsh r1, r1, 4"},
+   {0x70c00038, "rsh r0, r2, r3"},
+   {0x740000a0, "stage_inc 10"},
+   {0x74200ff0, "stage_dec 255"},
+   {0x74400000, "stage_rst"},
+   {0x68000809, "st r1, r2, 8"},
+   {0xd00ffc03, "ld r3, r0, 4092"},
+   {0xd01ffc00, "ld r0, r0, 8188"},
+   {0x80200002, "jump r2"},
+   {0x80800040, "jump 64, ov"},
+   {0x80600000, "jump r0, eq"},
+   {0x80001ffc, "jump 8188"},
+   {0x83040064, "jumpr -8, 100, lt"},
+   {0x823fffff, "jumpr 124, 65535, ge"},
+   {0x8403000a, "jumps 4, 10, le"},
+   {0x850600ff, "jumps -12, 255, lt"},
+   {0x84008000, "jumps 0, 0, ge"},
+   {0x50000065, "adc r1, 1, 9"},
+   {0x33f80012, "i2c_rd 18, 7, 0, 15"},
+   {0x3899ab34, "i2c_wr 52, 171, 3, 1, 2"},
+   {0x2f8003ff, "reg_rd 1023, 31, 0"},
+   {0x1c600006, "reg_wr 6, 24, 24, 0"},
+   {0xb0000000, "halt"},
+   {0x90000001, "wake"},
+   {0x92000004, "sleep 4"},
+   {0x400003e8, "wait 1000"},
+   {0x40000000, "nop"},
+   {0xa000fffe, "tsens r2, 16383"},
+
+   {0x00000005, NULL},           // variable
+   {0xf0000000, NULL},           // unused opcode
+   {0x6a000000, NULL},           // st with unsupported type
+   {0x70e00000, NULL},           // unknown ALU operation
+   {0x74600000, NULL},           // unknown stage count operation
+   {0x86000000, NULL},           // unknown jump type
+   {0x80c00000, NULL},           // unknown absolute jump condition
+   {0x84018000, NULL},           // unknown jumps condition
+
+   {0, NULL} // end
+};
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = 0x%08x)\n\n", testcase->word);
+   }
+}
+
+static uint32_t toWord(CommandBytes *commandBytes) {
+   return (uint32_t)commandBytes->byte0 | ((uint32_t)commandBytes->byte1 << 8) | ((uint32_t)commandBytes->byte2 << 16) | ((uint32_t)commandBytes->byte3 << 24);
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->word != 0; testcase++) {
+      bool testFailed = false;
+      char text[MAX_DISASSEMBLED_COMMAND_LENGTH];
+      bool isCommand  = disassemble(testcase->word, text);
+
+      if (isCommand != (testcase->expectedText != NULL)) {
+         failTest(testcase, &testFailed);
+         printf("\tis command              expected: %s\n", testcase->expectedText != NULL ? "true" : "false");
+         printf("\t                        actual:   %s\n\n", isCommand ? "true" : "false");
+      } else if (isCommand && strcmp(text, testcase->expectedText) != 0) {
+         failTest(testcase, &testFailed);
+         printf("\ttext                    expected: %s\n", testcase->expectedText);
+         printf("\t                        actual:   %s\n\n", text);
+      }
+
+      // the text needs to result in the same word when assembling it again
+      if (isCommand) {
+         Result result = getCommandBytesFor((uint8_t*)text);
+         if (result.errorMessage != NULL || toWord(&result.commandBytes) != testcase->word) {
+            failTest(testcase, &testFailed);
+            printf("\treassembled word        expected: 0x%08x\n", testcase->word);
+            printf("\t                        actual:   0x%08x\n\n", toWord(&result.commandBytes));
+         }
+      }
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/EncodeCache.h"
+
+#define MAX_LINE_COUNT     10
+#define MAX_CAPACITY       16
+
+typedef struct {
+   char     *name;
+   size_t   capacity;
+   char     *lines[MAX_LINE_COUNT];     // NULL ends the list
+   size_t   expectedHitCount;
+   size_t   expectedMissCount;
+} Testcase;
+
+Testcase testcases[] = {
+   {"different lines",           16, {"nop", "halt", "wake", "add r1, r2, r3"},                     0, 4},
+   {"same line again",           16, {"add r1, r2, r3", "nop", "add r1, r2, r3", "add r1, r2, r3"}, 2, 2},
+   {"erroneous line again",      16, {"foo r1", "foo r1"},                                          1, 1},
+   {"label gets rebased",        16, {"jumpr loop, 1, ge", "jumpr loop, 1, ge", "jump end", "jump end"}, 2, 2},
+   {"two commands again",        16, {"jumpr 8, 5, eq", "jumps done, 3, eq", "jumpr 8, 5, eq", "jumps done, 3, eq"}, 2, 2},
+   {"upper case is another key", 16, {"nop", "NOP"},                                                0, 2},
+   {"too long to get cached",    16, {"move r0, 0x0001                    ", "move r0, 0x0001                    "}, 0, 2},
+   {"full cache replaces",       1,  {"nop", "halt", "nop", "nop"},                                 1, 3},
+   {"no entries",                0,  {"nop", "nop"},                                                0, 2},
+   {"all entries used",          4,  {"nop", "halt", "wake", "sleep 1", "nop", "halt", "wake", "sleep 1"}, 4, 4},
+
+   {NULL, 0, {}, 0, 0} // end
+};
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, size_t expected, size_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: %lu\n", name, expected);
+      printf("\t                        actual:   %lu\n\n", actual);
+   }
+}
+
+static bool isSameResult(const Result *expected, const Result *actual) {
+   bool isEqual = memcmp(&expected->commandBytes, &actual->commandBytes, sizeof(CommandBytes)) == 0 &&
+                  expected->errorMessage == actual->errorMessage && expected->label == actual->label &&
+                  expected->additionalCommandCount == actual->additionalCommandCount &&
+                  (expected->label == NULL || expected->labelLength == actual->labelLength);
+   for (size_t index = 0; isEqual && index < expected->additionalCommandCount; index++) {
+      isEqual = memcmp(&expected->additionalCommandBytes[index], &actual->additionalCommandBytes[index], sizeof(CommandBytes)) == 0;
+   }
+   return isEqual;
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      CachedCommand entries[MAX_CAPACITY];
+      EncodeCache cache = {entries, testcase->capacity, 0, 0};
+      resetEncodeCache(&cache);
+
+      for (size_t index = 0; index < MAX_LINE_COUNT && testcase->lines[index] != NULL; index++) {
+         // each line gets its own buffer -> the label of a cached result needs to point into the current line
+         uint8_t line[64];
+         size_t lineLength = strlen(testcase->lines[index]);
+         memcpy(line, testcase->lines[index], lineLength);
+
+         Result expected = getCommandBytesForLine(line, lineLength);
+         Result actual   = getCachedCommandBytesForLine(&cache, line, lineLength);
+         if (!isSameResult(&expected, &actual)) {
+            failTest(testcase, &testFailed);
+            printf("\tresult of line %lu (\"%s\") differs from getCommandBytesForLine\n\n", index, testcase->lines[index]);
+         }
+      }
+
+      expectEqual(testcase, &testFailed, "hit count", testcase->expectedHitCount, cache.hitCount);
+      expectEqual(testcase, &testFailed, "miss count", testcase->expectedMissCount, cache.missCount);
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,308 @@
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../main/Commands.h"
+#include "AllocationCounter.h"
+
+// Measures the throughput and latency of getCommandBytesFor per mnemonic and per file in decodedCommands and writes
+// the results as JSON to stdout.
+//
+// usage: encoderBenchmark [corpusDirectory] [repetitions]
+
+#define DEFAULT_REPETITIONS      2000
+#define MAX_LINE_LENGTH          256
+#define MAX_FAMILY_COUNT         64
+#define MAX_LINES_PER_FAMILY     128
+#define HEX_QUAD_LENGTH          11    // "xx xx xx xx"
+
+typedef struct {
+   char   name[64];
+   char   source[16];
+   size_t lineCount;
+   char   lines[MAX_LINES_PER_FAMILY][MAX_LINE_LENGTH];
+} Family;
+
+typedef struct {
+   double nanosecondsPerInstruction;
+   double linesPerSecond;
+   double p50Nanoseconds;
+   double p99Nanoseconds;
+   size_t allocationCount;
+   size_t errorCount;
+} Measurement;
+
+typedef struct {
+   char *mnemonic;
+   char *lines[3];
+} MnemonicSamples;
+
+static MnemonicSamples MNEMONIC_SAMPLES[] = {
+   {"add",       {"add r1, r2, r3",        "add r0, r1, -1"}},
+   {"sub",       {"sub r3, r2, r1",        "sub r0, r0, 0x10"}},
+   {"and",       {"and r1, r2, r3",        "and r1, r2, 0xff"}},
+   {"or",        {"or r1, r2, r3",         "or r1, r2, 0xff"}},
+   {"move",      {"move r0, r1",           "move r2, 0xabcd"}},
+   {"lsh",       {"lsh r1, r2, r3",        "lsh r1, r2, 4"}},
+   {"rsh",       {"rsh r1, r2, r3",        "rsh r1, r2, 4"}},
+   {"stage_rst", {"stage_rst"}},
+   {"stage_inc", {"stage_inc 0xab"}},
+   {"stage_dec", {"stage_dec 1"}},
+   {"st",        {"st r0, r1, 0x10"}},
+   {"ld",        {"ld r2, r3, 0x7fc"}},
+   {"jump",      {"jump r0",               "jump 0x3fc, eq",      "jump r1, ov"}},
+   {"jumpr",     {"jumpr -8, 1, ge",       "jumpr 12, 0x7fed, lt"}},
+   {"jumps",     {"jumps 4, 0x96, le",     "jumps -4, 0, lt"}},
+   {"halt",      {"halt"}},
+   {"wake",      {"wake"}},
+   {"sleep",     {"sleep 2"}},
+   {"wait",      {"wait 0x1234"}},
+   {"nop",       {"nop"}},
+   {"tsens",     {"tsens r1, 0x3fff"}},
+   {"adc",       {"adc r3, 1, 10"}},
+   {"i2c_rd",    {"i2c_rd 0xab, 4, 1, 6"}},
+   {"i2c_wr",    {"i2c_wr 0xff, 0xab, 4, 1, 6"}},
+   {"reg_rd",    {"reg_rd 0x3ff, 31, 0"}},
+   {"reg_wr",    {"reg_wr 0x3ff, 0, 31, 0xf0"}},
+   {NULL,        {}}
+};
+
+static Family families[MAX_FAMILY_COUNT];
+static size_t familyCount = 0;
+
+static uint64_t nowInNanoseconds() {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static Family* addFamily(const char *name, const char *source) {
+   if (familyCount == MAX_FAMILY_COUNT) {
+      return NULL;
+   }
+   Family *family = &families[familyCount++];
+   snprintf(family->name, sizeof(family->name), "%s", name);
+   snprintf(family->source, sizeof(family->source), "%s", source);
+   family->lineCount = 0;
+   return family;
+}
+
+static void addLine(Family *family, const char *line, size_t length) {
+   while (length > 0 && line[length - 1] == ' ') {
+      length--;
+   }
+   if (family != NULL && family->lineCount < MAX_LINES_PER_FAMILY && length > 0 && length < MAX_LINE_LENGTH) {
+      memcpy(family->lines[family->lineCount], line, length);
+      family->lines[family->lineCount++][length] = 0;
+   }
+}
+
+static bool isHexDigit(char character) {
+   return (character >= '0' && character <= '9') || (character >= 'a' && character <= 'f');
+}
+
+static bool isHexQuad(const char *text) {
+   for (size_t index = 0; index < HEX_QUAD_LENGTH; index++) {
+      bool separatorExpected = (index % 3) == 2;
+      if (separatorExpected ? text[index] != ' ' : !isHexDigit(text[index])) {
+         return false;
+      }
+   }
+   return true;
+}
+
+// Returns the position of the first "xx xx xx xx" (the expected command bytes) in the line or NULL.
+static const char* findHexQuad(const char *line) {
+   for (const char *position = line; strlen(position) >= HEX_QUAD_LENGTH; position++) {
+      if ((position == line || *(position - 1) == ' ') && isHexQuad(position)) {
+         return position;
+      }
+   }
+   return NULL;
+}
+
+// Corpus files contain lines in one of two formats:
+//    "<command>    xx xx xx xx ..."                                  e.g. "adc r0, 0, 1     04 00 00 50"
+//    "<operands>   <mnemonic>: xx xx xx xx   <mnemonic>: ..."        e.g. "r0, r0, r0    add: 00 00 00 70    sub: ..."
+static void addCorpusLine(Family *family, const char *line) {
+   const char *hexQuad = findHexQuad(line);
+   if (hexQuad == NULL) {
+      return;
+   }
+
+   const char *colon = hexQuad - 1;
+   while (colon > line && *colon == ' ') {
+      colon--;
+   }
+
+   if (*colon != ':') {
+      const char *start = line;
+      while (*start == ' ') {
+         start++;
+      }
+      addLine(family, start, hexQuad - start);
+      return;
+   }
+
+   const char *mnemonicStart = colon;
+   while (mnemonicStart > line && *(mnemonicStart - 1) != ' ') {
+      mnemonicStart--;
+   }
+   size_t operandsLength = mnemonicStart - line;
+
+   const char *entry = mnemonicStart;
+   while (true) {
+      const char *entryColon = strchr(entry, ':');
+      if (entryColon == NULL || strlen(entryColon) < 2 + HEX_QUAD_LENGTH) {
+         break;
+      }
+      char command[MAX_LINE_LENGTH];
+      int length = snprintf(command, sizeof(command), "%.*s %.*s", (int)(entryColon - entry), entry, (int)operandsLength, line);
+      addLine(family, command, (size_t)length < sizeof(command) ? (size_t)length : 0);
+
+      entry = entryColon + 2 + HEX_QUAD_LENGTH;
+      while (*entry == ' ') {
+         entry++;
+      }
+   }
+}
+
+static bool isTextFile(const struct dirent *entry) {
+   size_t nameLength = strlen(entry->d_name);
+   return nameLength > 4 && strcmp(entry->d_name + nameLength - 4, ".txt") == 0;
+}
+
+static int isTextFileFilter(const struct dirent *entry) {
+   return isTextFile(entry) ? 1 : 0;
+}
+
+static void loadCorpus(const char *directoryPath) {
+   struct dirent **entries;
+   int entryCount = scandir(directoryPath, &entries, isTextFileFilter, alphasort);
+   if (entryCount < 0) {
+      fprintf(stderr, "WARNING: failed to open corpus directory \"%s\".\n", directoryPath);
+      return;
+   }
+
+   for (int index = 0; index < entryCount; index++) {
+      const char *fileName = entries[index]->d_name;
+      char path[1024];
+      snprintf(path, sizeof(path), "%s/%s", directoryPath, fileName);
+      FILE *file = fopen(path, "r");
+
+      if (file != NULL) {
+         char name[64];
+         snprintf(name, sizeof(name), "%.*s", (int)(strlen(fileName) - 4), fileName);
+         Family *family = addFamily(name, "corpus");
+         char line[MAX_LINE_LENGTH];
+         while (fgets(line, sizeof(line), file) != NULL) {
+            line[strcspn(line, "\r\n")] = 0;
+            addCorpusLine(family, line);
+         }
+         fclose(file);
+      }
+      free(entries[index]);
+   }
+   free(entries);
+}
+
+static void loadMnemonicSamples() {
+   for (MnemonicSamples *samples = MNEMONIC_SAMPLES; samples->mnemonic != NULL; samples++) {
+      Family *family = addFamily(samples->mnemonic, "mnemonic");
+      for (size_t index = 0; index < 3 && samples->lines[index] != NULL; index++) {
+         addLine(family, samples->lines[index], strlen(samples->lines[index]));
+      }
+   }
+}
+
+static int compareLatencies(const void *a, const void *b) {
+   uint32_t latencyA = *(const uint32_t*)a;
+   uint32_t latencyB = *(const uint32_t*)b;
+   return (latencyA > latencyB) - (latencyA < latencyB);
+}
+
+static Measurement measure(Family *family, size_t repetitions) {
+   Measurement measurement = {0};
+   size_t callCount        = family->lineCount * repetitions;
+   uint32_t *latencies     = malloc(callCount * sizeof(uint32_t));
+   volatile uint8_t sink   = 0;
+
+   startCountingAllocations();
+
+   // throughput (without the overhead of reading the clock for each call)
+   uint64_t start = nowInNanoseconds();
+   for (size_t repetition = 0; repetition < repetitions; repetition++) {
+      for (size_t index = 0; index < family->lineCount; index++) {
+         Result result = getCommandBytesFor((uint8_t*)family->lines[index]);
+         sink ^= result.commandBytes.byte3;
+      }
+   }
+   uint64_t elapsed = nowInNanoseconds() - start;
+
+   // latency of each call
+   for (size_t repetition = 0; repetition < repetitions; repetition++) {
+      for (size_t index = 0; index < family->lineCount; index++) {
+         uint64_t callStart = nowInNanoseconds();
+         Result result      = getCommandBytesFor((uint8_t*)family->lines[index]);
+         latencies[repetition * family->lineCount + index] = nowInNanoseconds() - callStart;
+         sink ^= result.commandBytes.byte3;
+         measurement.errorCount += (repetition == 0 && result.errorMessage != NULL) ? 1 : 0;
+      }
+   }
+
+   size_t allocationCount = stopCountingAllocations();
+
+   qsort(latencies, callCount, sizeof(uint32_t), compareLatencies);
+   measurement.nanosecondsPerInstruction = (double)elapsed / callCount;
+   measurement.linesPerSecond            = elapsed > 0 ? callCount * 1e9 / elapsed : 0;
+   measurement.p50Nanoseconds            = latencies[callCount / 2];
+   measurement.p99Nanoseconds            = latencies[(callCount * 99) / 100];
+   measurement.allocationCount           = allocationCount;
+   free(latencies);
+   return measurement;
+}
+
+int main(int argc, char* argv[]) {
+   const char *corpusDirectory = argc > 1 ? argv[1] : CORPUS_DIRECTORY;
+   size_t repetitions          = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_REPETITIONS;
+   repetitions                 = repetitions == 0 ? 1 : repetitions;
+
+   loadMnemonicSamples();
+   loadCorpus(corpusDirectory);
+
+   size_t totalCallCount       = 0;
+   double totalNanoseconds     = 0;
+   size_t totalAllocationCount = 0;
+   size_t failedSampleCount    = 0;
+   bool   isFirstFamily        = true;
+
+   printf("{\n   \"benchmark\": \"getCommandBytesFor\",\n   \"repetitions\": %zu,\n   \"families\": [\n", repetitions);
+   for (size_t index = 0; index < familyCount; index++) {
+      Family *family = &families[index];
+      if (family->lineCount == 0) {
+         continue;
+      }
+      Measurement measurement = measure(family, repetitions);
+      size_t callCount        = family->lineCount * repetitions;
+      totalCallCount         += callCount;
+      totalNanoseconds       += measurement.nanosecondsPerInstruction * callCount;
+      totalAllocationCount   += measurement.allocationCount;
+      // the mnemonic samples are valid commands -> an error means the encoder is broken, not the measurement
+      failedSampleCount      += strcmp(family->source, "mnemonic") == 0 ? measurement.errorCount : 0;
+
+      printf("%s      {\"name\": \"%s\", \"source\": \"%s\", \"lines\": %zu, \"errors\": %zu, \"nsPerInstruction\": %.1f, \"linesPerSecond\": %.0f, \"p50Ns\": %.0f, \"p99Ns\": %.0f, \"mallocCalls\": %zu}",
+         isFirstFamily ? "" : ",\n", family->name, family->source, family->lineCount, measurement.errorCount, measurement.nanosecondsPerInstruction,
+         measurement.linesPerSecond, measurement.p50Nanoseconds, measurement.p99Nanoseconds, measurement.allocationCount);
+      isFirstFamily = false;
+   }
+   printf("\n   ],\n   \"total\": {\"instructions\": %zu, \"nsPerInstruction\": %.1f, \"linesPerSecond\": %.0f, \"mallocCalls\": %zu}\n}\n",
+      totalCallCount, totalCallCount > 0 ? totalNanoseconds / totalCallCount : 0, totalNanoseconds > 0 ? totalCallCount * 1e9 / totalNanoseconds : 0, totalAllocationCount);
+
+   if (failedSampleCount > 0) {
+      fprintf(stderr, "ERROR: %zu mnemonic samples failed to encode.\n", failedSampleCount);
+      return 1;
+   }
+   return 0;
+}
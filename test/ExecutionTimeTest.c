@@ -0,0 +1,95 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/Assembler.h"
+#include "../main/ExecutionTime.h"
+
+#define MAX_WORD_COUNT        32
+#define MAX_DIAGNOSTIC_COUNT  1
+#define SYMBOL_CAPACITY       16
+#define MAX_FIXUP_COUNT       4
+#define STATE_CAPACITY        512   // same as EXECUTION_STATE_CAPACITY in main.c
+
+typedef struct {
+   char                 *name;
+   char                 *source;
+   ExecutionTimeStatus  expectedStatus;
+   size_t               expectedCommandIndex;
+   uint64_t             expectedBestCaseCycleCount;
+   uint64_t             expectedWorstCaseCycleCount;
+} Testcase;
+
+Testcase testcases[] = {
+   {"halt",                      "halt",                                                                   EXECUTION_TIME_BOUNDED,         0, 2,   2},
+   {"straight line",             "move r0, 5\nhalt",                                                       EXECUTION_TIME_BOUNDED,         0, 12,  12},
+   {"cycle operands",            "tsens r0, 100\nadc r1, 0, 1\nhalt",                                      EXECUTION_TIME_BOUNDED,         0, 177, 177},
+   {"conditional jump",          "jump skip, eq\nwait 100\nskip: halt",                                    EXECUTION_TIME_BOUNDED,         0, 10,  116},
+   {"jumpr forward",             "jumpr end, 5, ge\nwait 10\nend: halt",                                   EXECUTION_TIME_BOUNDED,         0, 10,  26},
+   {"stage_inc loop",            "stage_rst\nloop: stage_inc 1\nadd r0, r0, 2\njumps loop, 5, lt\nhalt",   EXECUTION_TIME_BOUNDED,         0, 152, 152},
+   {"255 iterations",            "stage_rst\nloop: stage_inc 1\nadd r0, r0, 2\njumps loop, 255, lt\nhalt", EXECUTION_TIME_BOUNDED,         0, 7152, 7152},
+   {"stage_dec loop",            "stage_rst\nstage_inc 3\nloop: stage_dec 1\njumps done, 0, le\njump loop\ndone: halt", EXECUTION_TIME_BOUNDED, 0, 92, 92},
+   {"loop depending on r0",      "move r0, 0\nloop: add r0, r0, 1\njumpr loop, 3, lt\nhalt",               EXECUTION_TIME_UNBOUNDED_LOOP,  1, 0,   0},
+   {"stage counter not reset",   "loop: stage_inc 1\njumps loop, 5, lt\nhalt",                             EXECUTION_TIME_UNBOUNDED_LOOP,  0, 0,   0},
+   {"indirect jump",             "jump r1",                                                                EXECUTION_TIME_INDIRECT_JUMP,   0, 0,   0},
+   {"end of program",            "nop",                                                                    EXECUTION_TIME_INVALID_COMMAND, 0, 0,   0},
+   {"end behind commands",       "move r0, 1\nnop",                                                       EXECUTION_TIME_INVALID_COMMAND, 1, 0,   0},
+   {"jump behind program",       "jump 40\nhalt",                                                          EXECUTION_TIME_INVALID_COMMAND, 0, 0,   0},
+   {"too many states",           "stage_rst\nloop: stage_inc 1\njumps a, 10, lt\na: jumps b, 20, lt\nb: jumps loop, 200, lt\nhalt", EXECUTION_TIME_TOO_COMPLEX, 3, 0, 0},
+
+   {NULL, NULL, 0, 0, 0, 0} // end
+};
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: %lu\n", name, expected);
+      printf("\t                        actual:   %lu\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+   ExecutionState states[STATE_CAPACITY];
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint32_t   words[MAX_WORD_COUNT];
+      Diagnostic diagnostics[MAX_DIAGNOSTIC_COUNT];
+      Symbol     symbols[SYMBOL_CAPACITY];
+      Fixup      fixups[MAX_FIXUP_COUNT];
+      Assembler  assembler = {.words   = words,   .maxWordCount   = MAX_WORD_COUNT,  .diagnostics   = diagnostics, .maxDiagnosticCount = MAX_DIAGNOSTIC_COUNT,
+                              .symbols = symbols, .symbolCapacity = SYMBOL_CAPACITY, .fixups        = fixups,      .maxFixupCount      = MAX_FIXUP_COUNT};
+      resetAssembler(&assembler);
+      assemble(&assembler, (uint8_t*)testcase->source, strlen(testcase->source));
+      expectEqual(testcase, &testFailed, "diagnostic count", 0, assembler.diagnosticCount);
+
+      ExecutionTime executionTime = analyzeExecutionTime(words, assembler.wordCount, 0, states, STATE_CAPACITY);
+
+      expectEqual(testcase, &testFailed, "status", testcase->expectedStatus, executionTime.status);
+      if (testcase->expectedStatus == EXECUTION_TIME_BOUNDED) {
+         expectEqual(testcase, &testFailed, "best case cycles", testcase->expectedBestCaseCycleCount, executionTime.bestCaseCycleCount);
+         expectEqual(testcase, &testFailed, "worst case cycles", testcase->expectedWorstCaseCycleCount, executionTime.worstCaseCycleCount);
+      } else {
+         expectEqual(testcase, &testFailed, "command index", testcase->expectedCommandIndex, executionTime.commandIndex);
+      }
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
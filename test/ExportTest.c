@@ -0,0 +1,110 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/Export.h"
+
+#define MAX_OUTPUT_LENGTH  1024
+#define MAX_CAPACITY       64
+#define C_ARRAY_COMMENT    "// load it with ulp_load_binary(0, ulp_program, sizeof(ulp_program) / sizeof(uint32_t))\n"
+
+// header of a binary containing two commands (nop and halt) followed by them
+static const uint8_t IMAGE[] = {0x75, 0x6c, 0x70, 0x00, 0x0c, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0xb0};
+
+typedef struct {
+   char        *name;
+   char        *format;
+   size_t      imageSize;           // number of bytes of IMAGE to export
+   size_t      capacity;
+   bool        expectedValid;
+   char        *expectedOutput;
+   uint32_t    expectedCrc;
+} Testcase;
+
+Testcase testcases[] = {
+   {"invalid format",            "elf", 20, 64, false, "", 0},
+   {"Base64 header only",        "bin", 12, 64, true,  "Base64 of 12 bytes:\ndWxwAAwACAAAAAAA\nCRC-32: 0xd04726ce\n", 0xd04726ce},
+   {"Base64 one padding byte",   "bin", 20, 8,  true,  "Base64 of 20 bytes:\ndWxwAAwACAAAAAAAAAAAQAAAALA=\nCRC-32: 0xae592882\n", 0xae592882},
+   {"Base64 two padding bytes",  "bin", 19, 16, true,  "Base64 of 19 bytes:\ndWxwAAwACAAAAAAAAAAAQAAAAA==\nCRC-32: 0x8728b87e\n", 0x8728b87e},
+   {"Intel HEX one record",      "hex", 12, 64, true,  ":0C000000756C70000C000800000000008F\n:00000001FF\nCRC-32: 0xd04726ce\n", 0xd04726ce},
+   {"Intel HEX two records",     "hex", 20, 16, true,  ":10000000756C70000C00080000000000000000404B\n:04001000000000B03C\n:00000001FF\nCRC-32: 0xae592882\n", 0xae592882},
+   {"C array one line",          "c",   12, 64, true,  C_ARRAY_COMMENT "const uint8_t ulp_program[12] __attribute__((aligned(4))) = {\n"
+                                                       "   0x75, 0x6c, 0x70, 0x00, 0x0c, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00\n};\n// CRC-32: 0xd04726ce\n", 0xd04726ce},
+   {"C array two lines",         "c",   20, 32, true,  C_ARRAY_COMMENT "const uint8_t ulp_program[20] __attribute__((aligned(4))) = {\n"
+                                                       "   0x75, 0x6c, 0x70, 0x00, 0x0c, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,\n"
+                                                       "   0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0xb0\n};\n// CRC-32: 0xae592882\n", 0xae592882},
+
+   {NULL, NULL, 0, 0, false, NULL, 0} // end
+};
+
+typedef struct {
+   uint8_t  output[MAX_OUTPUT_LENGTH];
+   size_t   outputLength;
+   size_t   maxWriteLength;
+} FakeSink;
+
+static void writeToFakeSink(void *context, const uint8_t *bytes, size_t byteCount) {
+   FakeSink *sink = context;
+   memcpy(sink->output + sink->outputLength, bytes, byteCount);
+   sink->outputLength  += byteCount;
+   sink->maxWriteLength = byteCount > sink->maxWriteLength ? byteCount : sink->maxWriteLength;
+}
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: 0x%lx\n", name, expected);
+      printf("\t                        actual:   0x%lx\n\n", actual);
+   }
+}
+
+static void expectEqualOutput(Testcase *testcase, bool *testFailed, const uint8_t *expected, size_t expectedLength, const uint8_t *actual, size_t actualLength) {
+   if (expectedLength != actualLength || memcmp(expected, actual, actualLength) != 0) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: \"%.*s\"\n", "output", (int)expectedLength, expected);
+      printf("\t                        actual:   \"%.*s\"\n\n", (int)actualLength, actual);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint8_t block[MAX_CAPACITY];
+      FakeSink sink       = {{0}, 0, 0};
+      OutputBuffer output = {block, testcase->capacity, 0, &sink, writeToFakeSink};
+      ExportFormat format;
+
+      bool isValid = parseExportFormat(testcase->format, &format);
+      expectEqual(testcase, &testFailed, "valid format", testcase->expectedValid, isValid);
+
+      if (isValid) {
+         uint32_t crc          = exportImage(&output, IMAGE, testcase->imageSize, format);
+         size_t expectedLength = strlen(testcase->expectedOutput);
+         expectEqual(testcase, &testFailed, "CRC", testcase->expectedCrc, crc);
+         expectEqualOutput(testcase, &testFailed, (const uint8_t*)testcase->expectedOutput, expectedLength, sink.output, sink.outputLength);
+         expectEqual(testcase, &testFailed, "chunk size", true, sink.maxWriteLength <= testcase->capacity);
+         expectEqual(testcase, &testFailed, "flushed", 0, output.length);
+      }
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
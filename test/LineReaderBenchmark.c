@@ -0,0 +1,173 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "../main/LineReader.h"
+
+// Sends a program through a pty (like a terminal pasting it into the serial console of the ESP32), receives it with
+// LineReader and writes the throughput as JSON to stdout. The sender respects XON/XOFF.
+//
+// usage: lineReaderBenchmark [lineCount] [ringCapacity] [processingMicrosecondsPerLine]
+
+#define DEFAULT_LINE_COUNT                1000
+#define DEFAULT_RING_CAPACITY             4096
+#define MAX_LINE_LENGTH                   255
+#define SEND_CHUNK_SIZE                   64
+#define RECEIVE_TIMEOUT_IN_MILLISECONDS   100
+
+static const char *LINES[]       = {"move r0, 0", "loop: add r0, r0, 1", "jumpr loop, 100, lt", "st r0, r1, 4", "halt"};
+static const char *TERMINATORS[] = {"\r", "\n", "\r\n"};
+
+typedef struct {
+   int      masterFile;
+   char     *text;
+   size_t   textLength;
+   size_t   xoffCount;
+} Sender;
+
+static size_t readFromPty(void *context, uint8_t *buffer, size_t maxByteCount, uint32_t timeoutInMilliseconds) {
+   int file = *(int*)context;
+   struct pollfd pollDescriptor = {file, POLLIN, 0};
+   if (poll(&pollDescriptor, 1, timeoutInMilliseconds) <= 0) {
+      return 0;
+   }
+   ssize_t count = read(file, buffer, maxByteCount);
+   return count > 0 ? count : 0;
+}
+
+static void writeToPty(void *context, const uint8_t *bytes, size_t byteCount) {
+   if (write(*(int*)context, bytes, byteCount) != (ssize_t)byteCount) {
+      fprintf(stderr, "ERROR: failed to send flow control character\n");
+   }
+}
+
+// Returns true if sending is allowed (XON received after the last XOFF).
+static bool updateFlowControl(Sender *sender, bool isAllowed, int timeoutInMilliseconds) {
+   uint8_t received[16];
+   struct pollfd pollDescriptor = {sender->masterFile, POLLIN, 0};
+   while (poll(&pollDescriptor, 1, isAllowed ? 0 : timeoutInMilliseconds) > 0) {
+      ssize_t count = read(sender->masterFile, received, sizeof(received));
+      for (ssize_t index = 0; index < count; index++) {
+         if (received[index] == XOFF) {
+            isAllowed = false;
+            sender->xoffCount++;
+         } else if (received[index] == XON) {
+            isAllowed = true;
+         }
+      }
+      if (count <= 0 || isAllowed) {
+         break;
+      }
+   }
+   return isAllowed;
+}
+
+static void* sendText(void *parameters) {
+   Sender *sender = parameters;
+   bool isAllowed = true;
+
+   for (size_t position = 0; position < sender->textLength;) {
+      isAllowed = updateFlowControl(sender, isAllowed, 10);
+      if (isAllowed) {
+         size_t count  = sender->textLength - position < SEND_CHUNK_SIZE ? sender->textLength - position : SEND_CHUNK_SIZE;
+         ssize_t written = write(sender->masterFile, sender->text + position, count);
+         position += written > 0 ? written : 0;
+      }
+   }
+   return NULL;
+}
+
+static double secondsSince(struct timespec *start) {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void busyWait(uint32_t microseconds) {
+   struct timespec start;
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   while (secondsSince(&start) * 1e6 < microseconds);
+}
+
+int main(int argc, char* argv[]) {
+   size_t lineCount                   = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_LINE_COUNT;
+   size_t ringCapacity                = argc > 2 ? strtoul(argv[2], NULL, 0) : DEFAULT_RING_CAPACITY;
+   uint32_t processingMicroseconds    = argc > 3 ? strtoul(argv[3], NULL, 0) : 0;
+   size_t lineTypeCount               = sizeof(LINES) / sizeof(LINES[0]);
+
+   if ((ringCapacity & (ringCapacity - 1)) != 0 || ringCapacity < 4) {
+      fprintf(stderr, "ERROR: ringCapacity needs to be a power of 2.\n");
+      return 1;
+   }
+
+   Sender sender = {.text = malloc(lineCount * (MAX_LINE_LENGTH + 2))};
+   for (size_t index = 0; index < lineCount; index++) {
+      sender.textLength += sprintf(sender.text + sender.textLength, "%s%s", LINES[index % lineTypeCount], TERMINATORS[index % 3]);
+   }
+
+   sender.masterFile = posix_openpt(O_RDWR | O_NOCTTY);
+   if (sender.masterFile < 0 || grantpt(sender.masterFile) != 0 || unlockpt(sender.masterFile) != 0) {
+      fprintf(stderr, "ERROR: failed to open a pty.\n");
+      return 1;
+   }
+   int slaveFile = open(ptsname(sender.masterFile), O_RDWR | O_NOCTTY);
+   struct termios attributes;
+   tcgetattr(slaveFile, &attributes);
+   cfmakeraw(&attributes);
+   tcsetattr(slaveFile, TCSANOW, &attributes);
+
+   uint8_t *ringBuffer = malloc(ringCapacity);
+   uint8_t line[MAX_LINE_LENGTH + 1];
+   ByteStream stream   = {&slaveFile, readFromPty, writeToPty};
+   LineReader reader;
+   LineStatus status;
+   initializeLineReader(&reader, &stream, ringBuffer, ringCapacity, line, MAX_LINE_LENGTH);
+
+   struct timespec start;
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   pthread_t senderThread;
+   pthread_create(&senderThread, NULL, sendText, &sender);
+
+   size_t receivedLineCount = 0;
+   size_t errorCount        = 0;
+   while (receivedLineCount < lineCount) {
+      if (receiveBytes(&reader, RECEIVE_TIMEOUT_IN_MILLISECONDS) == 0 && reader.head == reader.tail) {
+         break;
+      }
+      while (receivedLineCount < lineCount && getNextLine(&reader, &status)) {
+         if (status != LINE_COMPLETE || strcmp((char*)line, LINES[receivedLineCount % lineTypeCount]) != 0) {
+            errorCount++;
+         }
+         receivedLineCount++;
+         busyWait(processingMicroseconds);
+      }
+   }
+   double elapsedSeconds = secondsSince(&start);
+   errorCount += lineCount - receivedLineCount;
+   pthread_join(senderThread, NULL);
+
+   printf("{\n");
+   printf("   \"lineCount\": %zu,\n", lineCount);
+   printf("   \"byteCount\": %zu,\n", sender.textLength);
+   printf("   \"ringCapacity\": %zu,\n", ringCapacity);
+   printf("   \"processingMicrosecondsPerLine\": %u,\n", processingMicroseconds);
+   printf("   \"seconds\": %.6f,\n", elapsedSeconds);
+   printf("   \"linesPerSecond\": %.0f,\n", receivedLineCount / elapsedSeconds);
+   printf("   \"megabytesPerSecond\": %.3f,\n", sender.textLength / elapsedSeconds / 1e6);
+   printf("   \"xoffCount\": %zu,\n", sender.xoffCount);
+   printf("   \"errorCount\": %zu\n", errorCount);
+   printf("}\n");
+
+   close(slaveFile);
+   close(sender.masterFile);
+   free(ringBuffer);
+   free(sender.text);
+   return errorCount == 0 ? 0 : 1;
+}
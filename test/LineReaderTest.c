@@ -0,0 +1,135 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/LineReader.h"
+
+#define RING_CAPACITY      16
+#define MAX_LINE_LENGTH    8
+#define MAX_OUTPUT_LENGTH  256
+
+typedef struct {
+   char     *name;
+   char     *input;
+   size_t   maxBytesPerRead;
+   size_t   readsBeforeFraming;     // number of receiveBytes calls before the lines get framed
+   char     *expectedLines;         // each line followed by "|" ("!|" if it was too long), bytes after a line "raw" get
+                                    // taken without framing and are followed by "#"
+   char     *expectedFlowControl;   // bytes written to the stream
+} Testcase;
+
+Testcase testcases[] = {
+   {"CR",                        "nop\rhalt\r",                  64, 1, "nop|halt|",                     ""},
+   {"LF",                        "nop\nhalt\n",                  64, 1, "nop|halt|",                     ""},
+   {"CRLF",                      "nop\r\nhalt\r\n",              64, 1, "nop|halt|",                     ""},
+   {"CRLF split between reads",  "nop\r\nhalt\r\n",              4,  1, "nop|halt|",                     ""},
+   {"empty lines",               "\r\r\n\n",                     64, 1, "|||",                           ""},
+   {"LF CR",                     "nop\n\rhalt\r",                64, 1, "nop||halt|",                    ""},
+   {"incomplete line",           "nop\rhal",                     64, 1, "nop|",                          ""},
+   {"one byte per read",         "wait 1\rhalt\r",               1,  1, "wait 1|halt|",                  ""},
+   {"wrap around",               "wait 10\rwait 20\rwait 30\rwait 40\r", 5, 1, "wait 10|wait 20|wait 30|wait 40|", ""},
+   {"maximum line length",       "12345678\r",                   64, 1, "12345678|",                     ""},
+   {"line too long",             "123456789\rnop\r",             64, 1, "12345678!|nop|",                "\x13\x11"},
+   {"line too long over reads",  "1234567890abcdefghij\rnop\r",  3,  1, "12345678!|nop|",                ""},
+   {"XOFF when 3/4 filled",      "123\r123\r123\r123\r",         4,  3, "123|123|123|123|",              "\x13\x11"},
+   {"ring buffer full",          "abcdefghijklmnopqrstuvwxyz\r", 8,  4, "abcdefgh!|",                    "\x13\x11"},
+   {"raw bytes after LF",        "raw\n\r\x01\n",                 64, 1, "raw|\r\x01\n#",                  ""},
+   {"raw bytes after CRLF",      "raw\r\n\x02\r",                 64, 1, "raw|\x02\r#",                   ""},
+   {"raw bytes over reads",      "raw\rabcdefghijklmnopq",       3,  1, "raw|abcdefghijklmnopq#",        ""},
+
+   {NULL, NULL, 0, 0, NULL, NULL} // end
+};
+
+typedef struct {
+   const char  *input;
+   size_t      inputLength;
+   size_t      position;
+   size_t      maxBytesPerRead;
+   char        written[MAX_OUTPUT_LENGTH];
+   size_t      writtenLength;
+} FakeStream;
+
+static size_t readFromFakeStream(void *context, uint8_t *buffer, size_t maxByteCount, uint32_t timeoutInMilliseconds) {
+   FakeStream *stream = context;
+   size_t count       = stream->inputLength - stream->position;
+   count              = count < maxByteCount ? count : maxByteCount;
+   count              = count < stream->maxBytesPerRead ? count : stream->maxBytesPerRead;
+   memcpy(buffer, stream->input + stream->position, count);
+   stream->position += count;
+   return count;
+}
+
+static void writeToFakeStream(void *context, const uint8_t *bytes, size_t byteCount) {
+   FakeStream *stream = context;
+   memcpy(stream->written + stream->writtenLength, bytes, byteCount);
+   stream->writtenLength += byteCount;
+}
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqualText(Testcase *testcase, bool *testFailed, const char *name, const char *expected, const char *actual) {
+   if (strcmp(expected, actual) != 0) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: \"%s\"\n", name, expected);
+      printf("\t                        actual:   \"%s\"\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint8_t ringBuffer[RING_CAPACITY];
+      uint8_t line[MAX_LINE_LENGTH + 1];
+      char lines[MAX_OUTPUT_LENGTH] = "";
+      FakeStream fakeStream         = {testcase->input, strlen(testcase->input), 0, testcase->maxBytesPerRead};
+      ByteStream stream             = {&fakeStream, readFromFakeStream, writeToFakeStream};
+      LineReader reader;
+      LineStatus status;
+      bool isRaw = false;
+
+      initializeLineReader(&reader, &stream, ringBuffer, RING_CAPACITY, line, MAX_LINE_LENGTH);
+
+      bool receivedBytes = true;
+      while (receivedBytes) {
+         receivedBytes = false;
+         for (size_t read = 0; read < testcase->readsBeforeFraming; read++) {
+            receivedBytes |= receiveBytes(&reader, 0) > 0;
+         }
+         while (!isRaw && getNextLine(&reader, &status)) {
+            strcat(lines, (char*)line);
+            strcat(lines, status == LINE_TOO_LONG ? "!|" : "|");
+            isRaw = strcmp((char*)line, "raw") == 0;
+         }
+         if (isRaw) {
+            size_t length = strlen(lines);
+            length += takeBytes(&reader, (uint8_t*)lines + length, MAX_OUTPUT_LENGTH - length - 2);
+            lines[length] = 0;
+         }
+      }
+      if (isRaw) {
+         strcat(lines, "#");
+      }
+
+      fakeStream.written[fakeStream.writtenLength] = 0;
+      expectEqualText(testcase, &testFailed, "lines", testcase->expectedLines, lines);
+      expectEqualText(testcase, &testFailed, "flow control", testcase->expectedFlowControl, fakeStream.written);
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../main/StringUtils.h"
+#include "AllocationCounter.h"
+
+// Compares normalizeLine with the former pipeline of the console (copy of the line, trim, toLowerCase and another
+// copy, trim, toLowerCase and normalizeTokenSeparators in getCommandBytesFor) for growing line lengths and writes
+// the results as JSON to stdout. A constant nsPerByte of normalizeLine over all lengths shows its linear time.
+//
+// usage: normalizerBenchmark [bytesPerLength]
+
+#define DEFAULT_BYTES_PER_LENGTH    (64 * 1024 * 1024)
+#define MIN_LINE_LENGTH             16
+#define MAX_LINE_LENGTH             16384
+#define MAX_TOKEN_COUNT             2
+#define PATTERN                     "  MOVE R0,\t0x12 "    // 16 bytes -> each line ends behind a whole pattern
+
+typedef struct {
+   double nanosecondsPerByte;
+   size_t allocationCount;
+} Measurement;
+
+static uint64_t nowInNanoseconds() {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static bool isLegacyWhitespace(uint8_t character) {
+   return character == ' ' || character == '\t' || character == '\n';
+}
+
+static void legacyTrim(uint8_t *text) {
+   size_t indexOfFirstNonWhitespace = 0;
+   while (text[indexOfFirstNonWhitespace] != 0 && isLegacyWhitespace(text[indexOfFirstNonWhitespace])) {
+      indexOfFirstNonWhitespace++;
+   }
+   if (indexOfFirstNonWhitespace > 0) {
+      size_t offset = 0;
+      while (text[indexOfFirstNonWhitespace + offset] != 0) {
+         text[offset] = text[indexOfFirstNonWhitespace + offset];
+         offset++;
+      }
+      text[offset] = 0;
+   }
+   size_t length = strlen((char*)text);
+   while (length > 0 && isLegacyWhitespace(text[length - 1])) {
+      length--;
+   }
+   text[length] = 0;
+}
+
+static void legacyToLowerCase(uint8_t *text) {
+   for (uint8_t *character = text; *character != 0; character++) {
+      *character = tolower(*character);
+   }
+}
+
+static void legacyNormalizeTokenSeparators(uint8_t *text) {
+   for (size_t index = 0; text[index] != 0; index++) {
+      text[index] = text[index] == ',' ? ' ' : text[index];
+   }
+   bool previousCharWasWhitespace = false;
+   size_t insertionIndex          = 0;
+   for (size_t index = 0; text[index] != 0; index++) {
+      bool isWhitespace = isLegacyWhitespace(text[index]);
+      if (!isWhitespace || !previousCharWasWhitespace) {
+         text[insertionIndex++] = text[index];
+      }
+      previousCharWasWhitespace = isWhitespace;
+   }
+   text[insertionIndex] = 0;
+}
+
+static size_t legacyNormalize(uint8_t *line, size_t lineLength, uint8_t *firstCopy, uint8_t *secondCopy) {
+   memcpy(firstCopy, line, lineLength);
+   firstCopy[lineLength] = 0;
+   legacyTrim(firstCopy);
+   legacyToLowerCase(firstCopy);
+   strcpy((char*)secondCopy, (char*)firstCopy);
+   legacyTrim(secondCopy);
+   legacyToLowerCase(secondCopy);
+   legacyNormalizeTokenSeparators(secondCopy);
+   return strlen((char*)secondCopy);
+}
+
+static size_t fusedNormalize(uint8_t *line, size_t lineLength, uint8_t *firstCopy, uint8_t *secondCopy) {
+   TokenView tokens[MAX_TOKEN_COUNT];
+   return normalizeLine(line, lineLength, tokens, MAX_TOKEN_COUNT, NULL);
+}
+
+static size_t restoreOnly(uint8_t *line, size_t lineLength, uint8_t *firstCopy, uint8_t *secondCopy) {
+   return line[0];
+}
+
+// Each repetition restores the line from source before normalizing it -> the restore gets measured on its own and
+// subtracted.
+static uint64_t run(size_t (*normalize)(uint8_t*, size_t, uint8_t*, uint8_t*), const uint8_t *source, size_t lineLength,
+                    size_t repetitions, uint8_t *line, uint8_t *firstCopy, uint8_t *secondCopy, volatile size_t *sink) {
+   uint64_t start = nowInNanoseconds();
+   for (size_t repetition = 0; repetition < repetitions; repetition++) {
+      memcpy(line, source, lineLength);
+      *sink += normalize(line, lineLength, firstCopy, secondCopy);
+   }
+   return nowInNanoseconds() - start;
+}
+
+static Measurement measure(size_t (*normalize)(uint8_t*, size_t, uint8_t*, uint8_t*), const uint8_t *source, size_t lineLength,
+                           size_t repetitions, uint64_t restoreNanoseconds) {
+   uint8_t *line        = malloc(lineLength + 1);
+   uint8_t *firstCopy   = malloc(lineLength + 1);
+   uint8_t *secondCopy  = malloc(lineLength + 1);
+   volatile size_t sink = 0;
+
+   startCountingAllocations();
+   uint64_t elapsed       = run(normalize, source, lineLength, repetitions, line, firstCopy, secondCopy, &sink);
+   size_t allocationCount = stopCountingAllocations();
+
+   elapsed = elapsed > restoreNanoseconds ? elapsed - restoreNanoseconds : 0;
+   Measurement measurement = {(double)elapsed / ((double)lineLength * repetitions), allocationCount};
+   free(line);
+   free(firstCopy);
+   free(secondCopy);
+   return measurement;
+}
+
+// Both normalizers have to produce the same line and the views have to point into it.
+static bool verify(const uint8_t *source, size_t lineLength) {
+   uint8_t *line        = malloc(lineLength + 1);
+   uint8_t *firstCopy   = malloc(lineLength + 1);
+   uint8_t *secondCopy  = malloc(lineLength + 1);
+   TokenView tokens[MAX_TOKEN_COUNT];
+   size_t tokenCount    = 0;
+
+   memcpy(line, source, lineLength);
+   legacyNormalize(line, lineLength, firstCopy, secondCopy);
+   size_t length  = normalizeLine(line, lineLength, tokens, MAX_TOKEN_COUNT, &tokenCount);
+   bool isEqual   = strcmp((char*)line, (char*)secondCopy) == 0;
+   for (size_t index = 0; index < tokenCount && index < MAX_TOKEN_COUNT; index++) {
+      isEqual = isEqual && tokens[index].start >= line && tokens[index].start + tokens[index].length <= line + length;
+   }
+   free(line);
+   free(firstCopy);
+   free(secondCopy);
+   return isEqual;
+}
+
+int main(int argc, char* argv[]) {
+   size_t bytesPerLength = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_BYTES_PER_LENGTH;
+   bytesPerLength        = bytesPerLength < MAX_LINE_LENGTH ? MAX_LINE_LENGTH : bytesPerLength;
+   uint8_t source[MAX_LINE_LENGTH];
+   bool   isFirstLength  = true;
+   bool   allEqual       = true;
+   size_t patternLength  = strlen(PATTERN);
+
+   for (size_t index = 0; index < MAX_LINE_LENGTH; index++) {
+      source[index] = PATTERN[index % patternLength];
+   }
+
+   printf("{\n   \"benchmark\": \"normalizeLine\",\n   \"bytesPerLength\": %zu,\n   \"lengths\": [\n", bytesPerLength);
+   for (size_t lineLength = MIN_LINE_LENGTH; lineLength <= MAX_LINE_LENGTH; lineLength *= 4) {
+      size_t repetitions          = bytesPerLength / lineLength;
+      bool isEqual                = verify(source, lineLength);
+      Measurement restore         = measure(restoreOnly, source, lineLength, repetitions, 0);
+      uint64_t restoreNanoseconds = restore.nanosecondsPerByte * lineLength * repetitions;
+      Measurement fused           = measure(fusedNormalize, source, lineLength, repetitions, restoreNanoseconds);
+      Measurement legacy          = measure(legacyNormalize, source, lineLength, repetitions, restoreNanoseconds);
+      allEqual                    = allEqual && isEqual;
+
+      printf("%s      {\"lineLength\": %zu, \"repetitions\": %zu, \"sameOutput\": %s, \"nsPerByte\": %.3f, \"legacyNsPerByte\": %.3f, \"speedup\": %.2f, \"mallocCalls\": %zu}",
+         isFirstLength ? "" : ",\n", lineLength, repetitions, isEqual ? "true" : "false", fused.nanosecondsPerByte, legacy.nanosecondsPerByte,
+         fused.nanosecondsPerByte > 0 ? legacy.nanosecondsPerByte / fused.nanosecondsPerByte : 0, fused.allocationCount);
+      isFirstLength = false;
+   }
+   printf("\n   ]\n}\n");
+
+   return allEqual ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/Assembler.h"
+#include "../main/Optimizer.h"
+
+#define MAX_WORD_COUNT        32
+#define MAX_DIAGNOSTIC_COUNT  1
+#define SYMBOL_CAPACITY       16
+#define MAX_FIXUP_COUNT       4
+#define NO_VARIABLE           -1
+#define VARIABLE_WORD         0x00000007
+
+typedef struct {
+   char                 *name;
+   char                 *source;
+   char                 *expectedSource;        // NULL -> the words do not change
+   int                  variableIndex;          // the word at this index gets replaced by a variable in both programs
+   OptimizationStatus   expectedStatus;
+   size_t               expectedRemovedWordCount;
+   size_t               expectedFirstModifiedIndex;
+   uint32_t             expectedSavedCycleCount;
+} Testcase;
+
+Testcase testcases[] = {
+   {"nothing to optimize",       "move r0, 1\nhalt",                             NULL,                                NO_VARIABLE, OPTIMIZATION_DONE,          0, 2, 0},
+   {"nop",                       "nop\nmove r0, 1\nnop\nnop\nhalt",              "move r0, 1\nhalt",                  NO_VARIABLE, OPTIMIZATION_DONE,          3, 0, 18},
+   {"move to itself",            "move r1, r1\nmove r0, 2\nhalt",                "move r0, 2\nhalt",                  NO_VARIABLE, OPTIMIZATION_DONE,          1, 0, 10},
+   {"move sets flags for jump",  "move r1, r1\njump 0, eq\nhalt",                NULL,                                NO_VARIABLE, OPTIMIZATION_DONE,          0, 3, 0},
+   {"move before halt",          "move r1, r1\nwait 5\nhalt",                    "wait 5\nhalt",                      NO_VARIABLE, OPTIMIZATION_DONE,          1, 0, 10},
+   {"move to other register",    "move r1, r2\nhalt",                            NULL,                                NO_VARIABLE, OPTIMIZATION_DONE,          0, 2, 0},
+   {"add 0",                     "add r1, r2, 0\nhalt",                          "move r1, r2\nhalt",                 NO_VARIABLE, OPTIMIZATION_DONE,          0, 0, 0},
+   {"add 0 to itself",           "add r2, r2, 0\nadd r2, r2, 1\nhalt",           "add r2, r2, 1\nhalt",               NO_VARIABLE, OPTIMIZATION_DONE,          1, 0, 10},
+   {"add 1",                     "add r1, r2, 1\nhalt",                          NULL,                                NO_VARIABLE, OPTIMIZATION_DONE,          0, 2, 0},
+   {"merge waits",               "wait 10\nwait 20\nwait 30\nhalt",              "wait 60\nhalt",                     NO_VARIABLE, OPTIMIZATION_DONE,          2, 0, 12},
+   {"merge waits around nop",    "wait 10\nnop\nwait 20\nhalt",                  "wait 30\nhalt",                     NO_VARIABLE, OPTIMIZATION_DONE,          2, 0, 12},
+   {"waits exceeding 16 bit",    "wait 65000\nwait 1000\nhalt",                  NULL,                                NO_VARIABLE, OPTIMIZATION_DONE,          0, 3, 0},
+   {"wait is jump target",       "wait 10\nloop: wait 20\njumpr loop, 1, lt\nhalt", NULL,                             NO_VARIABLE, OPTIMIZATION_DONE,          0, 4, 0},
+   {"jumpr forward",             "jumpr end, 1, lt\nnop\nnop\nend: halt",        "jumpr end, 1, lt\nend: halt",       NO_VARIABLE, OPTIMIZATION_DONE,          2, 0, 12},
+   {"jumpr backward",            "loop: add r0, r0, 1\nnop\njumpr loop, 9, lt\nhalt", "loop: add r0, r0, 1\njumpr loop, 9, lt\nhalt", NO_VARIABLE, OPTIMIZATION_DONE, 1, 1, 6},
+   {"jumps to removed nop",      "stage_rst\nloop: nop\nstage_inc 1\njumps loop, 3, lt\nhalt", "stage_rst\nloop: stage_inc 1\njumps loop, 3, lt\nhalt", NO_VARIABLE, OPTIMIZATION_DONE, 1, 1, 6},
+   {"absolute jump",             "nop\njump end\nnop\nend: halt",                "jump end\nend: halt",               NO_VARIABLE, OPTIMIZATION_DONE,          2, 0, 12},
+   {"jump behind program",       "jump 16\nnop\nhalt",                           "jump 12\nhalt",                     NO_VARIABLE, OPTIMIZATION_DONE,          1, 0, 6},
+   {"nop in front of variable",  "nop\nnop\nmove r0, 0\nnop\nhalt",              "nop\nnop\nmove r0, 0\nhalt",        1,           OPTIMIZATION_DONE,          1, 3, 6},
+   {"indirect jump",             "nop\njump r0\nhalt",                           NULL,                                NO_VARIABLE, OPTIMIZATION_INDIRECT_JUMP, 0, 3, 0},
+   {"jump in front of program",  "nop\njumpr -8, 1, lt\nhalt",                   NULL,                                NO_VARIABLE, OPTIMIZATION_INVALID_JUMP,  0, 3, 0},
+
+   {NULL, NULL, NULL, NO_VARIABLE, OPTIMIZATION_DONE, 0, 0, 0} // end
+};
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: 0x%lx\n", name, expected);
+      printf("\t                        actual:   0x%lx\n\n", actual);
+   }
+}
+
+static size_t assembleProgram(Testcase *testcase, bool *testFailed, const char *source, uint32_t *words) {
+   Diagnostic diagnostics[MAX_DIAGNOSTIC_COUNT];
+   Symbol     symbols[SYMBOL_CAPACITY];
+   Fixup      fixups[MAX_FIXUP_COUNT];
+   Assembler  assembler = {.words   = words,   .maxWordCount   = MAX_WORD_COUNT,  .diagnostics   = diagnostics, .maxDiagnosticCount = MAX_DIAGNOSTIC_COUNT,
+                           .symbols = symbols, .symbolCapacity = SYMBOL_CAPACITY, .fixups        = fixups,      .maxFixupCount      = MAX_FIXUP_COUNT};
+   resetAssembler(&assembler);
+   assemble(&assembler, (uint8_t*)source, strlen(source));
+   expectEqual(testcase, testFailed, "diagnostic count", 0, assembler.diagnosticCount);
+
+   if (testcase->variableIndex != NO_VARIABLE) {
+      words[testcase->variableIndex] = VARIABLE_WORD;
+   }
+   return assembler.wordCount;
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint32_t words[MAX_WORD_COUNT];
+      uint32_t expectedWords[MAX_WORD_COUNT];
+      size_t   newIndices[MAX_WORD_COUNT + 1];
+
+      size_t wordCount         = assembleProgram(testcase, &testFailed, testcase->source, words);
+      const char *expected     = testcase->expectedSource != NULL ? testcase->expectedSource : testcase->source;
+      size_t expectedWordCount = assembleProgram(testcase, &testFailed, expected, expectedWords);
+
+      Optimization optimization = optimizeProgram(words, wordCount, newIndices);
+
+      expectEqual(testcase, &testFailed, "status", testcase->expectedStatus, optimization.status);
+      expectEqual(testcase, &testFailed, "removed words", testcase->expectedRemovedWordCount, optimization.removedWordCount);
+      expectEqual(testcase, &testFailed, "saved cycles", testcase->expectedSavedCycleCount, optimization.savedCycleCount);
+      expectEqual(testcase, &testFailed, "first modified index", testcase->expectedFirstModifiedIndex, optimization.firstModifiedIndex);
+      if (testcase->expectedStatus == OPTIMIZATION_DONE) {
+         expectEqual(testcase, &testFailed, "word count", expectedWordCount, optimization.wordCount);
+         expectEqual(testcase, &testFailed, "new word count", expectedWordCount, newIndices[wordCount]);
+         for (size_t index = 0; index < expectedWordCount && index < optimization.wordCount; index++) {
+            expectEqual(testcase, &testFailed, "word", expectedWords[index], words[index]);
+         }
+      }
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
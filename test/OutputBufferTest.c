@@ -0,0 +1,111 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/OutputBuffer.h"
+
+#define MAX_OUTPUT_LENGTH  128
+#define MAX_CAPACITY       64
+
+typedef enum { TEXT, HEX_BYTE, DECIMAL } Operation;
+
+typedef struct {
+   char        *name;
+   size_t      capacity;
+   Operation   operation;
+   char        *text;
+   uint32_t    value;
+   size_t      minWidth;
+   char        *expectedOutput;
+   size_t      expectedWriteCount;    // including the write caused by the final flushOutput
+} Testcase;
+
+Testcase testcases[] = {
+   {"text",                   64, TEXT,     "list\n",              0,          0,  "list\n",              1},
+   {"empty text",             64, TEXT,     "",                    0,          0,  "",                    0},
+   {"text filling block",     8,  TEXT,     "01234567",            0,          0,  "01234567",            1},
+   {"text over blocks",       8,  TEXT,     "0123456789abcdefxy",  0,          0,  "0123456789abcdefxy",  3},
+   {"hex 0x00",               64, HEX_BYTE, NULL,                  0x00,       0,  "00",                  1},
+   {"hex 0x0f",               64, HEX_BYTE, NULL,                  0x0f,       0,  "0f",                  1},
+   {"hex 0xa5",               64, HEX_BYTE, NULL,                  0xa5,       0,  "a5",                  1},
+   {"hex 0xff",               64, HEX_BYTE, NULL,                  0xff,       0,  "ff",                  1},
+   {"hex over blocks",        1,  HEX_BYTE, NULL,                  0x3c,       0,  "3c",                  2},
+   {"decimal 0",              64, DECIMAL,  NULL,                  0,          0,  "0",                   1},
+   {"decimal 7 width 2",      64, DECIMAL,  NULL,                  7,          2,  " 7",                  1},
+   {"decimal 42 width 2",     64, DECIMAL,  NULL,                  42,         2,  "42",                  1},
+   {"decimal 507 width 2",    64, DECIMAL,  NULL,                  507,        2,  "507",                 1},
+   {"decimal max",            64, DECIMAL,  NULL,                  4294967295, 0,  "4294967295",          1},
+   {"decimal width 12",       64, DECIMAL,  NULL,                  1234,       12, "        1234",        1},
+   {"decimal over blocks",    4,  DECIMAL,  NULL,                  65535,      8,  "   65535",            2},
+
+   {NULL, 0, TEXT, NULL, 0, 0, NULL, 0} // end
+};
+
+typedef struct {
+   char     output[MAX_OUTPUT_LENGTH];
+   size_t   outputLength;
+   size_t   writeCount;
+} FakeSink;
+
+static void writeToFakeSink(void *context, const uint8_t *bytes, size_t byteCount) {
+   FakeSink *sink = context;
+   memcpy(sink->output + sink->outputLength, bytes, byteCount);
+   sink->outputLength += byteCount;
+   sink->writeCount++;
+}
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: %lu\n", name, expected);
+      printf("\t                        actual:   %lu\n\n", actual);
+   }
+}
+
+static void expectEqualText(Testcase *testcase, bool *testFailed, const char *name, const char *expected, const char *actual) {
+   if (strcmp(expected, actual) != 0) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: \"%s\"\n", name, expected);
+      printf("\t                        actual:   \"%s\"\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint8_t block[MAX_CAPACITY];
+      FakeSink sink       = {"", 0, 0};
+      OutputBuffer output = {block, testcase->capacity, 0, &sink, writeToFakeSink};
+
+      switch (testcase->operation) {
+         case TEXT:     appendText(&output, testcase->text);                                 break;
+         case HEX_BYTE: appendHexByte(&output, testcase->value);                             break;
+         case DECIMAL:  appendDecimal(&output, testcase->value, testcase->minWidth);         break;
+      }
+      flushOutput(&output);
+
+      sink.output[sink.outputLength] = 0;
+      expectEqualText(testcase, &testFailed, "output", testcase->expectedOutput, sink.output);
+      expectEqual(testcase, &testFailed, "write count", testcase->expectedWriteCount, sink.writeCount);
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
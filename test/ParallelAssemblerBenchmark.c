@@ -0,0 +1,113 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../tools/ParallelAssembler.h"
+
+// Measures the throughput of assembleInParallel for 1 to maxThreadCount threads and writes the results (MB/s, speedup
+// compared to one thread and whether the words are the same as those of assemble) as JSON to stdout.
+//
+// usage: parallelAssemblerBenchmark [sourceMegabytes] [maxThreadCount] [chunkKilobytes]
+
+#define DEFAULT_SOURCE_MEGABYTES    16
+#define REPETITIONS                 3
+#define SYMBOL_CAPACITY             1024
+#define LABEL_COUNT                 512
+
+static const char *SOURCE_LINES[] = {
+   "   move r1, 0x10          // address of the counter",
+   "   ld r0, r1, 0",
+   "   add r0, r0, 1",
+   "   st r0, r1, 0",
+   "",
+   "   // wait a little bit before reading the sensor",
+   "   wait 0x1234",
+   "   tsens r2, 100",
+   "   jumpr 8, 0x7fed, lt",
+   "   stage_inc 0xab",
+   "   jumps -4, 5, le        // loop",
+   "   reg_rd 0x3ff48400, 3, 1",
+   "   halt",
+};
+
+static uint64_t nowInNanoseconds() {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// The first lines define labels and jump back to them -> the merge has to resolve labels as well.
+static size_t createSource(char *source, size_t maxLength, size_t *lineCount) {
+   size_t length      = 0;
+   size_t sampleCount = sizeof(SOURCE_LINES) / sizeof(SOURCE_LINES[0]);
+   *lineCount         = 0;
+   for (size_t index = 0; length + 64 < maxLength; index++) {
+      if (index < LABEL_COUNT) {
+         length += sprintf(source + length, "label%zu: jumpr label%zu, 1, ge\n", index, index);
+      } else {
+         length += sprintf(source + length, "%s\n", SOURCE_LINES[index % sampleCount]);
+      }
+      (*lineCount)++;
+   }
+   return length;
+}
+
+static double megabytesPerSecond(size_t bytes, uint64_t nanoseconds) {
+   return nanoseconds > 0 ? (bytes / 1e6) / (nanoseconds / 1e9) : 0;
+}
+
+int main(int argc, char* argv[]) {
+   long   cpuCount       = sysconf(_SC_NPROCESSORS_ONLN);
+   size_t megabytes      = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SOURCE_MEGABYTES;
+   size_t maxThreadCount = argc > 2 ? strtoul(argv[2], NULL, 10) : (cpuCount > 0 ? cpuCount : 1);
+   size_t chunkSize      = argc > 3 ? strtoul(argv[3], NULL, 10) * 1024 : DEFAULT_CHUNK_SIZE_IN_BYTES;
+   size_t maxLength      = (megabytes > 0 ? megabytes : 1) * 1000000;
+
+   size_t   lineCount;
+   char     *source         = malloc(maxLength);
+   size_t   sourceLength    = createSource(source, maxLength, &lineCount);
+   uint32_t *words          = malloc(lineCount * sizeof(uint32_t));
+   uint32_t *referenceWords = malloc(lineCount * sizeof(uint32_t));
+   Fixup    *fixups         = malloc(LABEL_COUNT * sizeof(Fixup));
+   Symbol   *symbols        = malloc(SYMBOL_CAPACITY * sizeof(Symbol));
+   Diagnostic diagnostics[1];
+   Assembler  assembler = {.words   = referenceWords, .maxWordCount   = lineCount,       .diagnostics = diagnostics, .maxDiagnosticCount = 1,
+                           .symbols = symbols,        .symbolCapacity = SYMBOL_CAPACITY, .fixups      = fixups,      .maxFixupCount      = LABEL_COUNT};
+   resetAssembler(&assembler);
+   assemble(&assembler, (uint8_t*)source, sourceLength);
+   size_t   referenceCount  = assembler.wordCount;
+   bool     allEqual        = assembler.diagnosticCount == 0;
+   double   singleThreaded  = 0;
+
+   printf("{\n   \"benchmark\": \"assembleInParallel\",\n   \"sourceBytes\": %zu,\n   \"lines\": %zu,\n   \"chunkBytes\": %zu,\n   \"threads\": [\n",
+      sourceLength, lineCount, chunkSize);
+   for (size_t threadCount = 1; threadCount <= maxThreadCount; threadCount++) {
+      uint64_t nanoseconds = UINT64_MAX;
+      assembler.words      = words;
+      for (size_t repetition = 0; repetition < REPETITIONS; repetition++) {
+         resetAssembler(&assembler);
+         uint64_t start    = nowInNanoseconds();
+         assembleInParallel(&assembler, (uint8_t*)source, sourceLength, threadCount, chunkSize);
+         uint64_t duration = nowInNanoseconds() - start;
+         nanoseconds       = duration < nanoseconds ? duration : nanoseconds;
+      }
+
+      bool isEqual = assembler.diagnosticCount == 0 && assembler.wordCount == referenceCount && memcmp(words, referenceWords, referenceCount * sizeof(uint32_t)) == 0;
+      double speed = megabytesPerSecond(sourceLength, nanoseconds);
+      allEqual     = allEqual && isEqual;
+      singleThreaded = threadCount == 1 ? speed : singleThreaded;
+
+      printf("%s      {\"threads\": %zu, \"sameWords\": %s, \"MBPerSecond\": %.1f, \"speedup\": %.2f}",
+         threadCount == 1 ? "" : ",\n", threadCount, isEqual ? "true" : "false", speed, singleThreaded > 0 ? speed / singleThreaded : 0);
+   }
+   printf("\n   ]\n}\n");
+
+   free(source);
+   free(words);
+   free(referenceWords);
+   free(fixups);
+   free(symbols);
+   return allEqual ? 0 : 1;
+}
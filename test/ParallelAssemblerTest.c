@@ -0,0 +1,126 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../tools/ParallelAssembler.h"
+
+// Compares the words and diagnostics of assembleInParallel with those of assemble for several thread counts and chunk
+// sizes (small chunks put chunk boundaries next to each kind of line break).
+
+#define MAX_WORD_COUNT        1024
+#define MAX_DIAGNOSTIC_COUNT  8
+#define SYMBOL_CAPACITY       64
+#define MAX_FIXUP_COUNT       256
+#define GENERATED_LINE_COUNT  600
+
+typedef struct {
+   char   *name;
+   char   *source;
+   size_t maxWordCount;
+} Testcase;
+
+static char generatedSource[GENERATED_LINE_COUNT * 32];
+
+Testcase testcases[] = {
+   {"empty source",              "",                                                       MAX_WORD_COUNT},
+   {"single line without LF",    "halt",                                                   MAX_WORD_COUNT},
+   {"mixed line breaks",         "nop\r\nwake\rhalt\n\n\r\nnop\n\r",                       MAX_WORD_COUNT},
+   {"comments and directives",   "#include \"x.h\"\n .global entry\nentry: // start\nwake // wake\n.data\nhalt", MAX_WORD_COUNT},
+   {"erroneous lines",           "nop\nfoo\r\nhalt\njumpr 0, 0, ov\na\nb\nc\nd\ne\nf\ng\nh\ni\n", MAX_WORD_COUNT},
+   {"labels in both directions", "jump end\nloop: nop\njumpr loop, 1, ge\njumps end, 3, eq\nend: halt\nend: nop\njump missing", MAX_WORD_COUNT},
+   {"too many words",            "nop\nnop\nnop\nloop: nop\njumpr loop, 5, eq\nnop",     4},
+   {"generated program",         generatedSource,                                          MAX_WORD_COUNT},
+
+   {NULL, NULL, 0} // end
+};
+
+static const size_t THREAD_COUNTS[] = {1, 2, 3, 8};
+static const size_t CHUNK_SIZES[]   = {1, 2, 7, 64, 0};
+
+static const char *GENERATED_LINES[] = {
+   "label%zu: move r1, %zu", "   jumpr label%zu, 1, ge", "   jumps label%zu, 3, eq // to the label", "   add r0, r0, %zu",
+   "\r\n   jump label%zu", "   jumpr label%zu, 5, lt\r", "   // only a comment %zu", "   st r0, r1, %zu"
+};
+
+// Labels get defined in front of and behind the jumps to them and some jumps need to get relaxed.
+static void generateSource() {
+   size_t length  = 0;
+   size_t variant = sizeof(GENERATED_LINES) / sizeof(GENERATED_LINES[0]);
+   for (size_t index = 0; index < GENERATED_LINE_COUNT; index++) {
+      size_t labelIndex = (index * 7) % 40;
+      length += sprintf(generatedSource + length, GENERATED_LINES[index % variant], index % 8 == 0 ? index / 8 % 40 : labelIndex);
+      generatedSource[length++] = '\n';
+   }
+   generatedSource[length] = 0;
+}
+
+typedef struct {
+   uint32_t   words[MAX_WORD_COUNT];
+   Diagnostic diagnostics[MAX_DIAGNOSTIC_COUNT];
+   Symbol     symbols[SYMBOL_CAPACITY];
+   Fixup      fixups[MAX_FIXUP_COUNT];
+   Assembler  assembler;
+} Output;
+
+static void initializeOutput(Output *output, size_t maxWordCount) {
+   output->assembler = (Assembler){.words   = output->words,   .maxWordCount   = maxWordCount,    .diagnostics   = output->diagnostics, .maxDiagnosticCount = MAX_DIAGNOSTIC_COUNT,
+                                   .symbols = output->symbols, .symbolCapacity = SYMBOL_CAPACITY, .fixups        = output->fixups,      .maxFixupCount      = MAX_FIXUP_COUNT};
+   resetAssembler(&output->assembler);
+}
+
+static bool isEqual(Output *expected, Output *actual) {
+   if (expected->assembler.wordCount != actual->assembler.wordCount || expected->assembler.diagnosticCount != actual->assembler.diagnosticCount) {
+      return false;
+   }
+   for (size_t index = 0; index < expected->assembler.diagnosticCount && index < MAX_DIAGNOSTIC_COUNT; index++) {
+      if (expected->diagnostics[index].lineNumber != actual->diagnostics[index].lineNumber ||
+          expected->diagnostics[index].errorMessage != actual->diagnostics[index].errorMessage) {
+         return false;
+      }
+   }
+   return memcmp(expected->words, actual->words, expected->assembler.wordCount * sizeof(uint32_t)) == 0;
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+   Output *expected              = malloc(sizeof(Output));
+   Output *actual                = malloc(sizeof(Output));
+   generateSource();
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      size_t length   = strlen(testcase->source);
+      initializeOutput(expected, testcase->maxWordCount);
+      assemble(&expected->assembler, (uint8_t*)testcase->source, length);
+
+      for (size_t threadIndex = 0; threadIndex < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); threadIndex++) {
+         for (size_t chunkIndex = 0; chunkIndex < sizeof(CHUNK_SIZES) / sizeof(CHUNK_SIZES[0]); chunkIndex++) {
+            initializeOutput(actual, testcase->maxWordCount);
+            assembleInParallel(&actual->assembler, (uint8_t*)testcase->source, length, THREAD_COUNTS[threadIndex], CHUNK_SIZES[chunkIndex]);
+            if (!isEqual(expected, actual)) {
+               if (!testFailed) {
+                  printf("failed (testcase = \"%s\")\n\n", testcase->name);
+               }
+               testFailed = true;
+               printf("\tthreads %zu, chunk size %zu: %zu words, %zu diagnostics (expected %zu words, %zu diagnostics)\n\n",
+                      THREAD_COUNTS[threadIndex], CHUNK_SIZES[chunkIndex], actual->assembler.wordCount, actual->assembler.diagnosticCount,
+                      expected->assembler.wordCount, expected->assembler.diagnosticCount);
+            }
+         }
+      }
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+   free(expected);
+   free(actual);
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../main/ProgramStore.h"
+#include "../main/UlpBinary.h"
+#include "../tools/FileStorage.h"
+
+// Each testcase uses an empty directory as storage (files instead of the NVS of the ESP32).
+
+#define MAX_WORD_COUNT    2043
+#define MAX_IMAGE_SIZE    (ULP_PROGRAM_HEADER_SIZE_IN_BYTES + MAX_WORD_COUNT * 4)
+#define NONE              -1
+
+typedef enum {
+   SAVE_AND_LOAD,
+   LOAD_ONLY,
+   DAMAGE_IMAGE,        // flips a bit of the stored image
+   INTERRUPT_SAVE,      // saves a second program but only its image reaches the storage
+   SET_AUTORUN,
+   READ_AUTORUN         // without setting it before
+} Operation;
+
+typedef struct {
+   char        *name;
+   Operation   operation;
+   uint32_t    slot;
+   uint16_t    wordCount;
+   uint16_t    entryIndex;
+   size_t      maxImageSize;
+   StoreStatus expectedSaveStatus;
+   StoreStatus expectedLoadStatus;
+   int64_t     expectedAutorunSlot;   // NONE -> not checked
+} Testcase;
+
+Testcase testcases[] = {
+   {"one word",                SAVE_AND_LOAD,  0, 1,              0,   MAX_IMAGE_SIZE,        STORE_DONE,          STORE_DONE,          NONE},
+   {"full memory",             SAVE_AND_LOAD,  7, MAX_WORD_COUNT, 100, MAX_IMAGE_SIZE,        STORE_DONE,          STORE_DONE,          NONE},
+   {"entry index",             SAVE_AND_LOAD,  3, 20,             19,  MAX_IMAGE_SIZE,        STORE_DONE,          STORE_DONE,          NONE},
+   {"entry behind program",    SAVE_AND_LOAD,  3, 20,             20,  MAX_IMAGE_SIZE,        STORE_DONE,          STORE_CORRUPTED,     NONE},
+   {"invalid slot",            SAVE_AND_LOAD,  8, 20,             0,   MAX_IMAGE_SIZE,        STORE_INVALID_SLOT,  STORE_INVALID_SLOT,  NONE},
+   {"image too large",         SAVE_AND_LOAD,  1, 20,             0,   MAX_IMAGE_SIZE / 100,  STORE_DONE,          STORE_TOO_LARGE,     NONE},
+   {"empty slot",              LOAD_ONLY,      2, 20,             0,   MAX_IMAGE_SIZE,        STORE_DONE,          STORE_EMPTY_SLOT,    NONE},
+   {"damaged image",           DAMAGE_IMAGE,   4, 20,             0,   MAX_IMAGE_SIZE,        STORE_DONE,          STORE_CORRUPTED,     NONE},
+   {"interrupted save",        INTERRUPT_SAVE, 5, 20,             0,   MAX_IMAGE_SIZE,        STORE_DONE,          STORE_CORRUPTED,     NONE},
+   {"autorun",                 SET_AUTORUN,    6, 0,              0,   0,                     STORE_DONE,          STORE_DONE,          6},
+   {"autorun off",             SET_AUTORUN,    NO_AUTORUN_SLOT, 0, 0,  0,                     STORE_DONE,          STORE_DONE,          NO_AUTORUN_SLOT},
+   {"autorun invalid slot",    SET_AUTORUN,    8, 0,              0,   0,                     STORE_INVALID_SLOT,  STORE_DONE,          NO_AUTORUN_SLOT},
+   {"autorun not set",         READ_AUTORUN,   0, 0,              0,   0,                     STORE_DONE,          STORE_DONE,          NO_AUTORUN_SLOT},
+
+   {NULL, SAVE_AND_LOAD, 0, 0, 0, 0, STORE_DONE, STORE_DONE, NONE} // end
+};
+
+static uint8_t image[MAX_IMAGE_SIZE];
+static uint8_t loadedImage[MAX_IMAGE_SIZE];
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: %lu\n", name, expected);
+      printf("\t                        actual:   %lu\n\n", actual);
+   }
+}
+
+static void createImage(uint16_t wordCount, uint32_t seed) {
+   struct UlpBinary *header = (struct UlpBinary*)image;
+   *header = (struct UlpBinary){ULP_BINARY_MAGIC, ULP_PROGRAM_HEADER_SIZE_IN_BYTES, wordCount * 4, 0, 0};
+   for (size_t index = ULP_PROGRAM_HEADER_SIZE_IN_BYTES; index < sizeof(image); index++) {
+      image[index] = (uint8_t)(index * 31 + seed);
+   }
+}
+
+static void flipBitInFile(const char *directory, const char *key) {
+   char path[PATH_MAX];
+   snprintf(path, sizeof(path), "%s/%s", directory, key);
+   FILE *file = fopen(path, "r+b");
+   fseek(file, ULP_PROGRAM_HEADER_SIZE_IN_BYTES + 1, SEEK_SET);
+   int byte = fgetc(file);
+   fseek(file, ULP_PROGRAM_HEADER_SIZE_IN_BYTES + 1, SEEK_SET);
+   fputc(byte ^ 0x10, file);
+   fclose(file);
+}
+
+static void removeDirectory(const char *directory) {
+   char path[PATH_MAX];
+   const char *keys[] = {"image", "meta"};
+
+   for (uint32_t slot = 0; slot < PROGRAM_SLOT_COUNT; slot++) {
+      for (size_t index = 0; index < sizeof(keys) / sizeof(keys[0]); index++) {
+         snprintf(path, sizeof(path), "%s/%s%u", directory, keys[index], slot);
+         unlink(path);
+      }
+   }
+   snprintf(path, sizeof(path), "%s/autorun", directory);
+   unlink(path);
+   rmdir(directory);
+}
+
+static void testSaveAndLoad(Testcase *testcase, bool *testFailed, const ProgramStorage *storage, const char *directory) {
+   StoredProgram saved  = {0, testcase->entryIndex, testcase->wordCount, 1, 0, 0};
+   StoredProgram loaded = {0};
+   char key[MAX_STORAGE_KEY_LENGTH + 1];
+
+   createImage(testcase->wordCount, 1);
+   if (testcase->operation != LOAD_ONLY) {
+      expectEqual(testcase, testFailed, "save status", testcase->expectedSaveStatus, saveProgram(storage, testcase->slot, image, &saved));
+   }
+   if (testcase->operation == DAMAGE_IMAGE) {
+      snprintf(key, sizeof(key), "image%u", testcase->slot);
+      flipBitInFile(directory, key);
+   }
+   if (testcase->operation == INTERRUPT_SAVE) {
+      // the storage fails after the image got written
+      ProgramStorage failingStorage = *storage;
+      FileStorage readOnly          = {"/nonexistent"};
+      StoredProgram second          = {0, 0, testcase->wordCount, 0, 0, 0};
+      createImage(testcase->wordCount, 2);
+      snprintf(key, sizeof(key), "image%u", testcase->slot);
+      expectEqual(testcase, testFailed, "image written", true, storage->writeBlob(storage->context, key, image, ULP_PROGRAM_HEADER_SIZE_IN_BYTES + testcase->wordCount * 4));
+      failingStorage.context = &readOnly;
+      expectEqual(testcase, testFailed, "second save status", STORE_WRITE_FAILED, saveProgram(&failingStorage, testcase->slot, image, &second));
+   }
+
+   StoreStatus status = loadProgram(storage, testcase->slot, loadedImage, testcase->maxImageSize, &loaded);
+   expectEqual(testcase, testFailed, "load status", testcase->expectedLoadStatus, status);
+   if (status == STORE_DONE) {
+      size_t imageSize = ULP_PROGRAM_HEADER_SIZE_IN_BYTES + testcase->wordCount * 4;
+      expectEqual(testcase, testFailed, "entry index", testcase->entryIndex, loaded.entryIndex);
+      expectEqual(testcase, testFailed, "word count", testcase->wordCount, loaded.wordCount);
+      expectEqual(testcase, testFailed, "variable count", 1, loaded.variableCount);
+      expectEqual(testcase, testFailed, "crc", saved.crc, loaded.crc);
+      expectEqual(testcase, testFailed, "image equals", true, memcmp(image, loadedImage, imageSize) == 0);
+   }
+}
+
+static void testAutorun(Testcase *testcase, bool *testFailed, const ProgramStorage *storage) {
+   if (testcase->operation == SET_AUTORUN) {
+      expectEqual(testcase, testFailed, "set status", testcase->expectedSaveStatus, setAutorunSlot(storage, testcase->slot));
+   }
+   expectEqual(testcase, testFailed, "autorun slot", testcase->expectedAutorunSlot, getAutorunSlot(storage));
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      char directory[] = "/tmp/programStoreTestXXXXXX";
+      ProgramStorage storage;
+      FileStorage file;
+
+      if (mkdtemp(directory) == NULL || !initializeFileStorage(&storage, &file, directory)) {
+         failTest(testcase, &testFailed);
+         printf("\tfailed to create the directory %s\n\n", directory);
+      } else if (testcase->operation == SET_AUTORUN || testcase->operation == READ_AUTORUN) {
+         testAutorun(testcase, &testFailed, &storage);
+      } else {
+         testSaveAndLoad(testcase, &testFailed, &storage, directory);
+      }
+      removeDirectory(directory);
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../main/Scanner.h"
+
+// Compares the lines of each scanner implementation the CPU supports with the lines of a byte by byte reference split.
+// The corpus (decodedCommands and the ULP example) makes sure the assembler gets the same lines as before.
+
+#define MAX_TEXT_LENGTH    512
+#define MAX_FILE_LENGTH    (1024 * 1024)
+
+#define SIXTY_THREE_BYTES  "nop                                                            "
+
+typedef struct {
+   char   *name;
+   char   *text;
+} Testcase;
+
+Testcase testcases[] = {
+   {"empty text",                   ""},
+   {"single line without LF",       "halt"},
+   {"LF separated lines",           "nop\nmove r0, -1\nhalt\n"},
+   {"CRLF separated lines",         "nop\r\nwake\r\nhalt\r\n"},
+   {"CR separated lines",           "nop\rwake\rhalt"},
+   {"LFCR -> two line breaks",      "nop\n\rhalt"},
+   {"empty lines",                  "\n\n\r\n\r\r\n"},
+   {"comments",                     "// comment\nwake // wake / x\n/ / not\n///\nhalt/"},
+   {"comment across blocks",        SIXTY_THREE_BYTES "// comment\nhalt"},
+   {"slash at end of block",        SIXTY_THREE_BYTES "/\nhalt"},
+   {"CRLF across blocks",           SIXTY_THREE_BYTES "\r\nhalt"},
+   {"block of 64 bytes",            SIXTY_THREE_BYTES "\n"},
+   {"line longer than a block",     SIXTY_THREE_BYTES SIXTY_THREE_BYTES SIXTY_THREE_BYTES " // x\n" SIXTY_THREE_BYTES},
+   {"comment in previous block",    "// " SIXTY_THREE_BYTES SIXTY_THREE_BYTES "// second\nnop"},
+   {"many short lines",             "a\nb\nc\nd\ne\nf\ng\nh\ni\nj\nk\nl\nm\nn\no\np\nq\nr\ns\nt\nu\nv\nw\nx\ny\nz\n"
+                                    "a\nb\nc\nd\ne\nf\ng\nh\ni\nj\nk\nl\nm\nn\no\np\nq\nr\ns\nt\nu\nv\nw\nx\ny\nz//\n"},
+
+   {NULL, NULL} // end
+};
+
+static const char *IMPLEMENTATION_NAMES[] = {"scalar", "SSE2", "AVX2"};
+
+static bool isLineBreak(uint8_t character) {
+   return character == '\n' || character == '\r';
+}
+
+// the way Assembler.c split the source before using the scanner
+static bool nextReferenceLine(const uint8_t *text, size_t length, size_t *position, SourceLine *line) {
+   size_t start = *position;
+   if (start >= length) {
+      return false;
+   }
+   size_t end = start;
+   while (end < length && !isLineBreak(text[end])) {
+      end++;
+   }
+   size_t commandEnd = start;
+   while (commandEnd < end && !(text[commandEnd] == '/' && commandEnd + 1 < end && text[commandEnd + 1] == '/')) {
+      commandEnd++;
+   }
+   *line = (SourceLine){text + start, end - start, commandEnd - start};
+
+   if (end < length && text[end] == '\r') {
+      end++;
+   }
+   if (end < length && text[end] == '\n') {
+      end++;
+   }
+   *position = end;
+   return true;
+}
+
+// Returns true if the implementation returns the same lines as the reference. Prints the first difference.
+static bool compareWithReference(const char *name, const uint8_t *text, size_t length, ScannerImplementation implementation) {
+   Scanner    scanner;
+   SourceLine line;
+   SourceLine expectedLine;
+   size_t     position  = 0;
+   size_t     lineCount = 0;
+   initScanner(&scanner, text, length, implementation);
+
+   while (true) {
+      bool hasLine         = nextLine(&scanner, &line);
+      bool hasExpectedLine = nextReferenceLine(text, length, &position, &expectedLine);
+      lineCount++;
+      if (hasLine != hasExpectedLine) {
+         printf("failed (testcase = \"%s\", implementation = %s)\n\n", name, IMPLEMENTATION_NAMES[implementation]);
+         printf("\tline %ld exists          expected: %d\n", lineCount, hasExpectedLine);
+         printf("\t                        actual:   %d\n\n", hasLine);
+         return false;
+      }
+      if (!hasLine) {
+         return true;
+      }
+      if (line.start != expectedLine.start || line.length != expectedLine.length || line.commandLength != expectedLine.commandLength) {
+         printf("failed (testcase = \"%s\", implementation = %s)\n\n", name, IMPLEMENTATION_NAMES[implementation]);
+         printf("\tline %ld                 expected: offset %ld, length %ld, command length %ld\n", lineCount,
+                (long)(expectedLine.start - text), expectedLine.length, expectedLine.commandLength);
+         printf("\t                        actual:   offset %ld, length %ld, command length %ld\n\n",
+                (long)(line.start - text), line.length, line.commandLength);
+         return false;
+      }
+   }
+}
+
+static bool compareAllImplementations(const char *name, const uint8_t *text, size_t length) {
+   bool succeeded = true;
+   for (int implementation = SCANNER_SCALAR; implementation <= getFastestScannerImplementation(); implementation++) {
+      succeeded &= compareWithReference(name, text, length, implementation);
+   }
+   return succeeded;
+}
+
+// Returns the number of bytes read or -1 if the file could not get read.
+static long readFile(const char *path, uint8_t *content) {
+   FILE *file = fopen(path, "rb");
+   if (file == NULL) {
+      return -1;
+   }
+   long length = fread(content, 1, MAX_FILE_LENGTH, file);
+   fclose(file);
+   return length;
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      // copy the text to the heap -> reading behind it gets detected by sanitizers
+      size_t  length = strlen(testcase->text);
+      uint8_t *text  = malloc(length + 1);
+      memcpy(text, testcase->text, length);
+      failedTestcaseCount += compareAllImplementations(testcase->name, text, length) ? 0 : 1;
+      processedTestcaseCount++;
+      free(text);
+   }
+
+   uint8_t *content = malloc(MAX_FILE_LENGTH);
+   DIR *directory   = opendir(CORPUS_DIRECTORY);
+   struct dirent *entry;
+   while (directory != NULL && (entry = readdir(directory)) != NULL) {
+      char path[1024];
+      if (entry->d_name[0] == '.') {
+         continue;
+      }
+      snprintf(path, sizeof(path), "%s/%s", CORPUS_DIRECTORY, entry->d_name);
+      long length = readFile(path, content);
+      failedTestcaseCount += (length >= 0 && compareAllImplementations(entry->d_name, content, length)) ? 0 : 1;
+      processedTestcaseCount++;
+   }
+   if (directory == NULL) {
+      printf("failed to open %s\n\n", CORPUS_DIRECTORY);
+      failedTestcaseCount++;
+   } else {
+      closedir(directory);
+   }
+
+   long length = readFile(ULP_EXAMPLE_PATH, content);
+   failedTestcaseCount += (length >= 0 && compareAllImplementations(ULP_EXAMPLE_PATH, content, length)) ? 0 : 1;
+   processedTestcaseCount++;
+   free(content);
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
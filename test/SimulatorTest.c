@@ -0,0 +1,120 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../main/Assembler.h"
+#include "../tools/Simulator.h"
+
+#define MAX_WORD_COUNT        32
+#define MAX_DIAGNOSTIC_COUNT  1
+#define SYMBOL_CAPACITY       16
+#define MAX_FIXUP_COUNT       4
+
+typedef struct {
+   char              *name;
+   char              *source;
+   uint64_t          maxCommandCount;
+   SimulationResult  expectedResult;
+   uint16_t          expectedRegisters[4];
+   uint8_t           expectedStageCounter;
+   uint32_t          expectedProgramCounter;
+   uint64_t          expectedExecutedCommandCount;
+   uint64_t          expectedCycleCount;
+   uint32_t          memoryAddress;          // word address of the expected memory content (0 -> not checked)
+   uint32_t          expectedMemoryContent;
+} Testcase;
+
+Testcase testcases[] = {
+   {"halt",                  "halt",                                                                         10,  SIMULATION_HALTED,                {0, 0, 0, 0},            0, 0,  1,   2,   0,  0},
+   {"ALU operations",        "move r0, 5\nmove r1, r0\nadd r2, r1, 10\nsub r3, r2, 20\nhalt",               10,  SIMULATION_HALTED,                {5, 5, 15, 65531},       0, 4,  5,   42,  0,  0},
+   {"shift and logic",       "move r0, 0x0f0f\nlsh r1, r0, 4\nrsh r2, r0, 8\nand r3, r0, 0xff\nor r3, r3, r1\nhalt", 10, SIMULATION_HALTED,        {0x0f0f, 0xf0f0, 0x0f, 0xf0ff}, 0, 5, 6, 52, 0, 0},
+   {"stage count loop",      "stage_rst\nloop: stage_inc 1\nadd r0, r0, 2\njumps loop, 5, lt\nhalt",         100, SIMULATION_HALTED,                {10, 0, 0, 0},           5, 4,  17,  152, 0,  0},
+   {"jumpr loop",            "move r0, 0\nloop: add r0, r0, 1\njumpr loop, 3, lt\nhalt",                     100, SIMULATION_HALTED,                {3, 0, 0, 0},            0, 3,  8,   66,  0,  0},
+   {"jump upon overflow",    "move r1, 0xffff\nadd r1, r1, 1\njump overflow, ov\nmove r0, 1\nhalt\noverflow: move r0, 2\nhalt", 10, SIMULATION_HALTED, {2, 0, 0, 0},      0, 6,  5,   40,  0,  0},
+   {"jump upon zero",        "move r1, 1\nsub r1, r1, 1\njump zero, eq\nmove r0, 1\nhalt\nzero: move r0, 2\nhalt", 10, SIMULATION_HALTED,         {2, 0, 0, 0},            0, 6,  5,   40,  0,  0},
+   {"store and load",        "move r1, 10\nmove r2, 1234\nst r2, r1, 4\nld r3, r1, 4\nhalt",                 10,  SIMULATION_HALTED,                {0, 10, 1234, 1234},     0, 4,  5,   46,  11, (2 << 21) | (1 << 16) | 1234},
+   {"load above 4092 bytes", "move r1, 0\nmove r2, 4321\nst r2, r1, 6000\nld r3, r1, 6000\nhalt",             10,  SIMULATION_HALTED,                {0, 0, 4321, 4321},      0, 4,  5,   46,  1500, (2 << 21) | (1 << 16) | 4321},
+   {"self-modifying code",   "move r1, 4\nmove r2, 0\nst r2, r1, 0\nmove r0, 7\nhalt",                      10,  SIMULATION_INVALID_COMMAND,       {7, 4, 0, 0},            0, 4,  4,   42,  4,  (2 << 21) | (1 << 16)},
+   {"jump to empty memory",  "jump 40",                                                                      10,  SIMULATION_INVALID_COMMAND,       {0, 0, 0, 0},            0, 10, 1,   8,   0,  0},
+   {"command limit",         "loop: wait 10\njump loop",                                                     100, SIMULATION_COMMAND_LIMIT_REACHED, {0, 0, 0, 0},            0, 0,  100, 1200, 0, 0},
+   {"peripherals",           "adc r1, 0, 3\ntsens r2, 10\nreg_rd 5, 7, 0\nhalt",                            10,  SIMULATION_HALTED,                {6, 300, 42, 0},         0, 3,  4,   95,  0,  0},
+
+   {NULL, NULL, 0, 0, {}, 0, 0, 0, 0, 0, 0} // end
+};
+
+static uint16_t readAdc(void *context, uint32_t sarSelect, uint32_t pad) {
+   return pad * 100;
+}
+
+static uint16_t readTemperature(void *context) {
+   return 42;
+}
+
+static uint16_t readRegister(void *context, uint32_t address, uint32_t endBit, uint32_t startBit) {
+   return address + 1;
+}
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: %lu\n", name, expected);
+      printf("\t                        actual:   %lu\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+   Simulator *simulator          = malloc(sizeof(Simulator));
+   Peripherals peripherals       = {.readAdc = readAdc, .readTemperature = readTemperature, .readRegister = readRegister};
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint32_t   words[MAX_WORD_COUNT];
+      Diagnostic diagnostics[MAX_DIAGNOSTIC_COUNT];
+      Symbol     symbols[SYMBOL_CAPACITY];
+      Fixup      fixups[MAX_FIXUP_COUNT];
+      Assembler  assembler = {.words   = words,   .maxWordCount   = MAX_WORD_COUNT,  .diagnostics   = diagnostics, .maxDiagnosticCount = MAX_DIAGNOSTIC_COUNT,
+                              .symbols = symbols, .symbolCapacity = SYMBOL_CAPACITY, .fixups        = fixups,      .maxFixupCount      = MAX_FIXUP_COUNT};
+      resetAssembler(&assembler);
+      assemble(&assembler, (uint8_t*)testcase->source, strlen(testcase->source));
+      expectEqual(testcase, &testFailed, "diagnostic count", 0, assembler.diagnosticCount);
+
+      initializeSimulator(simulator, &peripherals);
+      loadWords(simulator, words, assembler.wordCount);
+      SimulationResult result = runSimulation(simulator, 0, testcase->maxCommandCount);
+
+      expectEqual(testcase, &testFailed, "result", testcase->expectedResult, result);
+      for (size_t index = 0; index < 4; index++) {
+         char name[] = "register r?";
+         name[10]    = '0' + index;
+         expectEqual(testcase, &testFailed, name, testcase->expectedRegisters[index], simulator->registers[index]);
+      }
+      expectEqual(testcase, &testFailed, "stage counter", testcase->expectedStageCounter, simulator->stageCounter);
+      expectEqual(testcase, &testFailed, "program counter", testcase->expectedProgramCounter, simulator->programCounter);
+      expectEqual(testcase, &testFailed, "executed commands", testcase->expectedExecutedCommandCount, simulator->executedCommandCount);
+      expectEqual(testcase, &testFailed, "cycles", testcase->expectedCycleCount, simulator->cycleCount);
+      if (testcase->memoryAddress != 0) {
+         expectEqual(testcase, &testFailed, "memory content", testcase->expectedMemoryContent, simulator->memory[testcase->memoryAddress]);
+      }
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+   free(simulator);
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
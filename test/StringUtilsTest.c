@@ -0,0 +1,98 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "../main/StringUtils.h"
+
+#define MAX_LINE_LENGTH    64
+#define MAX_TOKEN_COUNT    8
+
+typedef struct {
+   char     *name;
+   char     *input;
+   size_t   inputLength;            // 0 -> strlen(input)
+   size_t   maxTokenCount;
+   char     *expectedOutput;
+   size_t   expectedTokenCount;
+} Testcase;
+
+Testcase testcases[] = {
+   {"empty line",                "",                              0,  MAX_TOKEN_COUNT, "",                         0},
+   {"only whitespace",           " \t\r\n ",                      0,  MAX_TOKEN_COUNT, "",                         0},
+   {"surrounding whitespace",    "  halt  ",                      0,  MAX_TOKEN_COUNT, "halt",                     1},
+   {"upper case and commas",     "ADD R1, R2, R3",                0,  MAX_TOKEN_COUNT, "add r1 r2 r3",             4},
+   {"consecutive separators",    "jumpr\t loop ,, 5 ,lt",         0,  MAX_TOKEN_COUNT, "jumpr loop 5 lt",          4},
+   {"line ending",               "Loop: NOP\r\n",                 0,  MAX_TOKEN_COUNT, "loop: nop",                2},
+   {"comment",                   "nop // Wait, here",             0,  MAX_TOKEN_COUNT, "nop // wait here",         4},
+   {"more tokens than views",    "run 5 extra",                   0,  2,               "run 5 extra",              3},
+   {"no views",                  "run 5",                         0,  0,               "run 5",                    2},
+   {"not 0 terminated",          "MOVE R0, 1 garbage",            10, MAX_TOKEN_COUNT, "move r0 1",                3},
+
+   {NULL, NULL, 0, 0, NULL, 0} // end
+};
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: 0x%lx\n", name, expected);
+      printf("\t                        actual:   0x%lx\n\n", actual);
+   }
+}
+
+static void expectEqualText(Testcase *testcase, bool *testFailed, const char *name, const char *expected, const char *actual) {
+   if (strcmp(expected, actual) != 0) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: \"%s\"\n", name, expected);
+      printf("\t                        actual:   \"%s\"\n\n", actual);
+   }
+}
+
+// The views have to point into the normalized line (no copies) and cover the words between its spaces.
+static void expectTokens(Testcase *testcase, bool *testFailed, const uint8_t *line, size_t lineLength, const TokenView *tokens, size_t tokenCount) {
+   const uint8_t *start = line;
+   for (size_t index = 0; index < tokenCount && index < testcase->maxTokenCount; index++) {
+      const uint8_t *end = (const uint8_t*)strchr((const char*)start, ' ');
+      end                = end != NULL ? end : line + lineLength;
+      expectEqual(testcase, testFailed, "token start", start - line, tokens[index].start - line);
+      expectEqual(testcase, testFailed, "token length", end - start, tokens[index].length);
+      start = end + 1;
+   }
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint8_t line[MAX_LINE_LENGTH];
+      TokenView tokens[MAX_TOKEN_COUNT];
+      size_t tokenCount  = 0;
+      size_t inputLength = testcase->inputLength > 0 ? testcase->inputLength : strlen(testcase->input);
+
+      memcpy(line, testcase->input, strlen(testcase->input) + 1);
+      size_t length = normalizeLine(line, inputLength, tokens, testcase->maxTokenCount, &tokenCount);
+
+      expectEqualText(testcase, &testFailed, "line", testcase->expectedOutput, (const char*)line);
+      expectEqual(testcase, &testFailed, "length", strlen(testcase->expectedOutput), length);
+      expectEqual(testcase, &testFailed, "token count", testcase->expectedTokenCount, tokenCount);
+      expectTokens(testcase, &testFailed, line, length, tokens, tokenCount);
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../main/FrameCodec.h"
+#include "../main/Upload.h"
+#include "../tools/UploadClient.h"
+
+// The uploads run through a pty: the host side uses UploadClient like ulpUpload does and the receiver side runs Upload
+// in a thread like the ESP32 does.
+
+#define MAX_BYTE_COUNT                    300
+#define MAX_IMAGE_SIZE                    4096
+#define NONE                              -1
+#define RESPONSE_TIMEOUT_IN_MILLISECONDS  50
+#define RECEIVE_TIMEOUT_IN_MILLISECONDS   2000
+
+typedef enum { CRC, COBS, INVALID_COBS, UPLOAD } Operation;
+
+typedef struct {
+   char        *name;
+   Operation   operation;
+   char        *input;              // NULL -> inputLength non-zero bytes
+   size_t      inputLength;
+   char        *expectedEncoding;   // COBS: NULL -> only the length gets checked
+   size_t      expectedLength;      // COBS: length of the encoding, UPLOAD: number of sent frames (0 -> not checked)
+   uint32_t    expectedCrc;
+   int         damagedFrame;        // UPLOAD: index of the write call whose frame gets damaged
+   int         lostFrame;           // UPLOAD: index of the write call whose frame gets lost
+   bool        expectedSuccess;
+} Testcase;
+
+Testcase testcases[] = {
+   {"CRC empty",              CRC,          "",                  0,    NULL,                         0,    0x00000000, NONE, NONE, true},
+   {"CRC a",                  CRC,          "a",                 1,    NULL,                         0,    0xe8b7be43, NONE, NONE, true},
+   {"CRC check value",        CRC,          "123456789",         9,    NULL,                         0,    0xcbf43926, NONE, NONE, true},
+   {"COBS empty",             COBS,         "",                  0,    "\x01",                       1,    0,          NONE, NONE, true},
+   {"COBS zero",              COBS,         "\x00",              1,    "\x01\x01",                   2,    0,          NONE, NONE, true},
+   {"COBS two zeros",         COBS,         "\x00\x00",          2,    "\x01\x01\x01",               3,    0,          NONE, NONE, true},
+   {"COBS without zero",      COBS,         "\x11\x22\x33\x44",  4,    "\x05\x11\x22\x33\x44",       5,    0,          NONE, NONE, true},
+   {"COBS zero in between",   COBS,         "\x11\x22\x00\x33",  4,    "\x03\x11\x22\x02\x33",       5,    0,          NONE, NONE, true},
+   {"COBS trailing zeros",    COBS,         "\x11\x00\x00\x00",  4,    "\x02\x11\x01\x01\x01",       5,    0,          NONE, NONE, true},
+   {"COBS 253 bytes",         COBS,         NULL,                253,  NULL,                         254,  0,          NONE, NONE, true},
+   {"COBS 254 bytes",         COBS,         NULL,                254,  NULL,                         256,  0,          NONE, NONE, true},
+   {"COBS 255 bytes",         COBS,         NULL,                255,  NULL,                         257,  0,          NONE, NONE, true},
+   {"COBS truncated",         INVALID_COBS, "\x03\x11",          2,    NULL,                         0,    0,          NONE, NONE, true},
+   {"COBS contains zero",     INVALID_COBS, "\x03\x11\x00",      3,    NULL,                         0,    0,          NONE, NONE, true},
+   {"upload one frame",       UPLOAD,       NULL,                40,   NULL,                         2,    0,          NONE, NONE, true},
+   {"upload one window",      UPLOAD,       NULL,                1024, NULL,                         9,    0,          NONE, NONE, true},
+   {"upload many frames",     UPLOAD,       NULL,                2540, NULL,                         21,   0,          NONE, NONE, true},
+   {"damaged frame",          UPLOAD,       NULL,                2000, NULL,                         0,    0,          3,    NONE, true},
+   {"lost frame",             UPLOAD,       NULL,                2000, NULL,                         0,    0,          NONE, 5,    true},
+   {"lost end of window",     UPLOAD,       NULL,                2000, NULL,                         0,    0,          NONE, 7,    true},
+   {"lost END frame",         UPLOAD,       NULL,                300,  NULL,                         0,    0,          NONE, 3,    true},
+   {"image too large",        UPLOAD,       NULL,                5000, NULL,                         0,    0,          NONE, NONE, false},
+
+   {NULL, CRC, NULL, 0, NULL, 0, 0, NONE, NONE, false} // end
+};
+
+typedef struct {
+   int      file;
+   Upload   upload;
+   uint8_t  image[MAX_IMAGE_SIZE];
+} Receiver;
+
+typedef struct {
+   UploadChannel  *channel;
+   size_t         writeCount;
+   int            damagedFrame;
+   int            lostFrame;
+} FaultyChannel;
+
+static void sendResponseToPty(void *context, const char *response) {
+   Receiver *receiver = context;
+   if (write(receiver->file, response, strlen(response)) != (ssize_t)strlen(response)) {
+      fprintf(stderr, "ERROR: failed to send response\n");
+   }
+}
+
+static void* receive(void *parameters) {
+   Receiver *receiver = parameters;
+   UploadStatus status = UPLOAD_IN_PROGRESS;
+   uint8_t bytes[256];
+
+   while (status == UPLOAD_IN_PROGRESS) {
+      struct pollfd pollDescriptor = {receiver->file, POLLIN, 0};
+      ssize_t count = poll(&pollDescriptor, 1, RECEIVE_TIMEOUT_IN_MILLISECONDS) > 0 ? read(receiver->file, bytes, sizeof(bytes)) : 0;
+      if (count <= 0) {
+         abortUpload(&receiver->upload, "timeout");
+         break;
+      }
+      size_t consumedByteCount;
+      status = receiveUploadBytes(&receiver->upload, bytes, count, &consumedByteCount);
+   }
+   return NULL;
+}
+
+static void writeWithFaults(void *context, const uint8_t *bytes, size_t byteCount) {
+   FaultyChannel *faulty = context;
+   uint8_t copy[MAX_ENCODED_UPLOAD_FRAME_SIZE + 1];
+   int frameIndex = faulty->writeCount++;
+
+   if (frameIndex == faulty->lostFrame) {
+      return;
+   }
+   memcpy(copy, bytes, byteCount);
+   if (frameIndex == faulty->damagedFrame) {
+      copy[byteCount / 2] ^= 0x20;
+   }
+   faulty->channel->write(faulty->channel->context, copy, byteCount);
+}
+
+static bool readLineWithFaults(void *context, char *line, size_t maxLineLength, uint32_t timeoutInMilliseconds) {
+   FaultyChannel *faulty = context;
+   return faulty->channel->readLine(faulty->channel->context, line, maxLineLength, timeoutInMilliseconds);
+}
+
+static void fillWithNonZeroBytes(uint8_t *bytes, size_t count) {
+   for (size_t index = 0; index < count; index++) {
+      bytes[index] = (index * 7) % 255 + 1;
+   }
+}
+
+static void failTest(Testcase *testcase, bool *testFailed) {
+   if (!(*testFailed)) {
+      *testFailed = true;
+      printf("failed (testcase = \"%s\")\n\n", testcase->name);
+   }
+}
+
+static void expectEqual(Testcase *testcase, bool *testFailed, const char *name, uint64_t expected, uint64_t actual) {
+   if (expected != actual) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sexpected: 0x%lx\n", name, expected);
+      printf("\t                        actual:   0x%lx\n\n", actual);
+   }
+}
+
+static void expectEqualBytes(Testcase *testcase, bool *testFailed, const char *name, const uint8_t *expected, const uint8_t *actual, size_t count) {
+   if (memcmp(expected, actual, count) != 0) {
+      failTest(testcase, testFailed);
+      printf("\t%-24sdiffers\n\n", name);
+   }
+}
+
+static void testCobs(Testcase *testcase, bool *testFailed, const uint8_t *input) {
+   uint8_t encoded[MAX_BYTE_COUNT];
+   uint8_t decoded[MAX_BYTE_COUNT];
+
+   size_t encodedLength = encodeCobs(input, testcase->inputLength, encoded);
+   expectEqual(testcase, testFailed, "encoded length", testcase->expectedLength, encodedLength);
+   expectEqual(testcase, testFailed, "contains zero", false, memchr(encoded, 0, encodedLength) != NULL);
+   if (testcase->expectedEncoding != NULL) {
+      expectEqualBytes(testcase, testFailed, "encoding", (const uint8_t*)testcase->expectedEncoding, encoded, encodedLength);
+   }
+
+   size_t decodedLength = decodeCobs(encoded, encodedLength, decoded);
+   expectEqual(testcase, testFailed, "decoded length", testcase->inputLength, decodedLength);
+   if (decodedLength == testcase->inputLength) {
+      expectEqualBytes(testcase, testFailed, "decoded bytes", input, decoded, decodedLength);
+   }
+}
+
+static void testUpload(Testcase *testcase, bool *testFailed) {
+   uint8_t *image = malloc(testcase->inputLength);
+   fillWithNonZeroBytes(image, testcase->inputLength);
+   image[0] = 0;
+
+   int masterFile = posix_openpt(O_RDWR | O_NOCTTY);
+   if (masterFile < 0 || grantpt(masterFile) != 0 || unlockpt(masterFile) != 0) {
+      failTest(testcase, testFailed);
+      printf("\tfailed to open a pty\n\n");
+      free(image);
+      return;
+   }
+   Receiver *receiver = calloc(1, sizeof(Receiver));
+   receiver->file     = open(ptsname(masterFile), O_RDWR | O_NOCTTY);
+   struct termios attributes;
+   tcgetattr(receiver->file, &attributes);
+   cfmakeraw(&attributes);
+   tcsetattr(receiver->file, TCSANOW, &attributes);
+   startUpload(&receiver->upload, receiver->image, MAX_IMAGE_SIZE, receiver, sendResponseToPty);
+
+   UploadChannel serialChannel;
+   SerialChannel serial;
+   initializeSerialChannel(&serialChannel, &serial, masterFile);
+   FaultyChannel faulty  = {&serialChannel, 0, testcase->damagedFrame, testcase->lostFrame};
+   UploadChannel channel = {&faulty, writeWithFaults, readLineWithFaults};
+
+   pthread_t receiverThread;
+   pthread_create(&receiverThread, NULL, receive, receiver);
+   UploadResult result = uploadImage(&channel, image, testcase->inputLength, RESPONSE_TIMEOUT_IN_MILLISECONDS);
+   pthread_join(receiverThread, NULL);
+
+   expectEqual(testcase, testFailed, "success", testcase->expectedSuccess, result.isSuccessful);
+   if (testcase->expectedSuccess) {
+      expectEqual(testcase, testFailed, "image size", testcase->inputLength, receiver->upload.imageSize);
+      expectEqualBytes(testcase, testFailed, "image", image, receiver->image, testcase->inputLength);
+   }
+   if (testcase->expectedLength > 0) {
+      expectEqual(testcase, testFailed, "sent frames", testcase->expectedLength, result.sentFrameCount);
+   }
+   if (testcase->damagedFrame != NONE || testcase->lostFrame != NONE) {
+      expectEqual(testcase, testFailed, "frames sent again", true, result.resentFrameCount > 0);
+   }
+
+   close(receiver->file);
+   close(masterFile);
+   free(receiver);
+   free(image);
+}
+
+int main(int argc, char* argv[]) {
+   size_t processedTestcaseCount = 0;
+   size_t failedTestcaseCount    = 0;
+
+   for (Testcase *testcase = testcases; testcase->name != NULL; testcase++) {
+      bool testFailed = false;
+      uint8_t generatedInput[MAX_BYTE_COUNT];
+      const uint8_t *input = (const uint8_t*)testcase->input;
+      uint8_t decoded[MAX_BYTE_COUNT];
+
+      if (input == NULL && testcase->operation != UPLOAD) {
+         fillWithNonZeroBytes(generatedInput, testcase->inputLength);
+         input = generatedInput;
+      }
+
+      switch (testcase->operation) {
+         case CRC:
+            expectEqual(testcase, &testFailed, "CRC", testcase->expectedCrc, calculateCrc32(0, input, testcase->inputLength));
+            break;
+         case COBS:
+            testCobs(testcase, &testFailed, input);
+            break;
+         case INVALID_COBS:
+            expectEqual(testcase, &testFailed, "decoded length", INVALID_FRAME, decodeCobs(input, testcase->inputLength, decoded));
+            break;
+         case UPLOAD:
+            testUpload(testcase, &testFailed);
+            break;
+      }
+
+      failedTestcaseCount += testFailed ? 1 : 0;
+      processedTestcaseCount++;
+   }
+
+   if (failedTestcaseCount == 0) {
+      printf("\nall %ld testcases succeeded\n\n", processedTestcaseCount);
+   } else {
+      printf("\n%ld of %ld tests failed\n\n", failedTestcaseCount, processedTestcaseCount);
+   }
+
+   return failedTestcaseCount == 0 ? 0 : 1;
+}
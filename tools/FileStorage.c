@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "FileStorage.h"
+
+static void getPath(const FileStorage *file, const char *key, const char *suffix, char *path) {
+   snprintf(path, PATH_MAX, "%s/%s%s", file->directory, key, suffix);
+}
+
+// The blob gets written to a temporary file that replaces the previous one -> a blob gets replaced as a whole like in NVS.
+static bool writeBlobToFile(void *context, const char *key, const void *bytes, size_t byteCount) {
+   char path[PATH_MAX];
+   char temporaryPath[PATH_MAX];
+
+   getPath(context, key, "", path);
+   getPath(context, key, ".tmp", temporaryPath);
+
+   FILE *blob = fopen(temporaryPath, "wb");
+   if (blob == NULL) {
+      return false;
+   }
+   bool isWritten = fwrite(bytes, 1, byteCount, blob) == byteCount;
+   isWritten      = fclose(blob) == 0 && isWritten;
+   return isWritten && rename(temporaryPath, path) == 0;
+}
+
+static bool readBlobFromFile(void *context, const char *key, void *bytes, size_t maxByteCount, size_t *byteCount) {
+   char path[PATH_MAX];
+
+   getPath(context, key, "", path);
+   FILE *blob = fopen(path, "rb");
+   if (blob == NULL) {
+      return false;
+   }
+   *byteCount  = fread(bytes, 1, maxByteCount, blob);
+   bool isRead = !ferror(blob) && fgetc(blob) == EOF;
+   fclose(blob);
+   return isRead;
+}
+
+bool initializeFileStorage(ProgramStorage *storage, FileStorage *file, const char *directory) {
+   struct stat status;
+
+   if (strlen(directory) >= sizeof(file->directory) || stat(directory, &status) != 0 || !S_ISDIR(status.st_mode)) {
+      return false;
+   }
+   strcpy(file->directory, directory);
+   *storage = (ProgramStorage){file, writeBlobToFile, readBlobFromFile};
+   return true;
+}
@@ -0,0 +1,16 @@
+#ifndef assembler_file_storage_h
+#define assembler_file_storage_h
+
+#include <limits.h>
+
+#include "../main/ProgramStore.h"
+
+// Stand-in for the NVS of the ESP32: each blob is the file <directory>/<key>.
+typedef struct {
+   char  directory[PATH_MAX - MAX_STORAGE_KEY_LENGTH - 2];
+} FileStorage;
+
+// Returns false if the directory does not exist or its path is too long.
+bool initializeFileStorage(ProgramStorage *storage, FileStorage *file, const char *directory);
+
+#endif
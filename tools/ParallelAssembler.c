@@ -0,0 +1,196 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "ParallelAssembler.h"
+
+#define LINE_FEED                '\n'
+#define CARRIAGE_RETURN          '\r'
+#define MIN_BYTES_PER_LINE       16     // used to estimate the number of lines of a chunk
+
+typedef struct {
+   const uint8_t *start;
+   size_t        length;
+   EncodedLine   *lines;                // NULL if the memory for the lines could not get allocated
+   size_t        lineCount;
+   bool          isEncoded;
+} Chunk;
+
+typedef struct {
+   Chunk            *chunks;
+   size_t           chunkCount;
+   size_t           nextChunkIndex;     // the next chunk a thread will encode (chunks get claimed in order)
+   bool             isCancelled;
+   pthread_mutex_t  mutex;
+   pthread_cond_t   chunkEncoded;
+} Pool;
+
+// Returns the start of the first line at or behind position (the end of the source if there is none).
+static size_t findLineStart(const uint8_t *source, size_t sourceLength, size_t position) {
+   while (position < sourceLength && source[position] != LINE_FEED && source[position] != CARRIAGE_RETURN) {
+      position++;
+   }
+   if (position < sourceLength && source[position] == CARRIAGE_RETURN) {
+      position++;
+   }
+   if (position < sourceLength && source[position] == LINE_FEED) {
+      position++;
+   }
+   return position;
+}
+
+static size_t splitIntoChunks(const uint8_t *source, size_t sourceLength, size_t chunkSize, Chunk *chunks) {
+   size_t chunkCount = 0;
+   size_t start      = 0;
+   while (start < sourceLength) {
+      size_t end = (sourceLength - start <= chunkSize) ? sourceLength : findLineStart(source, sourceLength, start + chunkSize - 1);
+      chunks[chunkCount++] = (Chunk){source + start, end - start, NULL, 0, false};
+      start = end;
+   }
+   return chunkCount;
+}
+
+static void encodeChunk(Chunk *chunk) {
+   Scanner    scanner;
+   SourceLine line;
+   size_t     capacity = chunk->length / MIN_BYTES_PER_LINE + 1;
+   chunk->lines        = malloc(capacity * sizeof(EncodedLine));
+   chunk->lineCount    = 0;
+
+   initScanner(&scanner, chunk->start, chunk->length, getFastestScannerImplementation());
+   while (chunk->lines != NULL && nextLine(&scanner, &line)) {
+      if (chunk->lineCount == capacity) {
+         capacity *= 2;
+         EncodedLine *lines = realloc(chunk->lines, capacity * sizeof(EncodedLine));
+         if (lines == NULL) {
+            free(chunk->lines);
+         }
+         chunk->lines = lines;
+         if (lines == NULL) {
+            break;
+         }
+      }
+      encodeCommand(line.start, line.commandLength, &chunk->lines[chunk->lineCount++]);
+   }
+}
+
+// Claims the next chunk and returns its index or pool->chunkCount if there is none. The caller holds the mutex.
+static size_t claimChunk(Pool *pool) {
+   if (pool->isCancelled || pool->nextChunkIndex == pool->chunkCount) {
+      return pool->chunkCount;
+   }
+   return pool->nextChunkIndex++;
+}
+
+static void encodeClaimedChunk(Pool *pool, size_t chunkIndex) {
+   encodeChunk(&pool->chunks[chunkIndex]);
+   pthread_mutex_lock(&pool->mutex);
+   pool->chunks[chunkIndex].isEncoded = true;
+   pthread_cond_broadcast(&pool->chunkEncoded);
+   pthread_mutex_unlock(&pool->mutex);
+}
+
+static void* encodeChunks(void *context) {
+   Pool *pool = context;
+   while (true) {
+      pthread_mutex_lock(&pool->mutex);
+      size_t chunkIndex = claimChunk(pool);
+      pthread_mutex_unlock(&pool->mutex);
+      if (chunkIndex == pool->chunkCount) {
+         return NULL;
+      }
+      encodeClaimedChunk(pool, chunkIndex);
+   }
+}
+
+// Waits until the chunk got encoded, encodes it if no worker claimed it yet.
+static void waitForChunk(Pool *pool, size_t chunkIndex) {
+   pthread_mutex_lock(&pool->mutex);
+   if (pool->nextChunkIndex == chunkIndex) {
+      claimChunk(pool);
+      pthread_mutex_unlock(&pool->mutex);
+      encodeClaimedChunk(pool, chunkIndex);
+      return;
+   }
+   while (!pool->chunks[chunkIndex].isEncoded) {
+      pthread_cond_wait(&pool->chunkEncoded, &pool->mutex);
+   }
+   pthread_mutex_unlock(&pool->mutex);
+}
+
+// Returns false if assembling stopped because the words do not fit into Assembler.words.
+static bool mergeChunk(Assembler *assembler, Chunk *chunk) {
+   if (chunk->lines != NULL) {
+      for (size_t index = 0; index < chunk->lineCount; index++) {
+         if (!assembleEncodedLine(assembler, &chunk->lines[index]) && assembler->wordCount == assembler->maxWordCount) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   // the worker ran out of memory -> encode the chunk line by line while merging
+   Scanner     scanner;
+   SourceLine  line;
+   EncodedLine encodedLine;
+   initScanner(&scanner, chunk->start, chunk->length, getFastestScannerImplementation());
+   while (nextLine(&scanner, &line)) {
+      encodeCommand(line.start, line.commandLength, &encodedLine);
+      if (!assembleEncodedLine(assembler, &encodedLine) && assembler->wordCount == assembler->maxWordCount) {
+         return false;
+      }
+   }
+   return true;
+}
+
+void assembleInParallel(Assembler *assembler, const uint8_t *source, size_t sourceLength, size_t threadCount, size_t chunkSize) {
+   chunkSize          = (chunkSize == 0) ? DEFAULT_CHUNK_SIZE_IN_BYTES : chunkSize;
+   size_t workerCount = (threadCount > 1) ? threadCount - 1 : 0;
+   Pool pool          = {.chunks = malloc((sourceLength / chunkSize + 1) * sizeof(Chunk))};
+   pthread_t *workers = malloc((workerCount + 1) * sizeof(pthread_t));
+   if (pool.chunks == NULL || workers == NULL) {
+      free(pool.chunks);
+      free(workers);
+      assemble(assembler, source, sourceLength);
+      return;
+   }
+
+   pool.chunkCount = splitIntoChunks(source, sourceLength, chunkSize, pool.chunks);
+   pthread_mutex_init(&pool.mutex, NULL);
+   pthread_cond_init(&pool.chunkEncoded, NULL);
+
+   // if a thread can not get created, the remaining threads (at least the calling one) encode its chunks
+   size_t startedWorkerCount = 0;
+   while (startedWorkerCount < workerCount && pthread_create(&workers[startedWorkerCount], NULL, encodeChunks, &pool) == 0) {
+      startedWorkerCount++;
+   }
+
+   size_t chunkIndex = 0;
+   for (; chunkIndex < pool.chunkCount; chunkIndex++) {
+      waitForChunk(&pool, chunkIndex);
+      bool hasSpaceLeft = mergeChunk(assembler, &pool.chunks[chunkIndex]);
+      free(pool.chunks[chunkIndex].lines);
+      pool.chunks[chunkIndex].lines = NULL;
+      if (!hasSpaceLeft) {
+         break;
+      }
+   }
+
+   pthread_mutex_lock(&pool.mutex);
+   pool.isCancelled = true;
+   pthread_mutex_unlock(&pool.mutex);
+   for (size_t index = 0; index < startedWorkerCount; index++) {
+      pthread_join(workers[index], NULL);
+   }
+   // chunks encoded by workers but not merged because the words did not fit
+   for (size_t index = chunkIndex; index < pool.chunkCount; index++) {
+      free(pool.chunks[index].lines);
+   }
+
+   pthread_cond_destroy(&pool.chunkEncoded);
+   pthread_mutex_destroy(&pool.mutex);
+   free(pool.chunks);
+   free(workers);
+
+   resolveLabels(assembler);
+}
@@ -0,0 +1,20 @@
+#ifndef assembler_parallel_assembler_h
+#define assembler_parallel_assembler_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../main/Assembler.h"
+
+#define DEFAULT_CHUNK_SIZE_IN_BYTES    (64 * 1024)
+
+/**
+ * Does the same as assemble (same words and diagnostics) using threadCount threads on the host. The source gets split at
+ * line boundaries into chunks of about chunkSize bytes (0 selects DEFAULT_CHUNK_SIZE_IN_BYTES). Worker threads encode
+ * the chunks (see encodeCommand) while the calling thread merges the encoded chunks in the order of the source
+ * (labels, words, diagnostics, see assembleEncodedLine) and resolves the labels at the end. The calling thread encodes
+ * the next chunk itself if no worker took it yet -> threadCount = 1 assembles without worker threads.
+ */
+void assembleInParallel(Assembler *assembler, const uint8_t *source, size_t sourceLength, size_t threadCount, size_t chunkSize);
+
+#endif
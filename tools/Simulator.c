@@ -0,0 +1,354 @@
+#include <string.h>
+
+#include "Simulator.h"
+#include "../main/CycleCount.h"
+#include "../main/InstructionSet.h"
+#include "../main/UlpBinary.h"
+
+#define ADDRESS_MASK               (SIMULATOR_MEMORY_SIZE_IN_WORDS - 1)
+#define COMMAND_SIZE_IN_BYTES      4
+
+typedef enum {
+   INVALID = 0,
+   ALU_WITH_REGISTERS,        // operand0 = destination, operand1 = source 1, operand2 = source 2, operand3 = ALU operation
+   ALU_WITH_IMMEDIATE,        // operand0 = destination, operand1 = source, operand3 = ALU operation, immediate = value
+   STAGE_INCREMENT,           // immediate = value
+   STAGE_DECREMENT,           // immediate = value
+   STAGE_RESET,
+   STORE,                     // operand0 = source, operand1 = register containing the address, immediate = offset in words
+   LOAD,                      // operand0 = destination, operand1 = register containing the address, immediate = offset in words
+   JUMP_TO_IMMEDIATE,         // operand1 = jump type, immediate = address in words
+   JUMP_TO_REGISTER,          // operand0 = register containing the address, operand1 = jump type
+   JUMP_RELATIVE_UPON_R0,     // operand0 = condition, operand3 = threshold, immediate = step in words
+   JUMP_RELATIVE_UPON_STAGE,  // operand0 = condition, operand3 = threshold, immediate = step in words
+   HALT,
+   WAKE,
+   SLEEP,                     // operand0 = sleep cycle register
+   WAIT,
+   TSENS,                     // operand0 = destination
+   ADC,                       // operand0 = destination, operand1 = SAR select, operand2 = pad
+   I2C_READ,                  // operand0 = sub address, operand1 = end bit, operand2 = start bit, operand3 = slave register
+   I2C_WRITE,                 // operand0 = sub address, operand1 = end bit, operand2 = start bit, operand3 = slave register, immediate = data
+   REGISTER_READ,             // operand1 = end bit, operand2 = start bit, operand3 = address
+   REGISTER_WRITE             // operand1 = end bit, operand2 = start bit, operand3 = address, immediate = data
+} OperationType;
+
+// Returns the step of a relative jump (jumpr and jumps) in words.
+static int32_t getRelativeJumpStep(uint32_t word) {
+   int32_t step = getField(word, FIELD_RELATIVE_JUMP_STEP);
+   return getField(word, FIELD_RELATIVE_JUMP_SIGN) ? -step : step;
+}
+
+// The bit layouts of the commands are defined in main/InstructionSet.h.
+static Operation decode(uint32_t word) {
+   Operation operation = {INVALID, 0, 0, 0, 0, getCycleCount(word), 0};
+
+   switch (getFormat(word)) {
+      case FORMAT_REG_WR:
+         operation.operation = REGISTER_WRITE;
+         operation.operand1  = getField(word, FIELD_REGISTER_END_BIT);
+         operation.operand2  = getField(word, FIELD_REGISTER_START_BIT);
+         operation.operand3  = getField(word, FIELD_REGISTER_ADDRESS);
+         operation.immediate = getField(word, FIELD_REGISTER_DATA);
+         break;
+      case FORMAT_REG_RD:
+         operation.operation = REGISTER_READ;
+         operation.operand1  = getField(word, FIELD_REGISTER_END_BIT);
+         operation.operand2  = getField(word, FIELD_REGISTER_START_BIT);
+         operation.operand3  = getField(word, FIELD_REGISTER_ADDRESS);
+         break;
+      case FORMAT_I2C:
+         operation.operation = getField(word, FIELD_I2C_DIRECTION) ? I2C_WRITE : I2C_READ;
+         operation.operand0  = getField(word, FIELD_I2C_SUB_ADDRESS);
+         operation.operand1  = getField(word, FIELD_I2C_MASK_HIGH);
+         operation.operand2  = getField(word, FIELD_I2C_MASK_LOW);
+         operation.operand3  = getField(word, FIELD_I2C_SLAVE_REGISTER);
+         operation.immediate = getField(word, FIELD_I2C_DATA);
+         break;
+      case FORMAT_WAIT:
+         operation.operation = WAIT;
+         break;
+      case FORMAT_ADC:
+         operation.operation = ADC;
+         operation.operand0  = getField(word, FIELD_ADC_DESTINATION_REGISTER);
+         operation.operand1  = getField(word, FIELD_ADC_SAR_SELECT);
+         operation.operand2  = getField(word, FIELD_ADC_PAD);
+         break;
+      case FORMAT_ST:
+         operation.operation = STORE;
+         operation.operand0  = getField(word, FIELD_MEMORY_DATA_REGISTER);
+         operation.operand1  = getField(word, FIELD_MEMORY_ADDRESS_REGISTER);
+         operation.immediate = getField(word, FIELD_MEMORY_OFFSET);
+         break;
+      case FORMAT_LD:
+         operation.operation = LOAD;
+         operation.operand0  = getField(word, FIELD_MEMORY_DATA_REGISTER);
+         operation.operand1  = getField(word, FIELD_MEMORY_ADDRESS_REGISTER);
+         operation.immediate = getField(word, FIELD_MEMORY_OFFSET);
+         break;
+      case FORMAT_ALU_REGISTERS:
+         operation.operand0  = getField(word, FIELD_ALU_DESTINATION_REGISTER);
+         operation.operand1  = getField(word, FIELD_ALU_SOURCE_REGISTER1);
+         operation.operand3  = getField(word, FIELD_ALU_OPERATION);
+         if (operation.operand3 < ALU_OPERATION_COUNT) {
+            operation.operation = ALU_WITH_REGISTERS;
+            // move uses source 1 (the encoder writes it to both source fields)
+            operation.operand2  = operation.operand3 == ALU_MOVE ? operation.operand1 : getField(word, FIELD_ALU_SOURCE_REGISTER2);
+         }
+         break;
+      case FORMAT_ALU_IMMEDIATE:
+         operation.operand0  = getField(word, FIELD_ALU_DESTINATION_REGISTER);
+         operation.operand1  = getField(word, FIELD_ALU_SOURCE_REGISTER1);
+         operation.operand3  = getField(word, FIELD_ALU_OPERATION);
+         if (operation.operand3 < ALU_OPERATION_COUNT) {
+            operation.operation = ALU_WITH_IMMEDIATE;
+            operation.immediate = getField(word, FIELD_ALU_IMMEDIATE);
+         }
+         break;
+      case FORMAT_STAGE_COUNT:
+         if (getField(word, FIELD_ALU_OPERATION) < STAGE_OPERATION_COUNT) {
+            operation.operation = STAGE_INCREMENT + getField(word, FIELD_ALU_OPERATION);
+            operation.immediate = getField(word, FIELD_STAGE_COUNT_IMMEDIATE);
+         }
+         break;
+      case FORMAT_JUMP:
+         if (getField(word, FIELD_JUMP_TYPE) < JUMP_TYPE_COUNT) {
+            operation.operation = getField(word, FIELD_JUMP_ADDRESS_IN_REGISTER) ? JUMP_TO_REGISTER : JUMP_TO_IMMEDIATE;
+            operation.operand0  = getField(word, FIELD_JUMP_REGISTER);
+            operation.operand1  = getField(word, FIELD_JUMP_TYPE);
+            operation.immediate = getField(word, FIELD_JUMP_ADDRESS);
+         }
+         break;
+      case FORMAT_JUMPR:
+         operation.operation = JUMP_RELATIVE_UPON_R0;
+         operation.operand0  = getField(word, FIELD_JUMPR_CONDITION);
+         operation.operand3  = getField(word, FIELD_JUMPR_THRESHOLD);
+         operation.immediate = getRelativeJumpStep(word);
+         break;
+      case FORMAT_JUMPS:
+         if (getField(word, FIELD_JUMPS_CONDITION) < JUMPS_CONDITION_COUNT) {
+            operation.operation = JUMP_RELATIVE_UPON_STAGE;
+            operation.operand0  = getField(word, FIELD_JUMPS_CONDITION);
+            operation.operand3  = getField(word, FIELD_JUMPS_THRESHOLD);
+            operation.immediate = getRelativeJumpStep(word);
+         }
+         break;
+      case FORMAT_WAKE:
+         operation.operation = WAKE;
+         break;
+      case FORMAT_SLEEP:
+         operation.operation = SLEEP;
+         operation.operand0  = getField(word, FIELD_SLEEP_CYCLE_REGISTER);
+         break;
+      case FORMAT_TSENS:
+         operation.operation = TSENS;
+         operation.operand0  = getField(word, FIELD_TSENS_DESTINATION_REGISTER);
+         break;
+      case FORMAT_HALT:
+         operation.operation = HALT;
+         break;
+   }
+   return operation;
+}
+
+static void storeWord(Simulator *simulator, uint32_t address, uint32_t word) {
+   simulator->memory[address]     = word;
+   simulator->operations[address] = decode(word);
+}
+
+// Only add and sub modify the overflow flag, all ALU operations modify the zero flag.
+static uint16_t executeAluOperation(Simulator *simulator, uint32_t aluOperation, uint32_t value1, uint32_t value2) {
+   uint32_t result = 0;
+
+   switch (aluOperation) {
+      case ALU_ADD:  result = value1 + value2;                   simulator->overflowFlag = result > 0xffff; break;
+      case ALU_SUB:  result = value1 - value2;                   simulator->overflowFlag = value2 > value1; break;
+      case ALU_AND:  result = value1 & value2;                   break;
+      case ALU_OR:   result = value1 | value2;                   break;
+      case ALU_MOVE: result = value2;                            break;
+      case ALU_LSH:  result = value2 < 16 ? value1 << value2 : 0; break;
+      case ALU_RSH:  result = value2 < 16 ? value1 >> value2 : 0; break;
+   }
+   simulator->zeroFlag = (result & 0xffff) == 0;
+   return result & 0xffff;
+}
+
+static bool isAbsoluteJumpTaken(Simulator *simulator, uint32_t jumpType) {
+   switch (jumpType) {
+      case JUMP_IF_EQ:       return simulator->zeroFlag;
+      case JUMP_IF_OV:       return simulator->overflowFlag;
+   }
+   return true;
+}
+
+static bool isStageJumpTaken(uint32_t condition, uint32_t stageCounter, uint32_t threshold) {
+   switch (condition) {
+      case JUMPS_LT: return stageCounter < threshold;
+      case JUMPS_GE: return stageCounter >= threshold;
+   }
+   return stageCounter <= threshold;
+}
+
+void initializeSimulator(Simulator *simulator, const Peripherals *peripherals) {
+   memset(simulator, 0, sizeof(Simulator));
+   if (peripherals != NULL) {
+      simulator->peripherals = *peripherals;
+   }
+   for (uint32_t address = 0; address < SIMULATOR_MEMORY_SIZE_IN_WORDS; address++) {
+      simulator->operations[address] = decode(0);
+   }
+}
+
+bool loadWords(Simulator *simulator, const uint32_t *words, size_t wordCount) {
+   if (wordCount > SIMULATOR_MEMORY_SIZE_IN_WORDS) {
+      return false;
+   }
+   for (size_t address = 0; address < wordCount; address++) {
+      storeWord(simulator, address, words[address]);
+   }
+   return true;
+}
+
+static uint32_t readLittleEndian(const uint8_t *bytes, size_t byteCount) {
+   uint32_t value = 0;
+   for (size_t index = byteCount; index > 0; index--) {
+      value = (value << 8) | bytes[index - 1];
+   }
+   return value;
+}
+
+bool loadBinary(Simulator *simulator, const uint8_t *binary, size_t binarySize) {
+   if (binarySize < ULP_PROGRAM_HEADER_SIZE_IN_BYTES || readLittleEndian(binary, 4) != ULP_BINARY_MAGIC) {
+      return false;
+   }
+   size_t textOffset     = readLittleEndian(binary + 4, 2);
+   size_t loadedSize     = readLittleEndian(binary + 6, 2) + readLittleEndian(binary + 8, 2);
+   size_t bssSize        = readLittleEndian(binary + 10, 2);
+   size_t loadedWords    = loadedSize / COMMAND_SIZE_IN_BYTES;
+   size_t bssWords       = bssSize / COMMAND_SIZE_IN_BYTES;
+
+   if (textOffset + loadedSize > binarySize || loadedWords + bssWords > SIMULATOR_MEMORY_SIZE_IN_WORDS) {
+      return false;
+   }
+   for (size_t address = 0; address < loadedWords; address++) {
+      storeWord(simulator, address, readLittleEndian(binary + textOffset + address * COMMAND_SIZE_IN_BYTES, COMMAND_SIZE_IN_BYTES));
+   }
+   for (size_t address = loadedWords; address < loadedWords + bssWords; address++) {
+      storeWord(simulator, address, 0);
+   }
+   return true;
+}
+
+void resetStatistics(Simulator *simulator) {
+   memset(simulator->executionCounts, 0, sizeof(simulator->executionCounts));
+   simulator->executedCommandCount = 0;
+   simulator->cycleCount           = 0;
+}
+
+SimulationResult runSimulation(Simulator *simulator, uint32_t entryPoint, uint64_t maxCommandCount) {
+   uint16_t *registers          = simulator->registers;
+   const Peripherals *stubs     = &simulator->peripherals;
+   uint32_t programCounter      = entryPoint & ADDRESS_MASK;
+   SimulationResult result      = SIMULATION_COMMAND_LIMIT_REACHED;
+
+   for (uint64_t count = 0; count < maxCommandCount; count++) {
+      const Operation *operation = &simulator->operations[programCounter];
+      if (operation->operation == INVALID) {
+         result = SIMULATION_INVALID_COMMAND;
+         break;
+      }
+
+      simulator->executionCounts[programCounter]++;
+      simulator->executedCommandCount++;
+      simulator->cycleCount += operation->cycleCount;
+      uint32_t nextProgramCounter = (programCounter + 1) & ADDRESS_MASK;
+
+      switch (operation->operation) {
+         case ALU_WITH_REGISTERS:
+            registers[operation->operand0] = executeAluOperation(simulator, operation->operand3, registers[operation->operand1], registers[operation->operand2]);
+            break;
+         case ALU_WITH_IMMEDIATE:
+            registers[operation->operand0] = executeAluOperation(simulator, operation->operand3, registers[operation->operand1], operation->immediate);
+            break;
+         case STAGE_INCREMENT:
+            simulator->stageCounter += operation->immediate;
+            break;
+         case STAGE_DECREMENT:
+            simulator->stageCounter -= operation->immediate;
+            break;
+         case STAGE_RESET:
+            simulator->stageCounter = 0;
+            break;
+         case STORE: {
+            // the upper half word contains the program counter and the number of the address register
+            uint32_t address = (registers[operation->operand1] + operation->immediate) & ADDRESS_MASK;
+            storeWord(simulator, address, (programCounter << 21) | ((uint32_t)operation->operand1 << 16) | registers[operation->operand0]);
+            break;
+         }
+         case LOAD:
+            registers[operation->operand0] = simulator->memory[(registers[operation->operand1] + operation->immediate) & ADDRESS_MASK] & 0xffff;
+            break;
+         case JUMP_TO_IMMEDIATE:
+            if (isAbsoluteJumpTaken(simulator, operation->operand1)) {
+               nextProgramCounter = operation->immediate;
+            }
+            break;
+         case JUMP_TO_REGISTER:
+            if (isAbsoluteJumpTaken(simulator, operation->operand1)) {
+               nextProgramCounter = registers[operation->operand0] & ADDRESS_MASK;
+            }
+            break;
+         case JUMP_RELATIVE_UPON_R0:
+            if ((operation->operand0 == JUMPR_LT) == (registers[0] < operation->operand3)) {
+               nextProgramCounter = (programCounter + operation->immediate) & ADDRESS_MASK;
+            }
+            break;
+         case JUMP_RELATIVE_UPON_STAGE:
+            if (isStageJumpTaken(operation->operand0, simulator->stageCounter, operation->operand3)) {
+               nextProgramCounter = (programCounter + operation->immediate) & ADDRESS_MASK;
+            }
+            break;
+         case HALT:
+            result = SIMULATION_HALTED;
+            break;
+         case WAKE:
+            simulator->wakeRequested = true;
+            break;
+         case SLEEP:
+            simulator->sleepCycleRegister = operation->operand0;
+            break;
+         case WAIT:
+            break;
+         case TSENS:
+            registers[operation->operand0] = stubs->readTemperature ? stubs->readTemperature(stubs->context) : 0;
+            break;
+         case ADC:
+            registers[operation->operand0] = stubs->readAdc ? stubs->readAdc(stubs->context, operation->operand1, operation->operand2) : 0;
+            break;
+         case I2C_READ:
+            registers[0] = stubs->readI2c ? stubs->readI2c(stubs->context, operation->operand3, operation->operand0, operation->operand1, operation->operand2) : 0;
+            break;
+         case I2C_WRITE:
+            if (stubs->writeI2c) {
+               stubs->writeI2c(stubs->context, operation->operand3, operation->operand0, operation->immediate, operation->operand1, operation->operand2);
+            }
+            break;
+         case REGISTER_READ:
+            registers[0] = stubs->readRegister ? stubs->readRegister(stubs->context, operation->operand3, operation->operand1, operation->operand2) : 0;
+            break;
+         case REGISTER_WRITE:
+            if (stubs->writeRegister) {
+               stubs->writeRegister(stubs->context, operation->operand3, operation->operand1, operation->operand2, operation->immediate);
+            }
+            break;
+      }
+
+      if (result == SIMULATION_HALTED) {
+         break;
+      }
+      programCounter = nextProgramCounter;
+   }
+
+   simulator->programCounter = programCounter;
+   return result;
+}
@@ -0,0 +1,89 @@
+#ifndef assembler_simulator_h
+#define assembler_simulator_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// RTC slow memory (8 KB) -> the ULP addresses it using 11 bit word addresses.
+#define SIMULATOR_MEMORY_SIZE_IN_WORDS    2048
+
+/**
+ * Stubs for the peripherals. Callbacks that are NULL read 0 and ignore writes. The context gets passed to each callback.
+ */
+typedef struct {
+   uint16_t (*readRegister)(void *context, uint32_t address, uint32_t endBit, uint32_t startBit);
+   void     (*writeRegister)(void *context, uint32_t address, uint32_t endBit, uint32_t startBit, uint32_t data);
+   uint16_t (*readI2c)(void *context, uint32_t slaveRegister, uint32_t subAddress, uint32_t endBit, uint32_t startBit);
+   void     (*writeI2c)(void *context, uint32_t slaveRegister, uint32_t subAddress, uint32_t data, uint32_t endBit, uint32_t startBit);
+   uint16_t (*readAdc)(void *context, uint32_t sarSelect, uint32_t pad);
+   uint16_t (*readTemperature)(void *context);
+   void     *context;
+} Peripherals;
+
+typedef enum {
+   SIMULATION_HALTED,
+   SIMULATION_COMMAND_LIMIT_REACHED,
+   SIMULATION_INVALID_COMMAND
+} SimulationResult;
+
+// Predecoded command -> executing it does not need to extract the fields of the word again. The meaning of the operands
+// depends on the operation (see decode() in Simulator.c).
+typedef struct {
+   uint8_t  operation;
+   uint8_t  operand0;
+   uint8_t  operand1;
+   uint8_t  operand2;
+   uint16_t operand3;
+   uint32_t cycleCount;
+   int32_t  immediate;
+} Operation;
+
+/**
+ * State of the simulated ULP. The statistics (executionCounts, executedCommandCount and cycleCount) accumulate over
+ * multiple calls of runSimulation till resetStatistics gets called.
+ */
+typedef struct {
+   uint32_t    memory[SIMULATOR_MEMORY_SIZE_IN_WORDS];
+   Operation   operations[SIMULATOR_MEMORY_SIZE_IN_WORDS];
+   uint64_t    executionCounts[SIMULATOR_MEMORY_SIZE_IN_WORDS];
+   uint16_t    registers[4];
+   uint8_t     stageCounter;
+   bool        zeroFlag;
+   bool        overflowFlag;
+   bool        wakeRequested;
+   uint32_t    sleepCycleRegister;     // selected by the last sleep command
+   uint32_t    programCounter;         // word address
+   uint64_t    executedCommandCount;
+   uint64_t    cycleCount;
+   Peripherals peripherals;
+} Simulator;
+
+/**
+ * Clears memory, registers and statistics. peripherals can be NULL if the program does not use peripherals.
+ */
+void initializeSimulator(Simulator *simulator, const Peripherals *peripherals);
+
+/**
+ * Copies the words to the memory, starting at word address 0. Returns false if the words do not fit into the memory.
+ */
+bool loadWords(Simulator *simulator, const uint32_t *words, size_t wordCount);
+
+/**
+ * Loads a binary in the format expected by ulp_load_binary (text and data section) into the memory, starting at word
+ * address 0. The bss section gets cleared. Returns false if the binary is invalid or does not fit into the memory.
+ */
+bool loadBinary(Simulator *simulator, const uint8_t *binary, size_t binarySize);
+
+/**
+ * Executes commands starting at the word address entryPoint until the ULP halts, an invalid command gets executed (the
+ * program counter points to it) or maxCommandCount commands got executed.
+ */
+SimulationResult runSimulation(Simulator *simulator, uint32_t entryPoint, uint64_t maxCommandCount);
+
+/**
+ * Sets executionCounts, executedCommandCount and cycleCount to 0.
+ */
+void resetStatistics(Simulator *simulator);
+
+#endif
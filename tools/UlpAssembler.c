@@ -0,0 +1,151 @@
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../main/Assembler.h"
+#include "../main/UlpBinary.h"
+#include "ParallelAssembler.h"
+
+// Assembles a ULP source file (e.g. main/ulp/ulp_code.S) on the host and writes a binary that can get passed to
+// ulp_load_binary (the same layout the ESP32 application builds before running a program). Large sources get assembled
+// by threadCount threads (default: number of CPUs), the binary does not depend on the number of threads.
+
+#define ULP_PROGRAM_COMMAND_SIZE_IN_BYTES       4
+#define MAX_WORD_COUNT                          (UINT16_MAX / ULP_PROGRAM_COMMAND_SIZE_IN_BYTES)
+#define MAX_DIAGNOSTIC_COUNT                    100
+#define SYMBOL_CAPACITY                         4096
+#define MAX_FIXUP_COUNT                         MAX_WORD_COUNT
+
+static const uint8_t EMPTY_FILE[] = "";
+
+static void printUsage(const char *programName) {
+   fprintf(stderr, "\nusage: %s <inputFilePath> <outputFilePath> [threadCount]\n\n", programName);
+}
+
+static const uint8_t* mapFile(const char *path, size_t *size) {
+   int file = open(path, O_RDONLY);
+   if (file < 0) {
+      return NULL;
+   }
+
+   const uint8_t *content = NULL;
+   struct stat fileStatus;
+   if (fstat(file, &fileStatus) == 0) {
+      *size = fileStatus.st_size;
+      if (*size == 0) {
+         content = EMPTY_FILE;
+      } else {
+         void *mappedFile = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, file, 0);
+         content = (mappedFile == MAP_FAILED) ? NULL : mappedFile;
+      }
+   }
+   close(file);
+   return content;
+}
+
+static bool writeFile(const char *path, const uint8_t *content, size_t size) {
+   int file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+   if (file < 0) {
+      return false;
+   }
+
+   size_t writtenBytes = 0;
+   while (writtenBytes < size) {
+      ssize_t result = write(file, content + writtenBytes, size - writtenBytes);
+      if (result <= 0) {
+         break;
+      }
+      writtenBytes += result;
+   }
+   return (close(file) == 0) && (writtenBytes == size);
+}
+
+// The ULP expects little endian words and header fields.
+static void convertToLittleEndian(uint8_t *image, size_t wordCount) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+   struct UlpBinary *header = (struct UlpBinary*)image;
+   header->magic      = __builtin_bswap32(header->magic);
+   header->textOffset = __builtin_bswap16(header->textOffset);
+   header->textSize   = __builtin_bswap16(header->textSize);
+   header->dataSize   = __builtin_bswap16(header->dataSize);
+   header->bssSize    = __builtin_bswap16(header->bssSize);
+
+   uint32_t *words = (uint32_t*)(image + ULP_PROGRAM_HEADER_SIZE_IN_BYTES);
+   for (size_t index = 0; index < wordCount; index++) {
+      words[index] = __builtin_bswap32(words[index]);
+   }
+#else
+   (void)image;
+   (void)wordCount;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+   long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+   if (argc != 3 && argc != 4) {
+      printUsage(argv[0]);
+      return 1;
+   }
+
+   const char *inputFilePath  = argv[1];
+   const char *outputFilePath = argv[2];
+   size_t threadCount         = (argc == 4) ? strtoul(argv[3], NULL, 10) : (cpuCount > 0 ? cpuCount : 1);
+
+   size_t sourceLength   = 0;
+   const uint8_t *source = mapFile(inputFilePath, &sourceLength);
+   if (source == NULL) {
+      fprintf(stderr, "ERROR: failed to read \"%s\".\n", inputFilePath);
+      return 1;
+   }
+
+   // The words get written directly behind the header -> the image needs no further copying before writing it.
+   uint8_t *image = malloc(ULP_PROGRAM_HEADER_SIZE_IN_BYTES + MAX_WORD_COUNT * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES);
+   Diagnostic diagnostics[MAX_DIAGNOSTIC_COUNT];
+   Symbol     *symbols = malloc(SYMBOL_CAPACITY * sizeof(Symbol));
+   Fixup      *fixups  = malloc(MAX_FIXUP_COUNT * sizeof(Fixup));
+   Assembler  result   = {.words   = (uint32_t*)(image + ULP_PROGRAM_HEADER_SIZE_IN_BYTES), .maxWordCount   = MAX_WORD_COUNT,
+                          .diagnostics = diagnostics, .maxDiagnosticCount = MAX_DIAGNOSTIC_COUNT,
+                          .symbols = symbols, .symbolCapacity = SYMBOL_CAPACITY,
+                          .fixups  = fixups,  .maxFixupCount  = MAX_FIXUP_COUNT};
+   resetAssembler(&result);
+   assembleInParallel(&result, source, sourceLength, threadCount, DEFAULT_CHUNK_SIZE_IN_BYTES);
+   free(symbols);
+   free(fixups);
+
+   if (source != EMPTY_FILE) {
+      munmap((void*)source, sourceLength);
+   }
+
+   for (size_t index = 0; index < result.diagnosticCount && index < MAX_DIAGNOSTIC_COUNT; index++) {
+      fprintf(stderr, "%s:%zu: ERROR: %s\n", inputFilePath, diagnostics[index].lineNumber, diagnostics[index].errorMessage);
+   }
+
+   if (result.diagnosticCount > 0) {
+      fprintf(stderr, "%zu error(s) -> no output written.\n", result.diagnosticCount);
+      free(image);
+      return 1;
+   }
+
+   struct UlpBinary *header = (struct UlpBinary*)image;
+   header->magic            = ULP_BINARY_MAGIC;
+   header->textOffset       = ULP_PROGRAM_HEADER_SIZE_IN_BYTES;
+   header->textSize         = result.wordCount * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+   header->dataSize         = 0;
+   header->bssSize          = 0;
+
+   size_t imageSize = ULP_PROGRAM_HEADER_SIZE_IN_BYTES + header->textSize;
+   convertToLittleEndian(image, result.wordCount);
+   bool written     = writeFile(outputFilePath, image, imageSize);
+   free(image);
+
+   if (!written) {
+      fprintf(stderr, "ERROR: failed to write \"%s\".\n", outputFilePath);
+      return 1;
+   }
+   return 0;
+}
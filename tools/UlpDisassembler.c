@@ -0,0 +1,91 @@
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../main/Disassembler.h"
+#include "../main/UlpBinary.h"
+
+// Prints the commands of a binary in the format expected by ulp_load_binary (e.g. ulp_main.bin of an IDF project or
+// the output of ulpAssembler). Words that are not commands get printed without text.
+
+#define ULP_PROGRAM_COMMAND_SIZE_IN_BYTES       4
+
+static void printUsage(const char *programName) {
+   fprintf(stderr, "\nusage: %s <binaryFilePath>\n\n", programName);
+}
+
+static const uint8_t* mapFile(const char *path, size_t *size) {
+   int file = open(path, O_RDONLY);
+   if (file < 0) {
+      return NULL;
+   }
+
+   const uint8_t *content = NULL;
+   struct stat fileStatus;
+   if (fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0) {
+      *size = fileStatus.st_size;
+      void *mappedFile = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, file, 0);
+      content = (mappedFile == MAP_FAILED) ? NULL : mappedFile;
+   }
+   close(file);
+   return content;
+}
+
+// The header fields and words are little endian.
+static uint32_t readLittleEndian(const uint8_t *bytes, size_t byteCount) {
+   uint32_t value = 0;
+   for (size_t index = byteCount; index > 0; index--) {
+      value = (value << 8) | bytes[index - 1];
+   }
+   return value;
+}
+
+static void printWords(const char *sectionName, const uint8_t *firstByte, size_t firstIndex, size_t wordCount) {
+   char text[MAX_DISASSEMBLED_COMMAND_LENGTH];
+
+   printf("\n%s (%zu words):\n\n", sectionName, wordCount);
+   for (size_t index = 0; index < wordCount; index++) {
+      uint32_t word = readLittleEndian(firstByte + index * ULP_PROGRAM_COMMAND_SIZE_IN_BYTES, ULP_PROGRAM_COMMAND_SIZE_IN_BYTES);
+      disassemble(word, text);
+      printf("%4zu:  %08x  %s\n", firstIndex + index, word, text);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   if (argc != 2) {
+      printUsage(argv[0]);
+      return 1;
+   }
+
+   const char *inputFilePath = argv[1];
+   size_t binarySize         = 0;
+   const uint8_t *binary     = mapFile(inputFilePath, &binarySize);
+   if (binary == NULL) {
+      fprintf(stderr, "ERROR: failed to read \"%s\".\n", inputFilePath);
+      return 1;
+   }
+
+   bool isValid = binarySize >= ULP_PROGRAM_HEADER_SIZE_IN_BYTES && readLittleEndian(binary, 4) == ULP_BINARY_MAGIC;
+   size_t textOffset = isValid ? readLittleEndian(binary + 4, 2) : 0;
+   size_t textSize   = isValid ? readLittleEndian(binary + 6, 2) : 0;
+   size_t dataSize   = isValid ? readLittleEndian(binary + 8, 2) : 0;
+   isValid           = isValid && textOffset + textSize + dataSize <= binarySize;
+
+   if (!isValid) {
+      fprintf(stderr, "ERROR: \"%s\" is not a ULP binary.\n", inputFilePath);
+      munmap((void*)binary, binarySize);
+      return 1;
+   }
+
+   size_t textWordCount = textSize / ULP_PROGRAM_COMMAND_SIZE_IN_BYTES;
+   printWords("text", binary + textOffset, 0, textWordCount);
+   printWords("data", binary + textOffset + textSize, textWordCount, dataSize / ULP_PROGRAM_COMMAND_SIZE_IN_BYTES);
+   printf("\n");
+
+   munmap((void*)binary, binarySize);
+   return 0;
+}
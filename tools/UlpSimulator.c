@@ -0,0 +1,111 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Simulator.h"
+#include "../main/Disassembler.h"
+
+// Executes a binary in the format expected by ulp_load_binary (e.g. the output of ulpAssembler) on the host and prints
+// the final state of the ULP and how often each command got executed.
+
+#define DEFAULT_MAX_COMMAND_COUNT     100000000ull
+#define RTC_FAST_CLOCK_FREQUENCY_HZ   8000000.0
+
+static const char *RESULT_TEXTS[] = {"halted", "command limit reached", "invalid command"};
+
+static void printUsage(const char *programName) {
+   fprintf(stderr, "\nusage: %s <binaryFilePath> [entryPoint] [maxCommandCount]\n\n", programName);
+   fprintf(stderr, "entryPoint      index of the first command to execute (default: 0)\n");
+   fprintf(stderr, "maxCommandCount the simulation stops after executing this number of commands (default: %llu)\n\n", DEFAULT_MAX_COMMAND_COUNT);
+}
+
+static const uint8_t* mapFile(const char *path, size_t *size) {
+   int file = open(path, O_RDONLY);
+   if (file < 0) {
+      return NULL;
+   }
+
+   const uint8_t *content = NULL;
+   struct stat fileStatus;
+   if (fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0) {
+      *size = fileStatus.st_size;
+      void *mappedFile = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, file, 0);
+      content = (mappedFile == MAP_FAILED) ? NULL : mappedFile;
+   }
+   close(file);
+   return content;
+}
+
+static double secondsSince(struct timespec *start) {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void printProfile(Simulator *simulator) {
+   char text[MAX_DISASSEMBLED_COMMAND_LENGTH];
+
+   printf("\nprofile:\n\n");
+   printf("index  executions        cycles            command\n");
+   for (size_t address = 0; address < SIMULATOR_MEMORY_SIZE_IN_WORDS; address++) {
+      uint64_t executions = simulator->executionCounts[address];
+      if (executions > 0) {
+         disassemble(simulator->memory[address], text);
+         printf("%5zu  %-16lu  %-16lu  %s\n", address, executions, executions * simulator->operations[address].cycleCount, text);
+      }
+   }
+   printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+   if (argc < 2 || argc > 4) {
+      printUsage(argv[0]);
+      return 1;
+   }
+
+   const char *inputFilePath = argv[1];
+   uint32_t entryPoint       = argc > 2 ? strtoul(argv[2], NULL, 0) : 0;
+   uint64_t maxCommandCount  = argc > 3 ? strtoull(argv[3], NULL, 0) : DEFAULT_MAX_COMMAND_COUNT;
+
+   size_t binarySize     = 0;
+   const uint8_t *binary = mapFile(inputFilePath, &binarySize);
+   if (binary == NULL) {
+      fprintf(stderr, "ERROR: failed to read \"%s\".\n", inputFilePath);
+      return 1;
+   }
+
+   Simulator *simulator = malloc(sizeof(Simulator));
+   initializeSimulator(simulator, NULL);
+   bool loaded = loadBinary(simulator, binary, binarySize);
+   munmap((void*)binary, binarySize);
+
+   if (!loaded) {
+      fprintf(stderr, "ERROR: \"%s\" is not a ULP binary or does not fit into the RTC slow memory.\n", inputFilePath);
+      free(simulator);
+      return 1;
+   }
+
+   struct timespec start;
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   SimulationResult result = runSimulation(simulator, entryPoint, maxCommandCount);
+   double elapsedSeconds   = secondsSince(&start);
+
+   printf("\nresult:            %s (program counter = %u)\n", RESULT_TEXTS[result], simulator->programCounter);
+   printf("registers:         r0 = %u, r1 = %u, r2 = %u, r3 = %u\n", simulator->registers[0], simulator->registers[1], simulator->registers[2], simulator->registers[3]);
+   printf("stage counter:     %u\n", simulator->stageCounter);
+   printf("flags:             zero = %d, overflow = %d\n", simulator->zeroFlag, simulator->overflowFlag);
+   printf("wake requested:    %s\n", simulator->wakeRequested ? "yes" : "no");
+   printf("executed commands: %lu\n", simulator->executedCommandCount);
+   printf("cycles:            %lu (%.3f ms at %.0f MHz)\n", simulator->cycleCount, simulator->cycleCount / RTC_FAST_CLOCK_FREQUENCY_HZ * 1000, RTC_FAST_CLOCK_FREQUENCY_HZ / 1e6);
+   if (elapsedSeconds > 0) {
+      printf("simulation speed:  %.0f commands/second\n", simulator->executedCommandCount / elapsedSeconds);
+   }
+   printProfile(simulator);
+
+   free(simulator);
+   return result == SIMULATION_INVALID_COMMAND ? 1 : 0;
+}
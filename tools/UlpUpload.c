@@ -0,0 +1,118 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "UploadClient.h"
+
+// Sends a binary in the format expected by ulp_load_binary (e.g. the output of ulpAssembler) to the ESP32 running the
+// assembler. The ESP32 writes it into its program memory without parsing it line by line.
+
+#define READY_TIMEOUT_IN_MILLISECONDS      2000
+#define RESPONSE_TIMEOUT_IN_MILLISECONDS   500
+
+static void printUsage(const char *programName) {
+   fprintf(stderr, "\nusage: %s <serialDevice> <binaryFilePath>\n\n", programName);
+   fprintf(stderr, "serialDevice    serial interface connected to the ESP32 (e.g. /dev/ttyUSB0)\n\n");
+}
+
+static const uint8_t* mapFile(const char *path, size_t *size) {
+   int file = open(path, O_RDONLY);
+   if (file < 0) {
+      return NULL;
+   }
+
+   const uint8_t *content = NULL;
+   struct stat fileStatus;
+   if (fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0) {
+      *size = fileStatus.st_size;
+      void *mappedFile = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, file, 0);
+      content = (mappedFile == MAP_FAILED) ? NULL : mappedFile;
+   }
+   close(file);
+   return content;
+}
+
+// 115200 baud, 8N1 without any processing of the transferred bytes (the same settings the ESP32 uses).
+static void configureSerialInterface(int serialInterface) {
+   struct termios settings;
+   if (isatty(serialInterface) && tcgetattr(serialInterface, &settings) == 0) {
+      cfmakeraw(&settings);
+      cfsetispeed(&settings, B115200);
+      cfsetospeed(&settings, B115200);
+      tcsetattr(serialInterface, TCSANOW, &settings);
+   }
+}
+
+static bool waitForLine(const UploadChannel *channel, const char *expectedLine, uint32_t timeoutInMilliseconds) {
+   char line[MAX_RESPONSE_LINE_LENGTH];
+   while (channel->readLine(channel->context, line, sizeof(line), timeoutInMilliseconds)) {
+      if (strcmp(line, expectedLine) == 0) {
+         return true;
+      }
+   }
+   return false;
+}
+
+static double millisecondsSince(struct timespec *start) {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (now.tv_sec - start->tv_sec) * 1e3 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+   if (argc != 3) {
+      printUsage(argv[0]);
+      return 1;
+   }
+
+   const char *serialDevicePath = argv[1];
+   const char *inputFilePath    = argv[2];
+   size_t binarySize            = 0;
+   const uint8_t *binary        = mapFile(inputFilePath, &binarySize);
+   if (binary == NULL) {
+      fprintf(stderr, "ERROR: failed to read \"%s\".\n", inputFilePath);
+      return 1;
+   }
+
+   int serialInterface = open(serialDevicePath, O_RDWR | O_NOCTTY);
+   if (serialInterface < 0) {
+      fprintf(stderr, "ERROR: failed to open \"%s\".\n", serialDevicePath);
+      munmap((void*)binary, binarySize);
+      return 1;
+   }
+   configureSerialInterface(serialInterface);
+
+   UploadChannel channel;
+   SerialChannel serial;
+   initializeSerialChannel(&channel, &serial, serialInterface);
+
+   const char command[] = "upload\r";
+   channel.write(channel.context, (const uint8_t*)command, strlen(command));
+
+   int exitCode = 1;
+   if (!waitForLine(&channel, "READY", READY_TIMEOUT_IN_MILLISECONDS)) {
+      fprintf(stderr, "ERROR: the ESP32 did not switch to upload mode.\n");
+   } else {
+      struct timespec start;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      UploadResult result = uploadImage(&channel, binary, binarySize, RESPONSE_TIMEOUT_IN_MILLISECONDS);
+      double milliseconds = millisecondsSince(&start);
+
+      if (result.isSuccessful) {
+         printf("uploaded %zu bytes in %.1f ms (%zu frames, %zu sent again)\n", binarySize, milliseconds, result.sentFrameCount, result.resentFrameCount);
+         exitCode = 0;
+      } else {
+         fprintf(stderr, "ERROR: upload failed (%s).\n", result.errorMessage);
+      }
+   }
+
+   close(serialInterface);
+   munmap((void*)binary, binarySize);
+   return exitCode;
+}
@@ -0,0 +1,188 @@
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "UploadClient.h"
+#include "../main/LineReader.h"
+
+#define MAX_RETRY_COUNT    10
+
+static void writeUint16(uint8_t *bytes, uint16_t value) {
+   bytes[0] = value & 0xff;
+   bytes[1] = value >> 8;
+}
+
+static void writeUint32(uint8_t *bytes, uint32_t value) {
+   for (size_t index = 0; index < 4; index++) {
+      bytes[index] = (value >> (index * 8)) & 0xff;
+   }
+}
+
+size_t buildUploadFrame(uint8_t type, uint16_t sequence, uint16_t argument, const uint8_t *payload, size_t payloadLength, uint8_t *encodedFrame) {
+   uint8_t frame[MAX_UPLOAD_FRAME_SIZE];
+   size_t length = UPLOAD_FRAME_HEADER_SIZE + payloadLength;
+
+   frame[0] = type;
+   writeUint16(frame + 1, sequence);
+   writeUint16(frame + 3, argument);
+   memcpy(frame + UPLOAD_FRAME_HEADER_SIZE, payload, payloadLength);
+   writeUint32(frame + length, calculateCrc32(0, frame, length));
+   length += UPLOAD_FRAME_CRC_SIZE;
+
+   size_t encodedLength = encodeCobs(frame, length, encodedFrame);
+   encodedFrame[encodedLength] = 0;
+   return encodedLength + 1;
+}
+
+static void sendFrame(const UploadChannel *channel, const uint8_t *image, size_t imageSize, uint16_t sequence, uint16_t endSequence) {
+   uint8_t encodedFrame[MAX_ENCODED_UPLOAD_FRAME_SIZE + 1];
+   size_t length;
+
+   if (sequence < endSequence) {
+      size_t offset        = sequence * MAX_UPLOAD_PAYLOAD_SIZE;
+      size_t payloadLength = imageSize - offset < MAX_UPLOAD_PAYLOAD_SIZE ? imageSize - offset : MAX_UPLOAD_PAYLOAD_SIZE;
+      length = buildUploadFrame(UPLOAD_FRAME_TYPE_DATA, sequence, offset, image + offset, payloadLength, encodedFrame);
+   } else {
+      uint8_t imageCrc[UPLOAD_END_PAYLOAD_SIZE];
+      writeUint32(imageCrc, calculateCrc32(0, image, imageSize));
+      length = buildUploadFrame(UPLOAD_FRAME_TYPE_END, sequence, imageSize, imageCrc, sizeof(imageCrc), encodedFrame);
+   }
+   channel->write(channel->context, encodedFrame, length);
+}
+
+UploadResult uploadImage(const UploadChannel *channel, const uint8_t *image, size_t imageSize, uint32_t responseTimeoutInMilliseconds) {
+   UploadResult result    = {false, 0, 0, ""};
+   uint16_t endSequence   = (imageSize + MAX_UPLOAD_PAYLOAD_SIZE - 1) / MAX_UPLOAD_PAYLOAD_SIZE;
+   uint32_t firstUnacked  = 0;   // first frame without acknowledgement
+   uint32_t nextSequence  = 0;
+   uint32_t sentFrames    = 0;   // number of different frames sent so far
+   size_t retryCount      = 0;
+   char line[MAX_RESPONSE_LINE_LENGTH];
+
+   if (imageSize > UINT16_MAX) {
+      snprintf(result.errorMessage, sizeof(result.errorMessage), "image too large");
+      return result;
+   }
+
+   while (true) {
+      while (nextSequence <= endSequence && nextSequence < firstUnacked + UPLOAD_WINDOW_SIZE) {
+         sendFrame(channel, image, imageSize, nextSequence, endSequence);
+         result.sentFrameCount++;
+         if (nextSequence < sentFrames) {
+            result.resentFrameCount++;
+         } else {
+            sentFrames = nextSequence + 1;
+         }
+         nextSequence++;
+      }
+
+      if (!channel->readLine(channel->context, line, sizeof(line), responseTimeoutInMilliseconds)) {
+         if (++retryCount > MAX_RETRY_COUNT) {
+            snprintf(result.errorMessage, sizeof(result.errorMessage), "no response");
+            return result;
+         }
+         nextSequence = firstUnacked;
+         continue;
+      }
+
+      unsigned int value;
+      if (sscanf(line, "ACK %u", &value) == 1) {
+         if (value + 1 > firstUnacked) {
+            firstUnacked = value + 1;
+            retryCount   = 0;
+         }
+      } else if (sscanf(line, "NAK %u", &value) == 1) {
+         if (value >= firstUnacked && value < nextSequence) {
+            firstUnacked = value;
+            nextSequence = value;
+         }
+      } else if (strncmp(line, "DONE", 4) == 0) {
+         result.isSuccessful = true;
+         return result;
+      } else if (strncmp(line, "ERROR", 5) == 0) {
+         snprintf(result.errorMessage, sizeof(result.errorMessage), "%s", line);
+         return result;
+      }
+   }
+}
+
+static uint64_t getMilliseconds() {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return now.tv_sec * 1000ULL + now.tv_nsec / 1000000;
+}
+
+static void writeToFile(void *context, const uint8_t *bytes, size_t byteCount) {
+   SerialChannel *serial = context;
+   while (byteCount > 0) {
+      ssize_t result = write(serial->fileDescriptor, bytes, byteCount);
+      if (result <= 0) {
+         return;
+      }
+      bytes     += result;
+      byteCount -= result;
+   }
+}
+
+// Moves the first line in pending into line. Returns false if pending does not contain a complete line.
+static bool takePendingLine(SerialChannel *serial, char *line, size_t maxLineLength) {
+   for (size_t index = 0; index < serial->pendingLength; index++) {
+      char character = serial->pending[index];
+      if (character == '\r' || character == '\n') {
+         size_t length = index < maxLineLength - 1 ? index : maxLineLength - 1;
+         memcpy(line, serial->pending, length);
+         line[length] = 0;
+         serial->pendingLength -= index + 1;
+         memmove(serial->pending, serial->pending + index + 1, serial->pendingLength);
+         return true;
+      }
+   }
+   return false;
+}
+
+static bool readLineFromFile(void *context, char *line, size_t maxLineLength, uint32_t timeoutInMilliseconds) {
+   SerialChannel *serial = context;
+   uint64_t deadline     = getMilliseconds() + timeoutInMilliseconds;
+
+   while (true) {
+      // skip empty lines (e.g. the LF of a CRLF)
+      while (takePendingLine(serial, line, maxLineLength)) {
+         if (line[0] != 0) {
+            return true;
+         }
+      }
+
+      uint64_t now = getMilliseconds();
+      if (now >= deadline) {
+         return false;
+      }
+      struct pollfd pollRequest = {serial->fileDescriptor, POLLIN, 0};
+      if (poll(&pollRequest, 1, deadline - now) <= 0) {
+         return false;
+      }
+
+      char bytes[MAX_RESPONSE_LINE_LENGTH];
+      ssize_t byteCount = read(serial->fileDescriptor, bytes, sizeof(bytes));
+      if (byteCount <= 0) {
+         return false;
+      }
+      for (ssize_t index = 0; index < byteCount; index++) {
+         if (bytes[index] == XON || bytes[index] == XOFF) {
+            continue;
+         }
+         if (serial->pendingLength == sizeof(serial->pending)) {
+            // drop overlong lines (they are not responses of the upload protocol)
+            serial->pendingLength = 0;
+         }
+         serial->pending[serial->pendingLength++] = bytes[index];
+      }
+   }
+}
+
+void initializeSerialChannel(UploadChannel *channel, SerialChannel *serial, int fileDescriptor) {
+   serial->fileDescriptor = fileDescriptor;
+   serial->pendingLength  = 0;
+   *channel = (UploadChannel){serial, writeToFile, readLineFromFile};
+}
@@ -0,0 +1,49 @@
+#ifndef assembler_upload_client_h
+#define assembler_upload_client_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../main/Upload.h"
+
+#define MAX_RESPONSE_LINE_LENGTH    128
+
+// Connection to the ESP32 (or to a receiver running on the host in the tests).
+typedef struct {
+   void  *context;
+   void  (*write)(void *context, const uint8_t *bytes, size_t byteCount);
+   // Copies the next response line (without line end) into line. Returns false if none arrived within the timeout.
+   bool  (*readLine)(void *context, char *line, size_t maxLineLength, uint32_t timeoutInMilliseconds);
+} UploadChannel;
+
+typedef struct {
+   bool     isSuccessful;
+   size_t   sentFrameCount;
+   size_t   resentFrameCount;
+   char     errorMessage[MAX_RESPONSE_LINE_LENGTH];
+} UploadResult;
+
+// Line oriented channel using a file descriptor (serial device or pty). XON and XOFF sent by the ESP32 get ignored.
+typedef struct {
+   int      fileDescriptor;
+   char     pending[MAX_RESPONSE_LINE_LENGTH];
+   size_t   pendingLength;
+} SerialChannel;
+
+void initializeSerialChannel(UploadChannel *channel, SerialChannel *serial, int fileDescriptor);
+
+/**
+ * Builds the COBS encoded frame (including the terminating 0x00) and returns its length. The buffer needs space for
+ * MAX_ENCODED_UPLOAD_FRAME_SIZE + 1 bytes.
+ */
+size_t buildUploadFrame(uint8_t type, uint16_t sequence, uint16_t argument, const uint8_t *payload, size_t payloadLength, uint8_t *encodedFrame);
+
+/**
+ * Sends the image in frames of MAX_UPLOAD_PAYLOAD_SIZE bytes (the receiver needs to be in upload mode already). Up to
+ * UPLOAD_WINDOW_SIZE frames get sent without waiting for an acknowledgement. Missing frames get sent again starting
+ * with the first one the receiver did not get (go-back-n).
+ */
+UploadResult uploadImage(const UploadChannel *channel, const uint8_t *image, size_t imageSize, uint32_t responseTimeoutInMilliseconds);
+
+#endif